@@ -0,0 +1,467 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+// Generates a synthetic C++ project used to measure the performance of DoxyPress
+//
+//    bench_gen <output dir> [classes] [hierarchy depth] [pages] [seed]
+//
+// The project consists of one header and one source file per module, Markdown pages and the
+// DoxyPress project files. doxy_bench.json writes a profile, doxy_record.json records the calls
+// replayed by doxy_microbench. Classes form inheritance chains of the given depth, every module has a
+// class template, members are overloaded and the documentation cross references other classes,
+// members and pages. The output only depends on the arguments, std::mt19937 produces the same
+// sequence on every platform.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#endif
+
+static const int s_classesPerModule = 20;
+
+struct BenchOptions {
+   std::string outputDir;
+
+   int classes = 2000;
+   int depth   = 8;
+   int pages   = 50;
+
+   unsigned int seed = 1;
+};
+
+static bool makeDir(const std::string &path)
+{
+#if defined(_WIN32)
+   int retval = _mkdir(path.c_str());
+#else
+   int retval = mkdir(path.c_str(), 0755);
+#endif
+
+   struct stat info;
+   return retval == 0 || (stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFDIR));
+}
+
+static std::string className(int index)
+{
+   return "Class" + std::to_string(index);
+}
+
+static std::string moduleName(int module)
+{
+   return "module" + std::to_string(module);
+}
+
+static std::string pageName(int page)
+{
+   return "bench_page" + std::to_string(page);
+}
+
+class ProjectWriter
+{
+ public:
+   explicit ProjectWriter(const BenchOptions &options)
+      : m_options(options), m_random(options.seed)
+   {}
+
+   bool write();
+
+ private:
+   int pick(int count) {
+      return static_cast<int>(m_random() % static_cast<unsigned int>(count));
+   }
+
+   // class used in the signature of the third overload of process()
+   int crossReference(int index) const {
+      return static_cast<int>((index * 7919LL + 13) % m_options.classes);
+   }
+
+   // fully qualified name of the class with the given index
+   std::string qualifiedName(int index) const {
+      return "bench::" + moduleName(index / s_classesPerModule) + "::" + className(index);
+   }
+
+   bool writeHeader(int module);
+   bool writeSource(int module);
+   bool writePage(int page);
+   bool writeProjectFile(const std::string &fileName, const std::string &recordFile);
+
+   void writeClass(std::ofstream &out, int index);
+
+   const BenchOptions &m_options;
+   std::mt19937 m_random;
+};
+
+void ProjectWriter::writeClass(std::ofstream &out, int index)
+{
+   const int module   = index / s_classesPerModule;
+   const int chainPos = index % m_options.depth;
+
+   const std::string name = className(index);
+   const int other = crossReference(index);
+
+   out << "/** \\brief " << name << " is a synthetic class at level " << chainPos << " of its hierarchy\n"
+       << " *\n"
+       << " *  The detailed description refers to " << qualifiedName(other) << " and to the page\n"
+       << " *  \\ref " << pageName(pick(m_options.pages)) << ". Values are stored in a\n"
+       << " *  Container" << module << " which is described in \\ref " << moduleName(module) << ".h\n"
+       << " *\n"
+       << " *  \\sa " << qualifiedName(other) << "::process(int)\n"
+       << " */\n";
+
+   out << "class " << name;
+
+   if (chainPos > 0) {
+      // base class is the previous class in the chain, it may be in the previous module
+      out << " : public " << qualifiedName(index - 1);
+   }
+
+   out << "\n{\n"
+       << "   public:\n"
+       << "      /** Constructs an empty " << name << " */\n"
+       << "      " << name << "();\n\n"
+       << "      /** Destroys the object */\n"
+       << "      virtual ~" << name << "();\n\n"
+       << "      /** Processes an integer \\a value, see also process(const std::string &) */\n"
+       << "      virtual int process(int value);\n\n"
+       << "      /** Processes the text \\a value */\n"
+       << "      int process(const std::string &value);\n\n"
+       << "      /** Processes \\a value using \\a other\n"
+       << "       *  \\param value the value\n"
+       << "       *  \\param other object of type " << qualifiedName(other) << "\n"
+       << "       *  \\return the result\n"
+       << "       */\n"
+       << "      int process(double value, const " << qualifiedName(other) << " *other) const;\n\n"
+       << "      /** Returns the stored values */\n"
+       << "      const Container" << module << "<int, " << (chainPos + 1) << "> &values() const;\n\n"
+       << "      /** Returns the name, the same as \\ref " << name << "::process(int) for numbers */\n"
+       << "      static std::string staticName();\n\n"
+       << "   protected:\n"
+       << "      /** Called by process() */\n"
+       << "      virtual void update" << chainPos << "(int step);\n\n"
+       << "   private:\n"
+       << "      Container" << module << "<int, " << (chainPos + 1) << "> m_values;  ///< values\n"
+       << "      int m_count;  ///< number of calls to process()\n"
+       << "};\n\n";
+}
+
+bool ProjectWriter::writeHeader(int module)
+{
+   std::ofstream out(m_options.outputDir + "/include/" + moduleName(module) + ".h");
+
+   if (! out) {
+      return false;
+   }
+
+   const int first = module * s_classesPerModule;
+   const int last  = std::min(first + s_classesPerModule, m_options.classes);
+
+   out << "/** \\file " << moduleName(module) << ".h\n"
+       << " *  \\brief Classes " << first << " to " << (last - 1) << " of the synthetic project\n"
+       << " */\n\n"
+       << "#ifndef BENCH_" << moduleName(module) << "_H\n"
+       << "#define BENCH_" << moduleName(module) << "_H\n\n"
+       << "#include <string>\n\n";
+
+   if (module > 0) {
+      out << "#include \"" << moduleName(module - 1) << ".h\"\n\n";
+   }
+
+   out << "/** Namespace of the synthetic project */\n"
+       << "namespace bench {\n\n"
+       << "/** Module " << module << " of the synthetic project */\n"
+       << "namespace " << moduleName(module) << " {\n\n";
+
+   for (int i = first; i < last; i++) {
+      out << "class " << className(i) << ";\n";
+   }
+
+   out << "\n/** \\brief Fixed size container used by the classes of this module\n"
+       << " *  \\tparam T type of the elements\n"
+       << " *  \\tparam N number of elements\n"
+       << " */\n"
+       << "template <typename T, int N>\n"
+       << "class Container" << module << "\n"
+       << "{\n"
+       << "   public:\n"
+       << "      /** Returns the element at \\a index */\n"
+       << "      const T &at(int index) const { return m_data[index]; }\n\n"
+       << "      /** Replaces the element at \\a index */\n"
+       << "      void set(int index, const T &value) { m_data[index] = value; }\n\n"
+       << "      /** Returns N */\n"
+       << "      static constexpr int size() { return N; }\n\n"
+       << "   private:\n"
+       << "      T m_data[N];\n"
+       << "};\n\n"
+       << "/** Specialization for pointers */\n"
+       << "template <int N>\n"
+       << "class Container" << module << "<" << className(first) << " *, N>\n"
+       << "{\n"
+       << "   public:\n"
+       << "      /** Returns the class at \\a index */\n"
+       << "      " << className(first) << " *at(int index) const { return m_data[index]; }\n\n"
+       << "   private:\n"
+       << "      " << className(first) << " *m_data[N];\n"
+       << "};\n\n"
+       << "/** Values of an operation */\n"
+       << "enum class Mode" << module << " {\n"
+       << "   First,   ///< first value\n"
+       << "   Second,  ///< second value\n"
+       << "   Third    ///< third value\n"
+       << "};\n\n";
+
+   for (int i = first; i < last; i++) {
+      writeClass(out, i);
+   }
+
+   out << "/** Creates an object of class \\a index, refers to " << qualifiedName(pick(m_options.classes)) << " */\n"
+       << className(first) << " *create" << module << "(int index);\n\n"
+       << "/** Overload using a Mode" << module << " */\n"
+       << className(first) << " *create" << module << "(Mode" << module << " mode, int index = 0);\n\n"
+       << "} // namespace\n"
+       << "} // namespace\n\n"
+       << "#endif\n";
+
+   return bool(out);
+}
+
+bool ProjectWriter::writeSource(int module)
+{
+   std::ofstream out(m_options.outputDir + "/src/" + moduleName(module) + ".cpp");
+
+   if (! out) {
+      return false;
+   }
+
+   const int first = module * s_classesPerModule;
+   const int last  = std::min(first + s_classesPerModule, m_options.classes);
+
+   out << "#include \"" << moduleName(module) << ".h\"\n\n"
+       << "namespace bench {\n"
+       << "namespace " << moduleName(module) << " {\n\n";
+
+   for (int i = first; i < last; i++) {
+      const std::string name = className(i);
+      const int chainPos     = i % m_options.depth;
+
+      out << name << "::" << name << "()\n"
+          << "   : m_count(0)\n"
+          << "{\n"
+          << "}\n\n"
+          << name << "::~" << name << "()\n"
+          << "{\n"
+          << "}\n\n"
+          << "int " << name << "::process(int value)\n"
+          << "{\n"
+          << "   // calls " << qualifiedName(pick(m_options.classes)) << "::staticName()\n"
+          << "   for (int i = 0; i < value; ++i) {\n"
+          << "      update" << chainPos << "(i);\n"
+          << "   }\n\n"
+          << "   return ++m_count;\n"
+          << "}\n\n"
+          << "int " << name << "::process(const std::string &value)\n"
+          << "{\n"
+          << "   return process(static_cast<int>(value.size()));\n"
+          << "}\n\n"
+          << "int " << name << "::process(double value, const " << qualifiedName(crossReference(i)) << " *other) const\n"
+          << "{\n"
+          << "   return other->values().at(0) + static_cast<int>(value);\n"
+          << "}\n\n"
+          << "const Container" << module << "<int, " << (chainPos + 1) << "> &" << name << "::values() const\n"
+          << "{\n"
+          << "   return m_values;\n"
+          << "}\n\n"
+          << "std::string " << name << "::staticName()\n"
+          << "{\n"
+          << "   return \"" << name << "\";\n"
+          << "}\n\n"
+          << "void " << name << "::update" << chainPos << "(int step)\n"
+          << "{\n"
+          << "   m_values.set(step % " << (chainPos + 1) << ", step);\n"
+          << "}\n\n";
+   }
+
+   out << "} // namespace\n"
+       << "} // namespace\n";
+
+   return bool(out);
+}
+
+bool ProjectWriter::writePage(int page)
+{
+   std::ofstream out(m_options.outputDir + "/pages/" + pageName(page) + ".md");
+
+   if (! out) {
+      return false;
+   }
+
+   out << "Synthetic page " << page << " {#" << pageName(page) << "}\n"
+       << "=================\n\n"
+       << "This page describes a part of the synthetic project. It refers to "
+       << qualifiedName(pick(m_options.classes)) << " and " << qualifiedName(pick(m_options.classes)) << ".\n\n";
+
+   for (int section = 0; section < 4; section++) {
+      out << "## Section " << section << " {#" << pageName(page) << "_s" << section << "}\n\n"
+          << "* The method " << qualifiedName(pick(m_options.classes)) << "::process(int) is *overloaded*\n"
+          << "* See the **next** page \\ref " << pageName((page + 1) % m_options.pages) << "\n"
+          << "* Module " << moduleName(pick((m_options.classes + s_classesPerModule - 1) / s_classesPerModule))
+          << " is described in the header\n\n"
+          << "| Class | Level |\n"
+          << "|-------|-------|\n";
+
+      for (int row = 0; row < 3; row++) {
+         int index = pick(m_options.classes);
+         out << "| " << qualifiedName(index) << " | " << (index % m_options.depth) << " |\n";
+      }
+
+      out << "\n"
+          << "~~~{.cpp}\n"
+          << "bench::" << moduleName(0) << "::" << className(0) << " obj;\n"
+          << "obj.process(" << section << ");\n"
+          << "~~~\n\n";
+   }
+
+   return bool(out);
+}
+
+bool ProjectWriter::writeProjectFile(const std::string &fileName, const std::string &recordFile)
+{
+   std::ofstream out(m_options.outputDir + "/" + fileName);
+
+   if (! out) {
+      return false;
+   }
+
+   out << "{\n"
+       << "    \"doxypress-format\": 1,\n"
+       << "    \"project\": {\n"
+       << "        \"project-name\": \"DoxyPress Benchmark\"\n"
+       << "    },\n"
+       << "    \"configuration\": {\n"
+       << "        \"extract-all\": true,\n"
+       << "        \"extract-private\": true,\n"
+       << "        \"markdown\": true\n"
+       << "    },\n"
+       << "    \"input\": {\n"
+       << "        \"input-source\": [ \"include\", \"src\", \"pages\" ],\n"
+       << "        \"input-patterns\": [ \"*.h\", \"*.cpp\", \"*.md\" ],\n"
+       << "        \"input-recursive\": true\n"
+       << "    },\n"
+       << "    \"messages\": {\n"
+       << "        \"quiet\": true,\n"
+       << "        \"warnings\": false,\n";
+
+   if (recordFile.empty()) {
+      out << "        \"profile-output\": \"bench_profile.json\"\n";
+   } else {
+      out << "        \"bench-record-file\": \"" << recordFile << "\"\n";
+   }
+
+   out << "    },\n"
+       << "    \"source\": {\n"
+       << "        \"source-code\": true\n"
+       << "    },\n"
+       << "    \"output-html\": {\n"
+       << "        \"generate-html\": true\n"
+       << "    },\n"
+       << "    \"output-latex\": {\n"
+       << "        \"generate-latex\": false\n"
+       << "    },\n"
+       << "    \"output-xml\": {\n"
+       << "        \"generate-xml\": true\n"
+       << "    },\n"
+       << "    \"general\": {\n"
+       << "        \"output-dir\": \"output\"\n"
+       << "    }\n"
+       << "}\n";
+
+   return bool(out);
+}
+
+bool ProjectWriter::write()
+{
+   const std::string &dir = m_options.outputDir;
+
+   if (! makeDir(dir) || ! makeDir(dir + "/include") || ! makeDir(dir + "/src") || ! makeDir(dir + "/pages")) {
+      fprintf(stderr, "Unable to create directory %s\n", dir.c_str());
+      return false;
+   }
+
+   const int modules = (m_options.classes + s_classesPerModule - 1) / s_classesPerModule;
+
+   for (int module = 0; module < modules; module++) {
+      if (! writeHeader(module) || ! writeSource(module)) {
+         fprintf(stderr, "Unable to write %s\n", moduleName(module).c_str());
+         return false;
+      }
+   }
+
+   for (int page = 0; page < m_options.pages; page++) {
+      if (! writePage(page)) {
+         fprintf(stderr, "Unable to write %s\n", pageName(page).c_str());
+         return false;
+      }
+   }
+
+   if (! writeProjectFile("doxy_bench.json", "") || ! writeProjectFile("doxy_record.json", "bench_calls.txt")) {
+      fprintf(stderr, "Unable to write the project file\n");
+      return false;
+   }
+
+   printf("Generated %d classes in %d modules and %d pages in %s\n", m_options.classes, modules,
+                  m_options.pages, dir.c_str());
+
+   return true;
+}
+
+int main(int argc, char **argv)
+{
+   if (argc < 2) {
+      fprintf(stderr, "Usage: bench_gen <output dir> [classes] [hierarchy depth] [pages] [seed]\n");
+      return 1;
+   }
+
+   BenchOptions options;
+   options.outputDir = argv[1];
+
+   if (argc > 2) {
+      options.classes = std::max(1, atoi(argv[2]));
+   }
+
+   if (argc > 3) {
+      options.depth = std::max(1, atoi(argv[3]));
+   }
+
+   if (argc > 4) {
+      options.pages = std::max(1, atoi(argv[4]));
+   }
+
+   if (argc > 5) {
+      options.seed = static_cast<unsigned int>(strtoul(argv[5], nullptr, 10));
+   }
+
+   ProjectWriter writer(options);
+
+   return writer.write() ? 0 : 1;
+}
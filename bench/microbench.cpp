@@ -0,0 +1,439 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+// Replays the calls recorded with 'bench-record-file' and reports the time and the number of
+// allocations per call of each function
+//
+//    doxy_microbench <project file> <recording> [function]
+//
+// The project is parsed the same way as a normal run, the recorded calls are then repeated
+// against the resulting symbol tables until each function has run for at least half a second.
+// Run it from the directory of the project file using the project which made the recording.
+// Scopes which are not a class or a namespace are replayed as the global scope.
+//
+// On glibc every call to malloc, calloc and realloc is counted, on other platforms only the
+// allocations made by operator new are counted.
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <benchrecorder.h>
+#include <classdef.h>
+#include <commentcnv.h>
+#include <config.h>
+#include <default_args.h>
+#include <doxy_globals.h>
+#include <doxy_setup.h>
+#include <filedef.h>
+#include <htmlgen.h>
+#include <language.h>
+#include <memberdef.h>
+#include <namespacedef.h>
+#include <translator_cs.h>
+#include <util.h>
+
+static std::atomic<long long> s_allocCount(0);
+
+#if defined(__GLIBC__)
+
+extern "C" {
+   void *__libc_malloc(size_t size);
+   void *__libc_calloc(size_t count, size_t size);
+   void *__libc_realloc(void *ptr, size_t size);
+
+   void *malloc(size_t size) noexcept
+   {
+      ++s_allocCount;
+      return __libc_malloc(size);
+   }
+
+   void *calloc(size_t count, size_t size) noexcept
+   {
+      ++s_allocCount;
+      return __libc_calloc(count, size);
+   }
+
+   void *realloc(void *ptr, size_t size) noexcept
+   {
+      ++s_allocCount;
+      return __libc_realloc(ptr, size);
+   }
+}
+
+#else
+
+void *operator new(size_t size)
+{
+   ++s_allocCount;
+
+   void *retval = malloc(size);
+
+   if (retval == nullptr) {
+      throw std::bad_alloc();
+   }
+
+   return retval;
+}
+
+void *operator new[](size_t size)
+{
+   return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+   free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+   free(ptr);
+}
+
+#endif
+
+// minimum time each function is measured
+static const qint64 s_minTime = 500000000;
+
+Translator_Cs translator_Cs;
+Translator *theTranslator = &translator_Cs;
+
+void loadTranslationFile()
+{
+   // the benchmark uses the built in English text
+}
+
+QString getLanguage()
+{
+   return QString("doxy_en.qm");
+}
+
+/** Discards the text written by linkifyText */
+class NullTextGenerator : public TextGeneratorIntf
+{
+ public:
+   void writeString(const QString &, bool) const override {
+   }
+
+   void writeBreak(int) const override {
+   }
+
+   void writeLink(const QString &, const QString &, const QString &, const QString &) const override {
+   }
+};
+
+struct BenchFunction {
+   QString name;
+   QVector<std::function<void()>> calls;
+};
+
+static QSharedPointer<Definition> findScope(const QString &name)
+{
+   if (name.isEmpty()) {
+      return QSharedPointer<Definition>();
+   }
+
+   if (name == Doxy_Globals::globalScope->qualifiedName()) {
+      return Doxy_Globals::globalScope;
+   }
+
+   QSharedPointer<Definition> retval = getClass(name);
+
+   if (retval == nullptr) {
+      retval = Doxy_Globals::namespaceSDict.find(name);
+   }
+
+   if (retval == nullptr) {
+      retval = Doxy_Globals::globalScope;
+   }
+
+   return retval;
+}
+
+static QSharedPointer<FileDef> findFile(const QString &name)
+{
+   if (name.isEmpty()) {
+      return QSharedPointer<FileDef>();
+   }
+
+   bool ambig;
+   return findFileDef(&Doxy_Globals::inputNameDict, name, ambig);
+}
+
+static bool toBool(const QString &str)
+{
+   return str == "1";
+}
+
+static std::function<void()> makeCall(const QString &function, const QStringList &args)
+{
+   static NullTextGenerator nullGenerator;
+
+   if (function == "getResolvedClass" && args.size() == 5) {
+      QSharedPointer<Definition> scope = findScope(args[0]);
+      QSharedPointer<FileDef> fileScope = findFile(args[1]);
+
+      QString key          = args[2];
+      bool mayBeUnlinkable = toBool(args[3]);
+      bool mayBeHidden     = toBool(args[4]);
+
+      return [scope, fileScope, key, mayBeUnlinkable, mayBeHidden]() {
+         getResolvedClass(scope, fileScope, key, nullptr, nullptr, mayBeUnlinkable, mayBeHidden);
+      };
+
+   } else if (function == "removeRedundantWhiteSpace" && args.size() == 2) {
+      QString str     = args[0];
+      bool makePretty = toBool(args[1]);
+
+      return [str, makePretty]() {
+         removeRedundantWhiteSpace(str, makePretty);
+      };
+
+   } else if (function == "linkifyText" && args.size() == 7) {
+      QSharedPointer<Definition> scope = findScope(args[0]);
+      QSharedPointer<FileDef> fileScope = findFile(args[1]);
+
+      QString text    = args[2];
+      bool autoBreak  = toBool(args[3]);
+      bool external   = toBool(args[4]);
+      bool keepSpaces = toBool(args[5]);
+      int indentLevel = args[6].toInt();
+
+      return [scope, fileScope, text, autoBreak, external, keepSpaces, indentLevel]() {
+         linkifyText(nullGenerator, scope, fileScope, QSharedPointer<Definition>(), text, autoBreak,
+                  external, keepSpaces, indentLevel);
+      };
+
+   } else if (function == "matchArguments2" && args.size() == 7) {
+      QSharedPointer<Definition> srcScope = findScope(args[0]);
+      QSharedPointer<FileDef> srcFileScope = findFile(args[1]);
+      ArgumentList srcArgList = stringToArgumentList(args[2]);
+
+      QSharedPointer<Definition> dstScope = findScope(args[3]);
+      QSharedPointer<FileDef> dstFileScope = findFile(args[4]);
+      ArgumentList dstArgList = stringToArgumentList(args[5]);
+
+      bool checkCV = toBool(args[6]);
+
+      return [srcScope, srcFileScope, srcArgList, dstScope, dstFileScope, dstArgList, checkCV]() {
+         matchArguments2(srcScope, srcFileScope, srcArgList, dstScope, dstFileScope, dstArgList, checkCV);
+      };
+
+   } else if (function == "resolveRef" && args.size() == 6) {
+      QString scName           = args[0];
+      QString tName            = args[1];
+      bool inSeeBlock          = toBool(args[2]);
+      bool useBaseTemplateOnly = toBool(args[3]);
+      QSharedPointer<FileDef> currentFile = findFile(args[4]);
+      bool checkScope          = toBool(args[5]);
+
+      return [scName, tName, inSeeBlock, useBaseTemplateOnly, currentFile, checkScope]() {
+         QSharedPointer<Definition> resContext;
+         QSharedPointer<MemberDef> resMember;
+
+         resolveRef(scName, tName, inSeeBlock, &resContext, &resMember, useBaseTemplateOnly, currentFile, checkScope);
+      };
+
+   } else if (function == "substitute" && args.size() == 3) {
+      QString origString = args[0];
+      QString oldWord    = args[1];
+      QString newWord    = args[2];
+
+      return [origString, oldWord, newWord]() {
+         substitute(origString, oldWord, newWord);
+      };
+
+   } else if (function == "convertNameToFile" && args.size() == 3) {
+      QString name         = args[0];
+      bool allowDots       = toBool(args[1]);
+      bool allowUnderscore = toBool(args[2]);
+
+      return [name, allowDots, allowUnderscore]() {
+         convertNameToFile_X(name, allowDots, allowUnderscore);
+      };
+
+   } else if (function == "stripTemplateSpecifiersFromScope" && args.size() == 2) {
+      QString fullName = args[0];
+      bool parentOnly  = toBool(args[1]);
+
+      return [fullName, parentOnly]() {
+         stripTemplateSpecifiersFromScope(fullName, parentOnly);
+      };
+
+   } else if (function == "convertCppComments" && args.size() == 2) {
+      QString inBuf    = args[0];
+      QString fileName = args[1];
+
+      return [inBuf, fileName]() {
+         convertCppComments(inBuf, fileName);
+      };
+
+   } else if (function == "codify" && args.size() == 1) {
+      QString str = args[0];
+
+      return [str]() {
+         QString buffer;
+         QTextStream t(&buffer);
+
+         HtmlCodeGenerator codeGen(t, QString());
+         codeGen.codify(str);
+      };
+   }
+
+   return std::function<void()>();
+}
+
+static bool readRecording(const QString &fileName, QVector<QPair<QString, QStringList>> &recording)
+{
+   QFile f(fileName);
+
+   if (! f.open(QIODevice::ReadOnly)) {
+      fprintf(stderr, "Unable to open recording %s\n", qPrintable(fileName));
+      return false;
+   }
+
+   while (! f.atEnd()) {
+      QString line = QString::fromUtf8(f.readLine());
+
+      if (line.endsWith('\n')) {
+         line.chop(1);
+      }
+
+      if (line.isEmpty()) {
+         continue;
+      }
+
+      QStringList args = line.split('\t');
+      QString function = args.takeFirst();
+
+      for (auto &item : args) {
+         item = BenchRecorder::unescape(item);
+      }
+
+      recording.append(qMakePair(function, args));
+   }
+
+   return true;
+}
+
+static void runFunction(const BenchFunction &bench)
+{
+   QElapsedTimer timer;
+
+   long long count  = 0;
+   long long allocs = s_allocCount;
+
+   timer.start();
+
+   do {
+      for (const auto &call : bench.calls) {
+         call();
+      }
+
+      count += bench.calls.size();
+
+   } while (timer.nsecsElapsed() < s_minTime);
+
+   qint64 elapsed = timer.nsecsElapsed();
+   allocs = s_allocCount - allocs;
+
+   printf("%-34s %8d %12lld %12.1f %10.2f\n", qPrintable(bench.name), bench.calls.size(), count,
+                  double(elapsed) / count, double(allocs) / count);
+}
+
+int main(int argc, char **argv)
+{
+   if (argc < 3) {
+      fprintf(stderr, "Usage: doxy_microbench <project file> <recording> [function]\n");
+      return 1;
+   }
+
+   QString recordFile = QString::fromUtf8(argv[2]);
+   QString onlyFunction;
+
+   if (argc > 3) {
+      onlyFunction = QString::fromUtf8(argv[3]);
+   }
+
+   QVector<QPair<QString, QStringList>> recording;
+
+   if (! readRecording(recordFile, recording)) {
+      return 1;
+   }
+
+   struct CommandLine cmdArgs;
+   cmdArgs = parseCommandLine(QStringList() << QString::fromUtf8(argv[1]));
+
+   readConfiguration(cmdArgs);
+
+   // do not overwrite the recording while the project is parsed
+   Config::setString("bench-record-file", QString());
+
+   initDoxyPress();
+
+   QCoreApplication myApp(argc, argv);
+   loadTranslationFile();
+
+   processFiles();
+
+   QVector<BenchFunction> functions;
+   int skipped = 0;
+
+   for (const auto &item : recording) {
+
+      if (! onlyFunction.isEmpty() && item.first != onlyFunction) {
+         continue;
+      }
+
+      std::function<void()> call = makeCall(item.first, item.second);
+
+      if (! call) {
+         skipped++;
+         continue;
+      }
+
+      auto iter = std::find_if(functions.begin(), functions.end(),
+                  [&item](const BenchFunction &bench) { return bench.name == item.first; });
+
+      if (iter == functions.end()) {
+         functions.append(BenchFunction{item.first, QVector<std::function<void()>>()});
+         iter = functions.end() - 1;
+      }
+
+      iter->calls.append(std::move(call));
+   }
+
+   if (skipped > 0) {
+      fprintf(stderr, "Skipped %d recorded calls which could not be replayed\n", skipped);
+   }
+
+   printf("\n%-34s %8s %12s %12s %10s\n", "function", "recorded", "calls", "ns/call", "allocs/call");
+
+   for (const auto &bench : functions) {
+      runFunction(bench);
+   }
+
+   return 0;
+}
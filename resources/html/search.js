@@ -321,7 +321,13 @@ function SearchBox(name, resultsPath, inFrame, label)
     var hasResultsPage;
 
     var idx = indexSectionsWithContent[this.searchIndex].indexOf(idxChar);
-    if (idx!=-1)
+    if (idx!=-1 && typeof indexSectionShards!='undefined') // compact index
+    {
+       resultsPage = this.resultsPath + '/results.html';
+       resultsPageWithSearch = resultsPage+'?'+this.searchIndex+'&'+escape(searchValue);
+       hasResultsPage = true;
+    }
+    else if (idx!=-1)
     {
        var hexCode=idx.toString(10);
        resultsPage = this.resultsPath + '/' + indexSectionNames[this.searchIndex] + '_' + hexCode + '.html';
@@ -774,6 +780,120 @@ function createResults()
   }
 }
 
+// -----------------------------------------------------------------------
+
+// Compact index: the results page loads only the shards which can
+// contain ids starting with the search text.
+
+var searchShardText    = '';
+var searchShardId      = '';
+var searchShardPending = 0;
+var searchShardResults = [];
+
+// returns the range [first, last) of the shards to load for id
+function searchShardRange(shards, id)
+{
+  var first = 0;
+  var last  = 0;
+
+  // last shard starting at or before id
+  while (first+1<shards.length && shards[first+1]<=id)
+  {
+    first++;
+  }
+
+  // following shards which start with id
+  last = first+1;
+  while (last<shards.length && shards[last].substr(0, id.length)==id)
+  {
+    last++;
+  }
+  return [first, last];
+}
+
+function loadSearchShards()
+{
+  var args    = unescape(window.location.search.substring(1));
+  var sep     = args.indexOf('&');
+  var section = parseInt(args.substring(0, sep));
+
+  searchShardText = args.substring(sep+1).replace(/^ +/, "").replace(/ +$/, "");
+  searchShardId   = convertToId(searchShardText.toLowerCase());
+
+  var shards = indexSectionShards[section];
+  var range  = searchShardRange(shards, searchShardId);
+  var head   = document.getElementsByTagName('head')[0];
+
+  searchShardResults = [];
+  searchShardPending = range[1]-range[0];
+
+  if (shards.length==0)
+  {
+    searchShardPending = 0;
+    finishSearchShards();
+    return;
+  }
+
+  for (var k=range[0]; k<range[1]; k++)
+  {
+    var script = document.createElement('script');
+    script.setAttribute('type','text/javascript');
+    script.setAttribute('src',indexSectionNames[section]+'_s'+k+'.js');
+    head.appendChild(script);
+  }
+}
+
+// called by each shard file, expands the shared tables of the shard
+function searchShardLoaded(name, shard, data)
+{
+  var items = [];
+  for (var e=0; e<data.d.length; e++)
+  {
+    var entry = data.d[e];
+    if (entry[0].substr(0, searchShardId.length)!=searchShardId)
+    {
+      continue;
+    }
+
+    var item = [entry[1]];
+    for (var c=0; c<entry[2].length; c++)
+    {
+      var link = entry[2][c];
+      var url  = data.u[link[0]];
+      if (link[1]!='')
+      {
+        url += '#'+link[1];
+      }
+      item.push([url, link[2], data.s[link[3]]]);
+    }
+    items.push([entry[0], item]);
+  }
+  searchShardResults[shard] = items;
+
+  searchShardPending--;
+  if (searchShardPending==0)
+  {
+    finishSearchShards();
+  }
+}
+
+function finishSearchShards()
+{
+  // searchData is also defined by the files of the per letter index, do not declare it here
+  searchData = [];
+  for (var k=0; k<searchShardResults.length; k++)
+  {
+    if (searchShardResults[k])
+    {
+      searchData = searchData.concat(searchShardResults[k]);
+    }
+  }
+
+  document.getElementById("Loading").style.display="none";
+  createResults();
+  searchResults.Search(searchShardText);
+}
+
 function init_search()
 {
   var results = document.getElementById("MSearchSelectWindow");
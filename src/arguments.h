@@ -21,6 +21,7 @@
 #include <QString>
 #include <QVector>
 
+#include <memorystats.h>
 #include <types.h>
 
 class StorageIntf;
@@ -74,7 +75,7 @@ struct Argument {
  *  stores information about a member which is typically found  after the argument list, 
  *  such as whether the member is const, volatile or pure virtual.
  */
-class ArgumentList : public QVector<Argument>
+class ArgumentList : public QVector<Argument>, private MemoryCounted<MemoryStats::ArgumentListKind>
 {
  public:
    /*! Creates an empty argument list */
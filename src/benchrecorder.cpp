@@ -0,0 +1,166 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#include <QMutexLocker>
+
+#include <benchrecorder.h>
+
+#include <definition.h>
+#include <filedef.h>
+#include <message.h>
+
+// calls recorded per function
+static const int s_maxCalls = 50000;
+
+bool   BenchRecorder::s_enabled = false;
+QFile  BenchRecorder::s_file;
+QMutex BenchRecorder::s_mutex;
+
+QHash<QString, int> BenchRecorder::s_counts;
+
+bool BenchRecorder::open(const QString &fileName)
+{
+   QMutexLocker locker(&s_mutex);
+
+   s_file.setFileName(fileName);
+
+   if (! s_file.open(QIODevice::WriteOnly)) {
+      err("Unable to open file for writing %s, error: %d\n", csPrintable(fileName), s_file.error());
+      return false;
+   }
+
+   s_counts.clear();
+   s_enabled = true;
+
+   return true;
+}
+
+void BenchRecorder::close()
+{
+   QMutexLocker locker(&s_mutex);
+
+   s_enabled = false;
+
+   if (s_file.isOpen()) {
+      s_file.close();
+   }
+}
+
+void BenchRecorder::record(const char *function, const QStringList &args)
+{
+   QMutexLocker locker(&s_mutex);
+
+   if (! s_enabled) {
+      return;
+   }
+
+   int &count = s_counts[QString::fromLatin1(function)];
+
+   if (count >= s_maxCalls) {
+      return;
+   }
+
+   count++;
+
+   QString line = QString::fromLatin1(function);
+
+   for (const auto &item : args) {
+      line += '\t';
+      line += escape(item);
+   }
+
+   line += '\n';
+
+   s_file.write(line.toUtf8());
+}
+
+QString BenchRecorder::scopeName(QSharedPointer<Definition> def)
+{
+   if (def == nullptr) {
+      return QString();
+   }
+
+   return def->qualifiedName();
+}
+
+QString BenchRecorder::fileName(QSharedPointer<FileDef> fd)
+{
+   if (fd == nullptr) {
+      return QString();
+   }
+
+   return fd->getFilePath();
+}
+
+QString BenchRecorder::escape(const QString &str)
+{
+   QString retval;
+
+   for (auto c : str) {
+
+      if (c == '\\') {
+         retval += "\\\\";
+
+      } else if (c == '\t') {
+         retval += "\\t";
+
+      } else if (c == '\n') {
+         retval += "\\n";
+
+      } else if (c == '\r') {
+         retval += "\\r";
+
+      } else {
+         retval += c;
+      }
+   }
+
+   return retval;
+}
+
+QString BenchRecorder::unescape(const QString &str)
+{
+   QString retval;
+   bool isEscaped = false;
+
+   for (auto c : str) {
+
+      if (isEscaped) {
+         if (c == 't') {
+            retval += '\t';
+
+         } else if (c == 'n') {
+            retval += '\n';
+
+         } else if (c == 'r') {
+            retval += '\r';
+
+         } else {
+            retval += c;
+         }
+
+         isEscaped = false;
+
+      } else if (c == '\\') {
+         isEscaped = true;
+
+      } else {
+         retval += c;
+      }
+   }
+
+   return retval;
+}
@@ -0,0 +1,66 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#ifndef BENCHRECORDER_H
+#define BENCHRECORDER_H
+
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+class Definition;
+class FileDef;
+
+/** @brief Records the arguments of frequently called functions
+ *
+ *  When 'bench-record-file' is set the arguments of the calls to a number of utility functions
+ *  are written to the file, one call per line. The micro benchmark in bench/microbench.cpp
+ *  replays the calls against the same project. Only the first calls of every function are
+ *  recorded to keep the file at a reasonable size.
+ */
+class BenchRecorder
+{
+ public:
+   static bool isEnabled() {
+      return s_enabled;
+   }
+
+   static bool open(const QString &fileName);
+   static void close();
+
+   static void record(const char *function, const QStringList &args);
+
+   /** Name used to find \a def when the call is replayed, empty when \a def is a null pointer */
+   static QString scopeName(QSharedPointer<Definition> def);
+
+   /** Name used to find \a fd when the call is replayed */
+   static QString fileName(QSharedPointer<FileDef> fd);
+
+   static QString escape(const QString &str);
+   static QString unescape(const QString &str);
+
+ private:
+   static bool s_enabled;
+
+   static QFile  s_file;
+   static QMutex s_mutex;
+   static QHash<QString, int> s_counts;
+};
+
+#endif
@@ -0,0 +1,282 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#include <QFile>
+#include <QMutexLocker>
+#include <QTextStream>
+
+#include <cachestats.h>
+
+#include <message.h>
+
+bool    CacheStats::s_enabled = false;
+QString CacheStats::s_site;
+QMutex  CacheStats::s_mutex;
+
+QHash<const char *, CacheStats::CacheData> CacheStats::s_caches;
+
+static QString quoted(const QString &str)
+{
+   QString retval = str;
+   retval.replace('\\', "\\\\");
+   retval.replace('"', "\\\"");
+
+   return '"' + retval + '"';
+}
+
+static double hitRatio(qint64 hits, qint64 misses)
+{
+   if (hits + misses == 0) {
+      return 0.0;
+   }
+
+   return hits * 100.0 / (hits + misses);
+}
+
+void CacheStats::Counters::add(const Counters &other)
+{
+   hits      += other.hits;
+   misses    += other.misses;
+   evictions += other.evictions;
+   bytes     += other.bytes;
+}
+
+void CacheStats::setEnabled(bool enabled)
+{
+   QMutexLocker locker(&s_mutex);
+   s_enabled = enabled;
+}
+
+void CacheStats::setSite(const QString &site)
+{
+   QMutexLocker locker(&s_mutex);
+   s_site = site.trimmed();
+}
+
+void CacheStats::record(const char *cache, Event event, qint64 bytes)
+{
+   if (! s_enabled) {
+      return;
+   }
+
+   QMutexLocker locker(&s_mutex);
+
+   CacheData &data = s_caches[cache];
+   auto iter = data.sites.find(s_site);
+
+   if (iter == data.sites.end()) {
+      data.siteOrder.append(s_site);
+      iter = data.sites.insert(s_site, Counters());
+   }
+
+   Counters &counters = iter.value();
+
+   switch (event) {
+      case Hit:
+         counters.hits++;
+         break;
+
+      case Miss:
+         counters.misses++;
+         break;
+
+      case Eviction:
+         counters.evictions++;
+         break;
+   }
+
+   counters.bytes += bytes;
+}
+
+void CacheStats::setUsage(const char *cache, qint64 entries, qint64 capacity)
+{
+   if (! s_enabled) {
+      return;
+   }
+
+   QMutexLocker locker(&s_mutex);
+
+   CacheData &data = s_caches[cache];
+   data.entries  = entries;
+   data.capacity = capacity;
+}
+
+QMap<QString, CacheStats::CacheData> CacheStats::collect()
+{
+   QMutexLocker locker(&s_mutex);
+
+   // the same name can be passed from several files, merge the entries
+   QMap<QString, CacheData> retval;
+
+   for (auto iter = s_caches.begin(); iter != s_caches.end(); ++iter) {
+      CacheData &data = retval[QString::fromLatin1(iter.key())];
+
+      if (iter.value().entries >= 0) {
+         data.entries  = iter.value().entries;
+         data.capacity = iter.value().capacity;
+      }
+
+      for (const auto &site : iter.value().siteOrder) {
+         if (! data.sites.contains(site)) {
+            data.siteOrder.append(site);
+         }
+
+         data.sites[site].add(iter.value().sites.value(site));
+      }
+   }
+
+   return retval;
+}
+
+void CacheStats::print()
+{
+   const QMap<QString, CacheData> caches = collect();
+
+   if (caches.isEmpty()) {
+      return;
+   }
+
+   msg("\n");
+   msg("----------------------\n");
+
+   for (auto iter = caches.begin(); iter != caches.end(); ++iter) {
+      const CacheData &data = iter.value();
+
+      Counters total;
+
+      for (const auto &site : data.siteOrder) {
+         total.add(data.sites.value(site));
+      }
+
+      QString usage;
+
+      if (data.entries >= 0 && data.capacity >= 0) {
+         usage = QString(", %1/%2 entries used").arg(data.entries).arg(data.capacity);
+
+      } else if (data.entries >= 0) {
+         usage = QString(", %1 entries").arg(data.entries);
+      }
+
+      msg("Cache %s: %lld hits, %lld misses, %lld evictions, hit ratio %.1f%%, %.1f KB%s\n",
+                  csPrintable(iter.key()), total.hits, total.misses, total.evictions,
+                  hitRatio(total.hits, total.misses), total.bytes / 1024.0, csPrintable(usage));
+
+      for (const auto &site : data.siteOrder) {
+         const Counters &counters = data.sites[site];
+
+         msg("  %s: %lld hits, %lld misses, %lld evictions, hit ratio %.1f%%\n",
+                  csPrintable(site.isEmpty() ? QString("startup") : site), counters.hits, counters.misses,
+                  counters.evictions, hitRatio(counters.hits, counters.misses));
+      }
+   }
+}
+
+bool CacheStats::write(const QString &fileName)
+{
+   if (fileName.endsWith(".csv", Qt::CaseInsensitive)) {
+      return writeCsv(fileName);
+   }
+
+   return writeJson(fileName);
+}
+
+bool CacheStats::writeJson(const QString &fileName)
+{
+   const QMap<QString, CacheData> caches = collect();
+
+   QFile f(fileName);
+
+   if (! f.open(QIODevice::WriteOnly)) {
+      return false;
+   }
+
+   QTextStream t(&f);
+   t.setCodec("UTF-8");
+
+   t << "{\"caches\":[\n";
+
+   bool firstCache = true;
+
+   for (auto iter = caches.begin(); iter != caches.end(); ++iter) {
+      const CacheData &data = iter.value();
+
+      if (! firstCache) {
+         t << ",\n";
+      }
+
+      firstCache = false;
+
+      t << "{\"name\":" << quoted(iter.key()) << ",\"entries\":" << data.entries
+        << ",\"capacity\":" << data.capacity << ",\"sites\":[";
+
+      bool firstSite = true;
+
+      for (const auto &site : data.siteOrder) {
+         const Counters &counters = data.sites[site];
+
+         if (! firstSite) {
+            t << ",";
+         }
+
+         firstSite = false;
+
+         t << "\n {\"site\":" << quoted(site) << ",\"hits\":" << counters.hits
+           << ",\"misses\":" << counters.misses << ",\"evictions\":" << counters.evictions
+           << ",\"bytes\":" << counters.bytes << "}";
+      }
+
+      t << "]}";
+   }
+
+   t << "\n]}\n";
+   t.flush();
+
+   return f.error() == QFile::NoError;
+}
+
+bool CacheStats::writeCsv(const QString &fileName)
+{
+   const QMap<QString, CacheData> caches = collect();
+
+   QFile f(fileName);
+
+   if (! f.open(QIODevice::WriteOnly)) {
+      return false;
+   }
+
+   QTextStream t(&f);
+   t.setCodec("UTF-8");
+
+   t << "cache,site,hits,misses,evictions,bytes,entries,capacity\n";
+
+   for (auto iter = caches.begin(); iter != caches.end(); ++iter) {
+      const CacheData &data = iter.value();
+
+      for (const auto &site : data.siteOrder) {
+         const Counters &counters = data.sites[site];
+
+         QString csvSite = site;
+         csvSite.replace('"', "\"\"");
+
+         t << iter.key() << ",\"" << csvSite << "\"," << counters.hits << "," << counters.misses << ","
+           << counters.evictions << "," << counters.bytes << "," << data.entries << "," << data.capacity << "\n";
+      }
+   }
+
+   t.flush();
+
+   return f.error() == QFile::NoError;
+}
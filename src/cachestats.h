@@ -0,0 +1,102 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#ifndef CACHESTATS_H
+#define CACHESTATS_H
+
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+/** @brief Registry of hit, miss and eviction counts for the internal caches
+ *
+ *  Every event is attributed to the phase of Statistics which is running when it occurs. The
+ *  registry is enabled when 'cache-stats-output' is set or the time debug flag is given, the
+ *  report is printed with the phase timings and written as JSON or as CSV when the file name
+ *  ends with ".csv". All methods are thread safe.
+ */
+class CacheStats
+{
+ public:
+   enum Event {
+      Hit,
+      Miss,
+      Eviction
+   };
+
+   static bool isEnabled() {
+      return s_enabled;
+   }
+
+   static void setEnabled(bool enabled);
+
+   /** Records an \a event for \a cache, \a bytes is the approximate size of the entry */
+   static void record(const char *cache, Event event, qint64 bytes = 0);
+
+   /** Records the current number of entries and the capacity of \a cache, -1 when unbounded */
+   static void setUsage(const char *cache, qint64 entries, qint64 capacity);
+
+   /** Sets the phase which the following events are attributed to */
+   static void setSite(const QString &site);
+
+   static void print();
+
+   /** Writes the statistics, returns false when the file can not be written */
+   static bool write(const QString &fileName);
+
+ private:
+   struct Counters {
+      Counters()
+         : hits(0), misses(0), evictions(0), bytes(0)
+      {}
+
+      void add(const Counters &other);
+
+      qint64 hits;
+      qint64 misses;
+      qint64 evictions;
+      qint64 bytes;
+   };
+
+   struct CacheData {
+      CacheData()
+         : entries(-1), capacity(-1)
+      {}
+
+      qint64 entries;
+      qint64 capacity;
+
+      // first site the cache was used in comes first
+      QList<QString> siteOrder;
+      QHash<QString, Counters> sites;
+   };
+
+   static QMap<QString, CacheData> collect();
+
+   static bool writeJson(const QString &fileName);
+   static bool writeCsv(const QString &fileName);
+
+   static bool s_enabled;
+
+   static QString s_site;
+   static QMutex  s_mutex;
+
+   // keyed by the name passed to record(), a string literal
+   static QHash<const char *, CacheData> s_caches;
+};
+
+#endif
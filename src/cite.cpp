@@ -21,6 +21,7 @@
 #include <cite.h>
 
 #include <config.h>
+#include <extcmd.h>
 #include <language.h>
 #include <message.h>
 #include <portable.h>
@@ -214,7 +215,7 @@ void CiteDict::generatePage() const
 
    // perl "bib2xhtml.pl" curDir  bibOutputFiles  "citeList.doc"
    QString args   = "\"" + bib2xhtmlFile + "\" " +  curDir + " " + bibOutputFiles + " \"" + citeListFile + "\"";
-   int exitCode   = portable_system("perl", args);
+   int exitCode   = ExtCmdManager::instance()->run("perl", "perl", args);
 
    if (exitCode == 1) {
       err("Issue with Perl or BibTeX. Verify 'perl --version' works from a Windows or Shell command line.\n\n");
@@ -0,0 +1,209 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#if ! defined(_WIN32) || defined(__CYGWIN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <clangbuffers.h>
+
+#include <config.h>
+#include <util.h>
+
+static QString detab(const QString &str)
+{
+   static int tabSize = Config::getInt("tab-size");
+
+   QString out;
+   int col = 0;
+
+   const int maxIndent = 1000000;    // value representing infinity
+   int minIndent = maxIndent;
+
+   for (auto c : str) {
+
+      switch (c.unicode()) {
+
+         case '\t': {
+            // expand tab
+            int stop = tabSize - (col % tabSize);
+            col += stop;
+
+            while (stop--) {
+               out += ' ';
+            }
+         }
+         break;
+
+         case '\n':
+            // reset colomn counter
+            out += c;
+            col = 0;
+            break;
+
+         case ' ':
+            // increment column counter
+            out += c;
+            col++;
+            break;
+
+         default:
+            // non-whitespace, update minIndent
+            out += c;
+
+            if (col < minIndent) {
+               minIndent = col;
+            }
+            col++;
+      }
+   }
+
+   return out;
+}
+
+ClangBuffer::ClangBuffer(const QString &fileName)
+   : m_fileName(fileName.toUtf8()), m_data(nullptr), m_length(0), m_isMapped(false)
+{
+   static const bool filterSourceFiles = Config::getBool("filter-source-files");
+
+   if (! mapFile(fileName)) {
+      m_contents = detab(fileToString(fileName, filterSourceFiles, true)).toUtf8();
+
+      m_data   = m_contents.constData();
+      m_length = m_contents.length();
+   }
+}
+
+ClangBuffer::~ClangBuffer()
+{
+#if ! defined(_WIN32) || defined(__CYGWIN__)
+   if (m_isMapped) {
+      munmap((void *)m_data, m_length);
+   }
+#endif
+}
+
+// maps the file when reading it with fileToString() and detab() would return the same bytes
+bool ClangBuffer::mapFile(const QString &fileName)
+{
+#if defined(_WIN32) && ! defined(__CYGWIN__)
+   return false;
+
+#else
+   static const bool filterSourceFiles = Config::getBool("filter-source-files");
+   static const QString inputEncoding  = Config::getString("input-encoding").toLower();
+
+   if (! QFileInfo(fileName).isAbsolute()) {
+      return false;
+   }
+
+   if (filterSourceFiles && ! getFileFilter(fileName, true).isEmpty()) {
+      return false;
+   }
+
+   if (! inputEncoding.isEmpty() && inputEncoding != "utf-8" && inputEncoding != "utf8") {
+      return false;
+   }
+
+   int fd = open(QFile::encodeName(fileName).constData(), O_RDONLY);
+
+   if (fd == -1) {
+      return false;
+   }
+
+   struct stat st;
+
+   if (fstat(fd, &st) != 0 || ! S_ISREG(st.st_mode) || st.st_size <= 0) {
+      close(fd);
+      return false;
+   }
+
+   const size_t size = st.st_size;
+   void *ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+   // the mapping stays valid after the descriptor is closed
+   close(fd);
+
+   if (ptr == MAP_FAILED) {
+      return false;
+   }
+
+   const uchar *text = (const uchar *)ptr;
+
+   // plain ASCII without tabs or carriage returns which ends with a new line is not changed
+   bool isPlain = (text[size - 1] == '\n');
+
+   for (size_t i = 0; isPlain && i < size; i++) {
+      const uchar c = text[i];
+
+      if (c >= 0x80 || c == '\t' || c == '\r') {
+         isPlain = false;
+      }
+   }
+
+   if (! isPlain) {
+      munmap(ptr, size);
+      return false;
+   }
+
+   m_data     = (const char *)ptr;
+   m_length   = size;
+   m_isMapped = true;
+
+   return true;
+#endif
+}
+
+ClangBufferCache &ClangBufferCache::instance()
+{
+   static ClangBufferCache bufferCache;
+   return bufferCache;
+}
+
+QSharedPointer<ClangBuffer> ClangBufferCache::buffer(const QString &fileName)
+{
+   QFileInfo fi(fileName);
+
+   const QDateTime lastModified = fi.lastModified();
+   const qint64 size = fi.size();
+
+   QMutexLocker locker(&m_mutex);
+
+   auto iter = m_cache.constFind(fileName);
+
+   if (iter != m_cache.constEnd() && iter->lastModified == lastModified && iter->size == size) {
+      return iter->buffer;
+   }
+
+   // translation units still using an older buffer keep their reference
+   QSharedPointer<ClangBuffer> retval = QMakeShared<ClangBuffer>(fileName);
+   m_cache.insert(fileName, CacheItem{lastModified, size, retval});
+
+   return retval;
+}
+
+void ClangBufferCache::clear()
+{
+   QMutexLocker locker(&m_mutex);
+   m_cache.clear();
+}
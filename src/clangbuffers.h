@@ -0,0 +1,102 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#ifndef CLANGBUFFERS_H
+#define CLANGBUFFERS_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+
+#include <clang-c/Index.h>
+
+/** Contents of an input file in the form clang parses it, filtered, detabbed and UTF-8 encoded */
+class ClangBuffer
+{
+ public:
+   explicit ClangBuffer(const QString &fileName);
+   ~ClangBuffer();
+
+   const char *data() const {
+      return m_data;
+   }
+
+   unsigned long length() const {
+      return m_length;
+   }
+
+   const char *fileName() const {
+      return m_fileName.constData();
+   }
+
+   CXUnsavedFile unsavedFile() const {
+      CXUnsavedFile retval;
+
+      retval.Filename = m_fileName.constData();
+      retval.Contents = m_data;
+      retval.Length   = m_length;
+
+      return retval;
+   }
+
+ private:
+   bool mapFile(const QString &fileName);
+
+   QByteArray     m_fileName;
+   QByteArray     m_contents;        // empty when the file is mapped
+
+   const char    *m_data;
+   unsigned long  m_length;
+   bool           m_isMapped;
+};
+
+/** @brief Buffers for the unsaved files of the clang translation units
+ *
+ *  Every translation unit passes all of its include files to clang. The buffer for a file is
+ *  prepared once and shared by all translation units, it is prepared again when the size or the
+ *  modification time of the file changes. When the contents would not change a file is mapped
+ *  instead of being read. The cache keeps every buffer until clear() is called at the end of
+ *  a parse pass.
+ */
+class ClangBufferCache
+{
+ public:
+   static ClangBufferCache &instance();
+
+   /** Returns the buffer for \a fileName, the buffer stays valid as long as a reference is held */
+   QSharedPointer<ClangBuffer> buffer(const QString &fileName);
+
+   /** Releases the buffers which are not used by a translation unit */
+   void clear();
+
+ private:
+   ClangBufferCache() = default;
+
+   struct CacheItem {
+      QDateTime   lastModified;
+      qint64      size;
+
+      QSharedPointer<ClangBuffer> buffer;
+   };
+
+   QHash<QString, CacheItem> m_cache;
+   QMutex m_mutex;
+};
+
+#endif
@@ -32,6 +32,7 @@
 #include <memberlist.h>
 #include <membergroup.h>
 #include <membername.h>
+#include <memorystats.h>
 #include <outputlist.h>
 #include <stringmap.h>
 #include <sortedlist_fwd.h>
@@ -48,7 +49,7 @@ class UsesClassDef;
  *  A compound symbol can be a class, struct, union, interface, service, singleton, or exception.
  *  \note This class should be renamed to CompoundDef
  */
-class ClassDef : public Definition
+class ClassDef : public Definition, private MemoryCounted<MemoryStats::ClassDefKind>
 {
  public:
 
@@ -119,6 +119,12 @@ void Config::setList(const QString &name, const QStringList &data)
    hashIter.value().value = data;
 }
 
+void Config::setString(const QString &name, const QString &data)
+{
+   auto hashIter = m_cfgString.find(name);
+   hashIter.value().value = data;
+}
+
 // **
 void Config::msgVerify()
 {
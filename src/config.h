@@ -30,6 +30,7 @@ class Config
       Config() = delete;      
 
       static bool parseConfig(const QString &fName);
+      static void load_Defaults();
       static QDir getConfigDir();
       static QString getFullName(const QString &fName);
 
@@ -41,6 +42,7 @@ class Config
 
       static void setBool(const QString &name, bool data);
       static void setList(const QString &name, const QStringList &data);
+      static void setString(const QString &name, const QString &data);
 
       static Qt::CaseSensitivity getCase(const QString &name);
 
@@ -82,7 +84,6 @@ class Config
     
       static QByteArray json_ReadFile(const QString &fName);
 
-      static void load_Defaults();
       static bool read_ProjectFile(const QString &fName);
       static void msgVerify();
       static bool preVerify();
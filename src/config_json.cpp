@@ -227,6 +227,9 @@ void Config::load_Defaults()
    m_cfgBool.insert("warn-undoc-param",          struc_CfgBool   { false,          DEFAULT } );
    m_cfgString.insert("warn-format",             struc_CfgString { "$file:$line: $text", DEFAULT } );
    m_cfgString.insert("warn-logfile",            struc_CfgString { QString(),      DEFAULT } );
+   m_cfgString.insert("profile-output",          struc_CfgString { QString(),      DEFAULT } );
+   m_cfgString.insert("cache-stats-output",      struc_CfgString { QString(),      DEFAULT } );
+   m_cfgString.insert("bench-record-file",       struc_CfgString { QString(),      DEFAULT } );
 
    // tab 2 -input src
    m_cfgList.insert("input-source",              struc_CfgList   { QStringList(),   DEFAULT } );
@@ -236,6 +239,7 @@ void Config::load_Defaults()
 
    m_cfgString.insert("input-encoding",          struc_CfgString { "UTF-8",         DEFAULT } );
    m_cfgBool.insert("input-recursive",           struc_CfgBool   { false,           DEFAULT } );
+   m_cfgInt.insert("input-num-threads",          struc_CfgInt    { 0,               DEFAULT } );
 
    m_cfgList.insert("exclude-files",             struc_CfgList   { QStringList(),   DEFAULT } );
    m_cfgBool.insert("exclude-symlinks",          struc_CfgBool   { false,           DEFAULT } );
@@ -287,6 +291,10 @@ void Config::load_Defaults()
 
    m_cfgBool.insert("clang-parsing",             struc_CfgBool   { false,          DEFAULT } );
    m_cfgList.insert("clang-flags",               struc_CfgList   { QStringList(),  DEFAULT } );
+   m_cfgBool.insert("clang-single-parse",        struc_CfgBool   { false,          DEFAULT } );
+   m_cfgList.insert("clang-pch-headers",         struc_CfgList   { QStringList(),  DEFAULT } );
+   m_cfgInt.insert("clang-num-threads",          struc_CfgInt    { 1,              DEFAULT } );
+   m_cfgString.insert("clang-compilation-path",  struc_CfgString { QString(),      DEFAULT } );
 
    // tab 2 - preprocessor
    m_cfgBool.insert("enable-preprocessing",      struc_CfgBool   { true,           DEFAULT } );
@@ -305,6 +313,8 @@ void Config::load_Defaults()
    // tab 2 - external
    m_cfgList.insert("tag-files",                 struc_CfgList   { QStringList(),  DEFAULT } );
    m_cfgString.insert("generate-tagfile",        struc_CfgString { QString(),      DEFAULT } );
+   m_cfgString.insert("tag-cache-dir",           struc_CfgString { "tagcache",     DEFAULT } );
+   m_cfgBool.insert("tag-files-lazy",            struc_CfgBool   { false,          DEFAULT } );
    m_cfgBool.insert("all-externals",             struc_CfgBool   { false,          DEFAULT } );
    m_cfgBool.insert("external-groups",           struc_CfgBool   { true,           DEFAULT } );
    m_cfgBool.insert("external-pages",            struc_CfgBool   { true,           DEFAULT } );
@@ -320,6 +330,8 @@ void Config::load_Defaults()
    m_cfgString.insert("dot-font-name",           struc_CfgString { "Helvetica",    DEFAULT } );
    m_cfgInt.insert("dot-font-size",              struc_CfgInt    { 10,             DEFAULT } );
    m_cfgString.insert("dot-font-path",           struc_CfgString { QString(),      DEFAULT } );
+   m_cfgInt.insert("external-num-threads",       struc_CfgInt    { 0,              DEFAULT } );
+   m_cfgList.insert("external-tool-limits",      struc_CfgList   { QStringList(),  DEFAULT } );
 
    m_cfgBool.insert("group-graphs",              struc_CfgBool   { true,           DEFAULT } );
    m_cfgBool.insert("uml-look",                  struc_CfgBool   { false,          DEFAULT } );
@@ -335,6 +347,7 @@ void Config::load_Defaults()
    m_cfgList.insert("dia-file-dirs",             struc_CfgList   { QStringList(),  DEFAULT } );
    m_cfgString.insert("plantuml-jar-path",       struc_CfgString { QString(),      DEFAULT } );
    m_cfgList.insert("plantuml-inc-path",         struc_CfgList   { QStringList(),  DEFAULT } );
+   m_cfgBool.insert("plantuml-batch",            struc_CfgBool   { false,          DEFAULT } );
 
    m_cfgInt.insert("dot-graph-max-nodes",        struc_CfgInt    { 50,             DEFAULT } );
    m_cfgInt.insert("dot-graph-max-depth",        struc_CfgInt    { 0,              DEFAULT } );
@@ -350,6 +363,7 @@ void Config::load_Defaults()
    m_cfgBool.insert("generate-man",              struc_CfgBool   { false,          DEFAULT } );
    m_cfgBool.insert("generate-xml",              struc_CfgBool   { false,          DEFAULT } );
    m_cfgBool.insert("generate-docbook",          struc_CfgBool   { false,          DEFAULT } );
+   m_cfgInt.insert("output-num-threads",         struc_CfgInt    { 1,              DEFAULT } );
 
    m_cfgBool.insert("dot-class-graph",           struc_CfgBool   { true,           DEFAULT } );
    m_cfgBool.insert("dot-collaboration",         struc_CfgBool   { true,           DEFAULT } );
@@ -381,10 +395,15 @@ void Config::load_Defaults()
    m_cfgBool.insert("external-links-in-window",  struc_CfgBool   { false,          DEFAULT } );
 
    m_cfgBool.insert("html-search",               struc_CfgBool   { true,           DEFAULT } );
+   m_cfgBool.insert("search-compact-index",      struc_CfgBool   { false,          DEFAULT } );
+   m_cfgInt.insert("search-shard-size",          struc_CfgInt    { 64,             DEFAULT } );
    m_cfgBool.insert("search-server-based",       struc_CfgBool   { false,          DEFAULT } );
+   m_cfgBool.insert("search-mapped-index",       struc_CfgBool   { false,          DEFAULT } );
+   m_cfgInt.insert("search-index-memory",        struc_CfgInt    { 512,            DEFAULT } );
    m_cfgBool.insert("search-external",           struc_CfgBool   { false,          DEFAULT } );
    m_cfgString.insert("search-external-url",     struc_CfgString { QString(),      DEFAULT } );
    m_cfgString.insert("search-data-file",        struc_CfgString { "searchdata.xml", DEFAULT } );
+   m_cfgBool.insert("search-data-streaming",     struc_CfgBool   { false,          DEFAULT } );
    m_cfgString.insert("search-external-id",      struc_CfgString { QString(),      DEFAULT } );
    m_cfgList.insert("search-mappings",           struc_CfgList   { QStringList(),  DEFAULT } );
 
@@ -456,6 +475,7 @@ void Config::load_Defaults()
    m_cfgBool.insert("perl-latex",                struc_CfgBool   { false,          DEFAULT } );
    m_cfgBool.insert("perl-pretty",               struc_CfgBool   { true,           DEFAULT } );
    m_cfgString.insert("perl-prefix",             struc_CfgString { QString(),      DEFAULT } );
+   m_cfgBool.insert("perl-split-output",         struc_CfgBool   { false,          DEFAULT } );
 
    // tab 3 - qt help
    m_cfgBool.insert("generate-qthelp",           struc_CfgBool   { false,          DEFAULT } );
@@ -20,6 +20,7 @@
 #include <dia.h>
 
 #include <config.h>
+#include <extcmd.h>
 #include <message.h>
 #include <portable.h>
 #include <util.h>
@@ -63,7 +64,7 @@ void writeDiaGraphFromFile(const QString &inFile, const QString &outDir, const Q
 
    portable_sysTimerStart();
 
-   if ((exitCode = portable_system(diaExe, diaArgs, false)) != 0) {
+   if ((exitCode = ExtCmdManager::instance()->run("dia", diaExe, diaArgs, false)) != 0) {
       portable_sysTimerStop();
       ok = false;     
    }
@@ -78,7 +79,7 @@ void writeDiaGraphFromFile(const QString &inFile, const QString &outDir, const Q
    
          portable_sysTimerStart();
 
-         if (portable_system("epstopdf", epstopdfArgs) != 0) {
+         if (ExtCmdManager::instance()->run("epstopdf", "epstopdf", epstopdfArgs) != 0) {
             err("Unable to run epstopdf. Check your TeX installation\n");
          }
          portable_sysTimerStop();
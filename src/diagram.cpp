@@ -26,6 +26,7 @@
 #include <classdef.h>
 #include <config.h>
 #include <doxy_globals.h>
+#include <extcmd.h>
 #include <index.h>
 #include <image.h>
 #include <message.h>
@@ -1469,7 +1470,7 @@ void ClassDiagram::writeFigure(QTextStream &output, const QString &path, const Q
 
       portable_sysTimerStart();
 
-      if (portable_system("epstopdf", epstopdfArgs) != 0) {
+      if (ExtCmdManager::instance()->run("epstopdf", "epstopdf", epstopdfArgs) != 0) {
          err("Unable to run epstopdf. Verify your TeX installation\n");
          portable_sysTimerStop();
          return;
@@ -0,0 +1,253 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+
+#if ! defined(_WIN32) || defined(__CYGWIN__)
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include <dirscanner.h>
+
+namespace {
+
+struct RawEntry {
+   QString name;
+   QString sortKey;
+   bool    isDir;
+   bool    isSymLink;
+};
+
+}
+
+static QString joinPath(const QString &dirPath, const QString &name)
+{
+   if (dirPath.endsWith('/')) {
+      return dirPath + name;
+   }
+
+   return dirPath + '/' + name;
+}
+
+static bool isReadable(const QString &filePath)
+{
+#if defined(_WIN32) && ! defined(__CYGWIN__)
+   return QFileInfo(filePath).isReadable();
+#else
+   return access(QFile::encodeName(filePath).constData(), R_OK) == 0;
+#endif
+}
+
+// list the files and directories in dirPath, special files and broken symlinks are skipped
+// as QDir does when QDir::System is not set
+static void listDirectory(const QString &dirPath, QVector<RawEntry> &list)
+{
+#if defined(_WIN32) && ! defined(__CYGWIN__)
+   QDir dir(dirPath);
+   dir.setFilter(QDir::Files | QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+   dir.setSorting(QDir::Unsorted);
+
+   const QFileInfoList infoList = dir.entryInfoList();
+
+   for (const auto &fi : infoList) {
+      list.append(RawEntry{fi.fileName(), fi.fileName().toLower(), fi.isDir(), fi.isSymLink()});
+   }
+
+#else
+   DIR *dir = opendir(QFile::encodeName(dirPath).constData());
+
+   if (dir == nullptr) {
+      return;
+   }
+
+   struct dirent *item;
+
+   while ((item = readdir(dir)) != nullptr) {
+      const char *name = item->d_name;
+
+      if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) {
+         continue;
+      }
+
+      QString fileName = QFile::decodeName(name);
+
+      bool isDir     = false;
+      bool isFile    = false;
+      bool isSymLink = false;
+      bool needStat  = true;
+
+#if defined(DT_UNKNOWN)
+      // d_type saves a stat call for plain files and directories
+      if (item->d_type == DT_REG) {
+         isFile   = true;
+         needStat = false;
+
+      } else if (item->d_type == DT_DIR) {
+         isDir    = true;
+         needStat = false;
+
+      } else if (item->d_type == DT_LNK) {
+         isSymLink = true;
+
+      } else if (item->d_type != DT_UNKNOWN) {
+         // fifo, socket or device
+         continue;
+      }
+#endif
+
+      if (needStat) {
+         QByteArray fullName = QFile::encodeName(joinPath(dirPath, fileName));
+         struct stat st;
+
+         if (! isSymLink) {
+            if (lstat(fullName.constData(), &st) != 0) {
+               continue;
+            }
+
+            isSymLink = S_ISLNK(st.st_mode);
+         }
+
+         if (isSymLink && stat(fullName.constData(), &st) != 0) {
+            // broken symlink
+            continue;
+         }
+
+         isFile = S_ISREG(st.st_mode);
+         isDir  = S_ISDIR(st.st_mode);
+      }
+
+      if (isFile || isDir) {
+         list.append(RawEntry{fileName, fileName.toLower(), isDir, isSymLink});
+      }
+   }
+
+   closedir(dir);
+#endif
+
+   // same order as the default sort of QDir, by name ignoring case
+   std::sort(list.begin(), list.end(), [] (const RawEntry &a, const RawEntry &b) {
+      if (a.sortKey != b.sortKey) {
+         return a.sortKey < b.sortKey;
+      }
+
+      return a.name < b.name;
+   } );
+}
+
+DirScanner::DirScanner(const QSet<QString> &excludeSet, const FilePatternSet &includePatterns,
+                  const FilePatternSet &excludePatterns, bool recursive, bool excludeSymlinks)
+   : m_excludeSet(excludeSet), m_includePatterns(includePatterns), m_excludePatterns(excludePatterns),
+     m_recursive(recursive), m_excludeSymlinks(excludeSymlinks), m_pool(nullptr)
+{
+}
+
+QSharedPointer<DirScanNode> DirScanner::scan(const QString &path)
+{
+   QSharedPointer<DirScanNode> root = QMakeShared<DirScanNode>();
+   root->path = path;
+
+   // without recursion only one directory is read
+   WorkerPool pool(m_recursive ? WorkerPool::threadCount("input-num-threads") : 0);
+
+   m_pool = &pool;
+
+   addWork(root);
+   pool.waitForDone();
+
+   m_pool = nullptr;
+
+   return root;
+}
+
+void DirScanner::addWork(QSharedPointer<DirScanNode> node)
+{
+   m_pool->start([this, node] () {
+      readNode(node);
+   } );
+}
+
+void DirScanner::readNode(QSharedPointer<DirScanNode> node)
+{
+   QVector<RawEntry> list;
+   listDirectory(node->path, list);
+
+   for (const auto &item : list) {
+      QString filePath = joinPath(node->path, item.name);
+
+      if (m_excludeSet.contains(filePath)) {
+         continue;
+      }
+
+      if (m_excludeSymlinks && item.isSymLink) {
+         continue;
+      }
+
+      QFileInfo fi(filePath);
+
+      DirScanEntry entry;
+      entry.fileName = item.name;
+      entry.filePath = filePath;
+
+      if (! item.isDir) {
+
+         if (! m_includePatterns.isEmpty() && ! m_includePatterns.match(fi)) {
+            continue;
+         }
+
+         if (m_excludePatterns.match(fi)) {
+            continue;
+         }
+
+         entry.kind = isReadable(filePath) ? DirScanEntry::File : DirScanEntry::Unreadable;
+         node->entries.append(entry);
+
+      } else if (! isReadable(filePath)) {
+         entry.kind = DirScanEntry::Unreadable;
+         node->entries.append(entry);
+
+      } else if (m_recursive) {
+
+         if (item.name.at(0) == '.') {
+            continue;
+         }
+
+         if (m_excludePatterns.match(fi)) {
+            continue;
+         }
+
+         if (item.isSymLink) {
+            // resolved by the caller so symlinks are visited in the same order as before
+            entry.kind = DirScanEntry::SymLinkDir;
+
+         } else {
+            entry.kind = DirScanEntry::Dir;
+            entry.node = QMakeShared<DirScanNode>();
+            entry.node->path = filePath;
+
+            addWork(entry.node);
+         }
+
+         node->entries.append(entry);
+      }
+   }
+}
@@ -0,0 +1,84 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#ifndef DIRSCANNER_H
+#define DIRSCANNER_H
+
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include <filepatterns.h>
+#include <workerpool.h>
+
+struct DirScanNode;
+
+/** One entry of a scanned directory, entries are sorted the same way as QDir::entryInfoList() */
+struct DirScanEntry {
+   enum Kind {
+      File,
+      Dir,
+      SymLinkDir,
+      Unreadable
+   };
+
+   Kind    kind;
+   QString fileName;
+   QString filePath;
+
+   // contents of the directory when kind is Dir
+   QSharedPointer<DirScanNode> node;
+};
+
+/** A directory and the entries which passed the scan filters */
+struct DirScanNode {
+   QString path;
+   QVector<DirScanEntry> entries;
+};
+
+/** @brief Reads a directory tree using a worker pool
+ *
+ *  Each directory is read by a task of its own, the subdirectories it contains are queued as
+ *  new tasks. Directories which are symbolic links are not followed, they are returned as
+ *  SymLinkDir so the caller can visit them in order. Files are tested against the include and
+ *  exclude patterns while the tree is read.
+ */
+class DirScanner
+{
+ public:
+   DirScanner(const QSet<QString> &excludeSet, const FilePatternSet &includePatterns,
+                  const FilePatternSet &excludePatterns, bool recursive, bool excludeSymlinks);
+
+   /** Reads the directory \a path, returns the root of the tree */
+   QSharedPointer<DirScanNode> scan(const QString &path);
+
+ private:
+   void addWork(QSharedPointer<DirScanNode> node);
+   void readNode(QSharedPointer<DirScanNode> node);
+
+   const QSet<QString> &m_excludeSet;
+   const FilePatternSet &m_includePatterns;
+   const FilePatternSet &m_excludePatterns;
+
+   bool m_recursive;
+   bool m_excludeSymlinks;
+
+   // pool of the current scan
+   WorkerPool *m_pool;
+};
+
+#endif
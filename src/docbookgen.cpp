@@ -37,6 +37,7 @@
 #include <message.h>
 #include <membergroup.h>
 #include <outputgen.h>
+#include <outputwriter.h>
 #include <parse_base.h>
 #include <util.h>
 
@@ -86,6 +87,9 @@ class DocbookSectionMapper : public QHash<long, QString>
 
 static DocbookSectionMapper g_docbookSectionMapper;
 
+// writes the compound files, see OutputFileWriter
+static OutputFileWriter *s_docbookWriter = nullptr;
+
 
 inline void writeDocbookString(QTextStream &t, const QString &text)
 {
@@ -1190,15 +1194,9 @@ static void generateDocbookForClass(QSharedPointer<ClassDef> cd, QTextStream &ti
    //  
    QString fileName  = docbookOutDir + "/" + classOutputFileBase(cd) + ".xml";
    QString relPath   = relativePathToRoot(fileName);
- 
-   QFile fi(fileName);
-
-   if (! fi.open(QIODevice::WriteOnly)) {
-      err("Unable to open file for writing %s, error: %d\n", csPrintable(fileName), fi.error());
-      return;
-   }
 
-   QTextStream t(&fi);
+   QueuedOutputFile outFile(*s_docbookWriter, fileName);
+   QTextStream &t = outFile.stream();
  
    writeDocbookHeader_ID(t, classOutputFileBase(cd));
    t << "<title>";
@@ -1333,14 +1331,8 @@ static void generateDocbookForNamespace(QSharedPointer<NamespaceDef> nd, QTextSt
 
   QString fileName = outputDirectory + "/" + nd->getOutputFileBase() + ".xml";
 
-   QFile f(fileName);
-
-   if (! f.open(QIODevice::WriteOnly)) {
-      err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
-      return;
-   }
-
-   QTextStream t(&f);
+   QueuedOutputFile outFile(*s_docbookWriter, fileName);
+   QTextStream &t = outFile.stream();
    writeDocbookHeader_ID(t, nd->getOutputFileBase());
 
    t << "<title>";
@@ -1420,14 +1412,8 @@ static void generateDocbookForFile(QSharedPointer<FileDef> fd, QTextStream &ti)
    QString fileName = outputDirectory + "/" + fd->getOutputFileBase() + ".xml";
    QString relPath = relativePathToRoot(fileName);
 
-   QFile f(fileName);
-
-   if (! f.open(QIODevice::WriteOnly)) {
-      err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
-      return;
-   }
-
-   QTextStream t(&f);
+   QueuedOutputFile outFile(*s_docbookWriter, fileName);
+   QTextStream &t = outFile.stream();
    writeDocbookHeader_ID(t, fd->getOutputFileBase());
 
    t << "    <title>";
@@ -1542,14 +1528,8 @@ static void generateDocbookForGroup(QSharedPointer<GroupDef> gd, QTextStream &ti
    QString fileName = outputDirectory + "/" + gd->getOutputFileBase() + ".xml";
    QString relPath = relativePathToRoot(fileName);
 
-   QFile f(fileName);
-
-   if (! f.open(QIODevice::WriteOnly)) {
-      err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
-      return;
-   }
-
-   QTextStream t(&f);
+   QueuedOutputFile outFile(*s_docbookWriter, fileName);
+   QTextStream &t = outFile.stream();
    //t.setEncoding(QTextStream::UnicodeUTF8);
    writeDocbookHeader_ID(t, gd->getOutputFileBase());
 
@@ -1613,15 +1593,10 @@ static void generateDocbookForDir(QSharedPointer<DirDef> dd, QTextStream &ti)
    QString outputDirectory = Config::getString("docbook-output");
    QString fileName = outputDirectory + "/" + dd->getOutputFileBase() + ".xml";
 
-   QFile f(fileName);
    QString relPath = relativePathToRoot(fileName);
 
-   if (! f.open(QIODevice::WriteOnly)) {
-      err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
-      return;
-   }
-
-   QTextStream t(&f);
+   QueuedOutputFile outFile(*s_docbookWriter, fileName);
+   QTextStream &t = outFile.stream();
    writeDocbookHeader_ID(t, dd->getOutputFileBase());
 
    t << "    <title>";
@@ -1672,14 +1647,8 @@ static void generateDocbookForPage(QSharedPointer<PageDef> pd, QTextStream &ti,
    QString outputDirectory = Config::getString("docbook-output");
    QString fileName = outputDirectory + "/" + pageName + ".xml";
 
-   QFile f(fileName);
-
-   if (! f.open(QIODevice::WriteOnly)) {
-      err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
-      return;
-   }
-
-   QTextStream t(&f);
+   QueuedOutputFile outFile(*s_docbookWriter, fileName);
+   QTextStream &t = outFile.stream();
 
    QString pName = pageName;
 
@@ -1797,6 +1766,9 @@ void generateDocbook()
    QTextStream t(&f);
    //t.setEncoding(QTextStream::UnicodeUTF8);
 
+   OutputFileWriter writer;
+   s_docbookWriter = &writer;
+
    // write index header for Docbook which calls the structure file
    t << "<?xml version='1.0' encoding='UTF-8' standalone='no'?>" << endl;;
    t << "<book xmlns=\"http://docbook.org/ns/docbook\" version=\"5.0\" xmlns:xlink=\"http://www.w3.org/1999/xlink\">" << endl;
@@ -1934,4 +1906,7 @@ void generateDocbook()
    }
 
    t << "</book>" << endl;
+
+   writer.finish();
+   s_docbookWriter = nullptr;
 }
@@ -33,6 +33,7 @@
 #include <cmdmapper.h>
 #include <doctokenizer.h>
 #include <doxy_globals.h>
+#include <extcmd.h>
 #include <formula.h>
 #include <htmlentity.h>
 #include <language.h>
@@ -332,7 +333,7 @@ static QString findAndCopyImage(const QString &fileName, DocImage::Type type)
 
          portable_sysTimerStart();
 
-         if (portable_system("epstopdf", epstopdfArgs) != 0) {
+         if (ExtCmdManager::instance()->run("epstopdf", "epstopdf", epstopdfArgs) != 0) {
             err("Problem running epstopdf, verify TeX installation\n");
          }
 
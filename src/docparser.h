@@ -26,6 +26,7 @@
 #include <docvisitor.h>
 #include <htmlattrib.h>
 #include <membergroup.h>
+#include <memorystats.h>
 
 /*! Main entry point for the documentation parser.
  *
@@ -60,7 +61,7 @@ void docFindSections(const QString &input, QSharedPointer<Definition> def,
                   QSharedPointer<MemberGroup> mg, const QString &fileName);
 
 /** Abstract node interface with type information. */
-class DocNode
+class DocNode : private MemoryCounted<MemoryStats::DocNodeKind>
 {
  public:
    /*! Available node types. */
@@ -23,10 +23,12 @@
 
 #include <dot.h>
 
+#include <cachestats.h>
 #include <config.h>
 #include <default_args.h>
 #include <docparser.h>
 #include <doxy_globals.h>
+#include <extcmd.h>
 #include <groupdef.h>
 #include <language.h>
 #include <message.h>
@@ -708,8 +710,9 @@ static void removeDotGraph(const QString &dotName)
  *  are compared with \a md5. If equal false is returned. If the .md5
  *  file does not exist or its contents are not equal to \a md5,
  *  a new .md5 is generated with the \a md5 string as contents.
+ *  The size of the graph \a graphSize is reported to the cache statistics.
  */
-static bool checkAndUpdateMd5Signature(const QString &baseName, const QString &md5)
+static bool checkAndUpdateMd5Signature(const QString &baseName, const QString &md5, int graphSize)
 {
    QFile f(baseName + ".md5");
 
@@ -721,12 +724,21 @@ static bool checkAndUpdateMd5Signature(const QString &baseName, const QString &m
       if (md5 == md5stored) {
          // bail out if equal
          f.close();
+
+         if (CacheStats::isEnabled()) {
+            CacheStats::record("dot-md5", CacheStats::Hit, graphSize);
+         }
+
          return false;
       }
    }
 
    f.close();
 
+   if (CacheStats::isEnabled()) {
+      CacheStats::record("dot-md5", CacheStats::Miss, graphSize);
+   }
+
    // create checksum file
    if (f.open(QIODevice::WriteOnly)) {
       f.write(md5.toUtf8());
@@ -801,7 +813,7 @@ bool DotRunner::run()
          dotArgs += s;
       }
 
-      if ((exitCode = portable_system(m_dotExe, dotArgs, false)) != 0) {
+      if ((exitCode = ExtCmdManager::instance()->run("dot", m_dotExe, dotArgs, false)) != 0) {
          goto error;
       }
 
@@ -809,13 +821,13 @@ bool DotRunner::run()
       for (auto s : m_jobs) {
          dotArgs = "\"" + m_file + "\" " + s;
 
-         if ((exitCode = portable_system(m_dotExe, dotArgs, false)) != 0) {
+         if ((exitCode = ExtCmdManager::instance()->run("dot", m_dotExe, dotArgs, false)) != 0) {
             goto error;
          }
       }
    }
 
-   if (! m_postCmd.isEmpty() && portable_system(m_postCmd, m_postArgs) != 0) {
+   if (! m_postCmd.isEmpty() && ExtCmdManager::instance()->run("dot", m_postCmd, m_postArgs) != 0) {
       std::lock_guard<std::mutex> lock(m_output_mutex);
 
       err("Unable to run '%s' as a post-processing step for dot output\n", csPrintable(m_postCmd));
@@ -2365,7 +2377,7 @@ void DotGfxHierarchyTable::writeGraph(QTextStream &out, const QString &path, con
 
       bool regenerate = false;
 
-      if (checkAndUpdateMd5Signature(absBaseName, sigStr) || ! checkDeliverables(absImgName, absMapName)) {
+      if (checkAndUpdateMd5Signature(absBaseName, sigStr, theGraph.size()) || ! checkDeliverables(absImgName, absMapName)) {
          regenerate = true;
 
          // image was new or has changed
@@ -3058,7 +3070,7 @@ static bool updateDotGraph(DotNode *root, DotNode::GraphType gt, const QString &
       t << theGraph;
    }
 
-   return checkAndUpdateMd5Signature(baseName, md5); // graph needs to be regenerated
+   return checkAndUpdateMd5Signature(baseName, md5, theGraph.size()); // graph needs to be regenerated
 }
 
 QString DotClassGraph::diskName() const
@@ -3942,7 +3954,7 @@ QString DotDirDeps::writeGraph(QTextStream &out, GraphOutputFormat graphFormat,
    bool regenerate = false;
 
    bool ok = false;
-   bool x  = checkAndUpdateMd5Signature(absBaseName, sigStr);
+   bool x  = checkAndUpdateMd5Signature(absBaseName, sigStr, theGraph.size());
 
    if (x) {
       ok = true;
@@ -4143,7 +4155,7 @@ void generateGraphLegend(const QString &path)
    QString imgName     = "graph_legend."   + imageExt;
    QString absImgName  = absBaseName + "." + imageExt;
 
-   if (checkAndUpdateMd5Signature(absBaseName, sigStr) || ! checkDeliverables(absImgName)) {
+   if (checkAndUpdateMd5Signature(absBaseName, sigStr, theGraph.size()) || ! checkDeliverables(absImgName)) {
       QFile dotFile(absDotName);
 
       if (! dotFile.open(QIODevice::WriteOnly)) {
@@ -4522,7 +4534,7 @@ QString DotGroupCollaboration::writeGraph( QTextStream &t, GraphOutputFormat gra
    bool regenerate = false;
    bool ok;
 
-   bool x  = checkAndUpdateMd5Signature(absBaseName, sigStr);
+   bool x  = checkAndUpdateMd5Signature(absBaseName, sigStr, theGraph.size());
 
    if (x) {
       ok = true;
@@ -16,7 +16,10 @@
 *************************************************************************/
 
 #include <doxy_globals.h>
+#include <cachestats.h>
 #include <filedef.h>
+#include <memorystats.h>
+#include <profiler.h>
 
 class GenericsSDict;
 class IndexList;
@@ -125,3 +128,65 @@ QHash<QString, Definition *>  &Doxy_Globals::glossary()
    static QHash<QString, Definition *> data;
    return data;
 }
+
+void Statistics::begin(const QString &name)
+{
+   msg(name);
+
+   Profiler &profiler = Profiler::instance();
+
+   StatData entry(name, openList.count());
+   entry.startTime     = profiler.now();
+   entry.startWaitTime = profiler.waitTime();
+
+   openList.append(statList.count());
+   statList.append(std::move(entry));
+
+   CacheStats::setSite(name);
+
+   // scopes inside of this phase are nested one level deeper
+   Profiler::scopeDepth()++;
+}
+
+void Statistics::end()
+{
+   if (openList.isEmpty()) {
+      return;
+   }
+
+   Profiler &profiler = Profiler::instance();
+   StatData &entry    = statList[openList.takeLast()];
+
+   qint64 duration = profiler.now() - entry.startTime;
+
+   entry.elapsed  = duration / 1000000.0;
+   entry.peakRss  = Profiler::peakRss();
+   entry.waitTime = (profiler.waitTime() - entry.startWaitTime) / 1000000.0;
+
+   Profiler::scopeDepth()--;
+   profiler.addEvent(entry.name, "phase", entry.startTime, duration, entry.depth, entry.peakRss);
+
+   // events after this phase belong to the enclosing phase
+   CacheStats::setSite(openList.isEmpty() ? QString() : statList[openList.last()].name);
+
+   if (MemoryStats::isEnabled()) {
+      MemoryStats::print(entry.name);
+   }
+}
+
+void Statistics::print()
+{
+   msg("\n");
+   msg("----------------------\n");
+
+   for (const auto &item : statList) {
+      QString extra = QString(", peak memory %1 MB").arg(item.peakRss / (1024.0 * 1024.0), 0, 'f', 1);
+
+      if (item.waitTime > 0.0005) {
+         extra += QString(", waiting for tools %1 seconds").arg(item.waitTime, 0, 'f', 3);
+      }
+
+      msg("%.3f seconds %s%s%s\n", item.elapsed, csPrintable(QString(item.depth * 2, ' ')),
+                  csPrintable(item.name.trimmed()), csPrintable(extra));
+   }
+}
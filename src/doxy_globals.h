@@ -68,45 +68,42 @@ class StringDict : public QHash<QString, QString>
    {}
 };
 
+/** @brief Wall clock time, peak memory and external tool wait time of the processing phases
+ *
+ *  A phase which begins before the previous one has ended is nested inside of it. The
+ *  phases are printed with the time debug flag and also recorded as events of the Profiler.
+ */
 class Statistics
 {
  public:
    Statistics()
    {}
 
-   void begin(const QString &name) {
-      msg(name);
-
-      StatData entry(name);
-      statList.append(std::move(entry));
-
-      time.restart();
-   }
+   void begin(const QString &name);
+   void end();
 
-   void end() {
-      statList.last().elapsed = ((double)time.elapsed()) / 1000.00;
-   }
-
-   void print() {
-      msg("\n");
-      msg("----------------------\n");
-
-      for (const auto &item : statList) {
-         msg("%.3f seconds %s", item.elapsed, csPrintable(item.name));
-      }
-   }
+   void print();
 
  private:
    struct StatData {
-      StatData(const QString &n) : name(n), elapsed(0)
+      StatData(const QString &n, int d)
+         : name(n), depth(d), elapsed(0), peakRss(0), waitTime(0), startTime(0), startWaitTime(0)
       {}
 
       QString name;
-      double elapsed;
+      int     depth;
+
+      double  elapsed;
+      qint64  peakRss;
+      double  waitTime;
+
+      // values when the phase began
+      qint64  startTime;
+      qint64  startWaitTime;
    };
 
    QList<StatData> statList;
-   QTime time;
+   QList<int> openList;
 };
 
 namespace Doxy_Work{
@@ -40,6 +40,7 @@
 #include <language.h>
 #include <latexgen.h>
 #include <layout.h>
+#include <memorystats.h>
 #include <outputlist.h>
 #include <parse_cstyle.h>
 #include <parse_file.h>
@@ -70,6 +71,7 @@ enum Options {
      DATETIME,
      HELP,
      OUTPUT_APP,
+     SEARCH_INDEX,
      DVERSION,
 };
 
@@ -80,6 +82,9 @@ void initDoxyPress()
 {
    printf("\nInitialization\n");
 
+   // before the first counted object is created
+   MemoryStats::setEnabled(Debug::isFlagSet(Debug::Memory));
+
    const QString lang = portable_getenv("LC_ALL");
 
    if (! lang.isEmpty()) {
@@ -159,6 +164,7 @@ struct CommandLine parseCommandLine(QStringList argList)
    argMap.insert( "--w",       BLANK_STYLE     );
    argMap.insert( "--v",       DVERSION        );
    argMap.insert( "--dt",      DATETIME        );
+   argMap.insert( "--search",  SEARCH_INDEX    );
    argMap.insert( "--help",    HELP            );
    argMap.insert( "--version", DVERSION        );
 
@@ -358,6 +364,18 @@ struct CommandLine parseCommandLine(QStringList argList)
             cmdArgs.dateTimeStr = getValue(iter, argList.end());
             break;
 
+         case SEARCH_INDEX:
+            cmdArgs.searchIndex = getValue(iter, argList.end());
+            cmdArgs.searchQuery = getValue(iter, argList.end());
+
+            if (cmdArgs.searchIndex.isEmpty() || cmdArgs.searchQuery.isEmpty()) {
+               err("Option \"--search\" requires an index file name and a query\n");
+               Doxy_Work::stopDoxyPress();
+            }
+
+            cmdArgs.generateDoxy = false;
+            break;
+
          case HELP:
             usage();
             exit(0);
@@ -678,6 +696,10 @@ void Doxy_Setup::usage()
    printf("Use the passed date/time value in the documentation:\n");
    printf("   --dt  [date_time]   Default is current date and time\n");
 
+   printf("\n");
+   printf("Query a server side search index (search/search.dxi, written when search-mapped-index is set):\n");
+   printf("   --search  <index file> <query>   Words starting with + are required, - excluded\n");
+
    printf("\n");
    printf("Other Options:\n");
    printf("   --h  display usage\n");
@@ -41,6 +41,9 @@ struct CommandLine {
    QString latexHead;
    QString latexFoot;
    QString latexStyle;
+
+   QString searchIndex;
+   QString searchQuery;
   
    bool generateLayout = false;   
    bool generateDoxy   = true;
@@ -23,6 +23,8 @@
 #include <set>
 
 #include <arguments.h>
+#include <benchrecorder.h>
+#include <cachestats.h>
 #include <cite.h>
 #include <cmdmapper.h>
 #include <code_cstyle.h>
@@ -32,6 +34,7 @@
 #include <declinfo.h>
 #include <default_args.h>
 #include <dirdef.h>
+#include <dirscanner.h>
 #include <docbookgen.h>
 #include <docparser.h>
 #include <docsets.h>
@@ -40,7 +43,10 @@
 #include <doxy_globals.h>
 #include <eclipsehelp.h>
 #include <entry.h>
+#include <extcmd.h>
+#include <filepatterns.h>
 #include <filestorage.h>
+#include <filtercache.h>
 #include <formula.h>
 #include <ftvhelp.h>
 #include <groupdef.h>
@@ -66,8 +72,10 @@
 #include <parse_py.h>
 #include <parse_tcl.h>
 #include <perlmodgen.h>
+#include <plantuml.h>
 #include <portable.h>
 #include <pre.h>
+#include <profiler.h>
 #include <qhp.h>
 #include <rtfgen.h>
 #include <store.h>
@@ -369,8 +377,8 @@ struct ReadDirArgs {
    bool recursive = false;
    bool errorIfNotExist = true;
 
-   QStringList includePatternList;
-   QStringList excludePatternList;
+   FilePatternSet includePatterns;
+   FilePatternSet excludePatterns;
 
    QSet<QString> excludeSet;
 
@@ -395,6 +403,7 @@ struct ReadDirArgs {
 
    void readFileOrDirectory(const QString &fileName, ReadDirArgs &data);
    void readDir(const QFileInfo &fileInfo, ReadDirArgs &data);
+   void addScannedDir(const DirScanNode &node, ReadDirArgs &data);
 
    void resolveClassNestingRelations();
    void resolveHiddenNamespace();
@@ -439,6 +448,15 @@ void processFiles()
    uint lookupSize = (65536 << cacheSize);
    Doxy_Globals::lookupCache.setMaxCost(lookupSize);
 
+   Profiler::instance().setEnabled(Debug::isFlagSet(Debug::Time) || ! Config::getString("profile-output").isEmpty());
+   CacheStats::setEnabled(Debug::isFlagSet(Debug::Time) || ! Config::getString("cache-stats-output").isEmpty());
+
+   const QString benchRecordFile = Config::getString("bench-record-file");
+
+   if (! benchRecordFile.isEmpty()) {
+      BenchRecorder::open(benchRecordFile);
+   }
+
 #ifdef HAS_SIGNALS
    signal(SIGINT, stopDoxyPress);
 #endif
@@ -588,19 +606,43 @@ void processFiles()
 
    const QStringList tagFileList = Config::getList("tag-files");
 
+   const bool lazyTagFiles = ! tagFileList.isEmpty() && Config::getBool("tag-files-lazy");
+
+   if (lazyTagFiles) {
+      // only tag file symbols which are named in the input are added
+      collectTagReferences(Doxy_Globals::g_inputFiles);
+   }
+
    for (auto s : tagFileList) {
       readTagFile(root, csPrintable(s));
+
+      if (! lazyTagFiles) {
+         root->createNavigationIndex(rootNav, Doxy_Globals::fileStorage, QSharedPointer<FileDef>(), root);
+      }
+   }
+
+   if (lazyTagFiles) {
+      // a base class can be in another tag file, the symbols are added once every file is read
+      buildReferencedTagFiles(root);
       root->createNavigationIndex(rootNav, Doxy_Globals::fileStorage, QSharedPointer<FileDef>(), root);
    }
 
+   releaseTagReferences();
+
    // parse source files
    if (Config::getBool("built-in-stl-support")) {
       addSTLClasses(rootNav);
    }
 
+   // run input filters ahead of the parser
+   if (! Config::getString("filter-program").isEmpty() || ! Config::getList("filter-patterns").isEmpty()) {
+      FilterCache::instance().prefetch(Doxy_Globals::g_inputFiles, false);
+   }
+
    msg("\n**  ");
    Doxy_Globals::infoLog_Stat.begin("Parsing files\n");
    parseFiles(root, rootNav);
+   FilterCache::instance().finishPrefetch();
 
    Doxy_Globals::fileStorage.close();
    Doxy_Globals::infoLog_Stat.end();
@@ -695,6 +737,7 @@ void processFiles()
    // UNO IDL
    Doxy_Globals::infoLog_Stat.begin("Building interface member list\n");
    buildInterfaceAndServiceList(rootNav);
+   Doxy_Globals::infoLog_Stat.end();
 
    // using class info only
    Doxy_Globals::infoLog_Stat.begin("Building member list\n");
@@ -1021,10 +1064,24 @@ void generateOutput()
 
    if (! Htags::useHtags) {
       Doxy_Globals::infoLog_Stat.begin("Generating source code\n");
+
+      if (Config::getBool("filter-source-files") && ! Config::getList("filter-source-patterns").isEmpty()) {
+         FilterCache::instance().prefetch(Doxy_Globals::g_inputFiles, true);
+      }
+
       generateSourceCode();
+      FilterCache::instance().finishPrefetch();
       Doxy_Globals::infoLog_Stat.end();
    }
 
+   // source browser was the last reader of the filter output, the clang buffers and the saved AST files
+   FilterCache::instance().clear();
+
+   if (Config::getBool("clang-parsing")) {
+      ClangParser::instance()->removeSavedAsts();
+      ClangParser::instance()->releaseBuffers();
+   }
+
    Doxy_Globals::infoLog_Stat.begin("Generating file documentation\n");
    generateFileDocs();
    Doxy_Globals::infoLog_Stat.end();
@@ -1121,26 +1178,25 @@ void generateOutput()
          // write own search index
 
          HtmlGenerator::writeSearchPage();
-         Doxy_Globals::searchIndexBase->write(htmlOutput + "/search/search.idx");
+         QString mappedFile;
+
+         if (Config::getBool("search-mapped-index")) {
+            // index for the --search option, see searchfile.h
+            mappedFile = htmlOutput + "/search/search.dxi";
+         }
+
+         Doxy_Globals::searchIndexBase.staticCast<SearchIndex>()->write(htmlOutput + "/search/search.idx", mappedFile);
 
       } else {
          // write data for external search index
          HtmlGenerator::writeExternalSearchPage();
 
-         QString searchDataFile = Config::getString("search-data-file");
-
-         if (searchDataFile.isEmpty()) {
-            searchDataFile = "searchdata.xml";
-         }
-
-         if (! QDir::isAbsolutePath(searchDataFile)) {
-            QString outputDirectory = Config::getString("output-dir");
-            searchDataFile.prepend(outputDirectory + "/");
-         }
-
-         Doxy_Globals::searchIndexBase->write(searchDataFile);
+         Doxy_Globals::searchIndexBase->write(externalSearchDataFile());
       }
 
+      // release the postings and remove the temporary spill file
+      Doxy_Globals::searchIndexBase = QSharedPointer<SearchIndex_Base>();
+
       Doxy_Globals::infoLog_Stat.end();
    }
 
@@ -1154,6 +1210,13 @@ void generateOutput()
       Doxy_Globals::infoLog_Stat.end();
    }
 
+   if (Config::getBool("plantuml-batch")) {
+      Doxy_Globals::infoLog_Stat.begin("Running PlantUML\n");
+
+      PlantUMLManager::instance()->run();
+      Doxy_Globals::infoLog_Stat.end();
+   }
+
    if (Config::getBool("have-dot")) {
       Doxy_Globals::infoLog_Stat.begin("Running dot\n");
 
@@ -1180,52 +1243,71 @@ void generateOutput()
       Doxy_Globals::infoLog_Stat.end();
    }
 
-   if (generateHtml && Config::getBool("generate-chm") && ! Config::getString("hhc-location").isEmpty()) {
-
-      Doxy_Globals::infoLog_Stat.begin("Running html help compiler\n");
-      QString oldDir = QDir::currentPath();
-      QDir::setCurrent(htmlOutput);
-
-      portable_sysTimerStart();
+   // help compilers run in the background while the remaining work is done
+   QSharedPointer<ExtCmdJob> hhcJob;
+   QSharedPointer<ExtCmdJob> qhpJob;
 
+   if (generateHtml && Config::getBool("generate-chm") && ! Config::getString("hhc-location").isEmpty()) {
       // this was false, now it is testing the extcmd flag
       bool isDebug = Debug::isFlagSet(Debug::ExtCmd);
 
-      if (portable_system(Config::getString("hhc-location"), "index.hhp", isDebug)) {
-         err("Unable to run HTML Help compiler on 'index.hhp'\n");
-      }
-
-      portable_sysTimerStop();
-      QDir::setCurrent(oldDir);
-      Doxy_Globals::infoLog_Stat.end();
+      hhcJob = ExtCmdManager::instance()->submit("hhc", Config::getString("hhc-location"), "index.hhp", isDebug, htmlOutput);
    }
 
    if ( generateHtml && Config::getBool("generate-qthelp") && ! Config::getString("qthelp-gen-path").isEmpty()) {
-      Doxy_Globals::infoLog_Stat.begin("Running QtHelp generator\n");
-
       QString qhpFileName = Qhp::getQhpFileName();
       QString qchFileName = getQchFileName();
 
       QString args = QString("%1 -o \"%2\"").arg(qhpFileName).arg(qchFileName);
 
-      QString const oldDir = QDir::currentPath();
-      QDir::setCurrent(htmlOutput);
+      qhpJob = ExtCmdManager::instance()->submit("qhelpgenerator", Config::getString("qthelp-gen-path"), args, false, htmlOutput);
+   }
+
+   if (hhcJob) {
+      Doxy_Globals::infoLog_Stat.begin("Running html help compiler\n");
+
+      if (ExtCmdManager::instance()->wait(hhcJob) != 0) {
+         err("Unable to run HTML Help compiler on 'index.hhp'\n");
+      }
+
+      Doxy_Globals::infoLog_Stat.end();
+   }
 
-      portable_sysTimerStart();
+   if (qhpJob) {
+      Doxy_Globals::infoLog_Stat.begin("Running QtHelp generator\n");
 
-      if (portable_system(Config::getString("qthhelp-gen-path"), args, false)) {
+      if (ExtCmdManager::instance()->wait(qhpJob) != 0) {
          err("Unable to run qhelpgenerator on 'index.qhp'\n");
       }
 
-      portable_sysTimerStop();
-      QDir::setCurrent(oldDir);
       Doxy_Globals::infoLog_Stat.end();
    }
 
+   ExtCmdManager::instance()->waitAll();
+   ExtCmdManager::instance()->shutDown();
+
+   BenchRecorder::close();
+
    msg("Lookup cache used %d/%d \n", Doxy_Globals::lookupCache.count(), Doxy_Globals::lookupCache.size());
 
+   CacheStats::setUsage("lookup-cache", Doxy_Globals::lookupCache.count(), Doxy_Globals::lookupCache.maxCost());
+
+   const QString profileOutput = Config::getString("profile-output");
+
+   if (! profileOutput.isEmpty() && ! Profiler::instance().write(profileOutput)) {
+      err("Unable to write profile %s\n", csPrintable(profileOutput));
+   }
+
+   const QString cacheStatsOutput = Config::getString("cache-stats-output");
+
+   if (! cacheStatsOutput.isEmpty() && ! CacheStats::write(cacheStatsOutput)) {
+      err("Unable to write cache statistics %s\n", csPrintable(cacheStatsOutput));
+   }
+
    if (Debug::isFlagSet(Debug::Time)) {
       Doxy_Globals::infoLog_Stat.print();
+      CacheStats::print();
+      ExtCmdManager::instance()->printStatistics();
 
    } else {
       msg("Finished\n");
@@ -8339,6 +8421,7 @@ void Doxy_Work::generateFileDocs()
 
             if (doc) {
                msg("Generating docs for file %s\n", csPrintable(fd->docName()));
+               ProfileScope profile("output", fd->docName());
                fd->writeDocumentation(Doxy_Globals::outputList);
             }
          }
@@ -8405,6 +8488,7 @@ void Doxy_Work::generateClassList(ClassSDict &classSDict)
 
          if ( cd->isLinkableInProject() && cd->templateMaster() == 0) {
             msg("Generating docs for compound %s\n", csPrintable(cd->name()));
+            ProfileScope profile("output", cd->name());
 
             cd->writeDocumentation(Doxy_Globals::outputList);
             cd->writeMemberList(Doxy_Globals::outputList);
@@ -9045,6 +9129,7 @@ void Doxy_Work::generatePageDocs()
 
       if (! pd->getGroupDef() && ! pd->isReference()) {
          msg("Generating docs for page %s\n", csPrintable(pd->name()));
+         ProfileScope profile("output", pd->name());
 
          Doxy_Globals::insideMainPage = true;
          pd->writeDocumentation(Doxy_Globals::outputList);
@@ -9103,6 +9188,7 @@ void Doxy_Work::generateExampleDocs()
 
    for (auto &pd : Doxy_Globals::exampleSDict) {
       msg("Generating docs for example %s\n", csPrintable(pd->name()) );
+      ProfileScope profile("output", pd->name());
       resetCCodeParserState();
 
       QString n = pd->getOutputFileBase();
@@ -9129,6 +9215,7 @@ void Doxy_Work::generateGroupDocs()
    for (auto gd : Doxy_Globals::groupSDict) {
       if (! gd->isReference()) {
          msg("Generating docs for group %s\n", csPrintable(gd->name()) );
+         ProfileScope profile("output", gd->name());
          gd->writeDocumentation(Doxy_Globals::outputList);
       }
    }
@@ -9157,6 +9244,7 @@ void Doxy_Work::generateNamespaceDocs()
 
       if (nd->isLinkableInProject()) {
          msg("Generating docs for namespace %s\n", csPrintable(nd->name()));
+         ProfileScope profile("output", nd->name());
          nd->writeDocumentation(Doxy_Globals::outputList);
       }
 
@@ -9168,6 +9256,7 @@ void Doxy_Work::generateNamespaceDocs()
               // template instances and nested classes
 
             msg("Generating docs for namespace compounds %s\n", csPrintable(cd->name()));
+            ProfileScope profile("output", cd->name());
 
             cd->writeDocumentation(Doxy_Globals::outputList);
             cd->writeMemberList(Doxy_Globals::outputList);
@@ -9347,6 +9436,8 @@ void Doxy_Work::parseFile(ParserInterface *parser, QSharedPointer<Entry> root, Q
       extension = ".no_extension";
    }
 
+   ProfileScope profile("parse", fileName);
+
    QFileInfo fi(fileName);
    QString fileContents;
 
@@ -9397,13 +9488,28 @@ void Doxy_Work::parseFiles(QSharedPointer<Entry> root, QSharedPointer<EntryNav>
    static const bool clangParsing = Config::getBool("clang-parsing");
 
    if (clangParsing) {
+      const bool clangDatabase = ClangParser::instance()->hasCompilationDatabase();
+
       QSet<QString> processedFiles;
       QSet<QString> filesToProcess;
 
+      QStringList clangFiles;
+
       for (auto fName : Doxy_Globals::g_inputFiles) {
          filesToProcess.insert(fName);
+
+         bool ambig;
+         QSharedPointer<FileDef> fd = findFileDef(&Doxy_Globals::inputNameDict, fName, ambig);
+
+         if (fd != nullptr && fd->isSource() && ! fd->isReference() &&
+               (fd->getLanguage() == SrcLangExt_Cpp || fd->getLanguage() == SrcLangExt_ObjC)) {
+            clangFiles.append(fName);
+         }
       }
 
+      // start parsing the translation units on worker threads, the entries are added below in order
+      ClangParser::instance()->prefetch(clangFiles);
+
       // process source files and their include dependencies
       for (auto fName : Doxy_Globals::g_inputFiles) {
          bool ambig;
@@ -9423,6 +9529,12 @@ void Doxy_Work::parseFiles(QSharedPointer<Entry> root, QSharedPointer<EntryNav>
             for (auto file : includedFiles) {
 
                if (! filesToProcess.contains(file)) {
+
+                  if (clangDatabase) {
+                     // headers are only parsed through the translation units which include them
+                     continue;
+                  }
+
                   break;
                }
 
@@ -9446,6 +9558,20 @@ void Doxy_Work::parseFiles(QSharedPointer<Entry> root, QSharedPointer<EntryNav>
          }
       }
 
+      clangFiles.clear();
+
+      for (auto fName : Doxy_Globals::g_inputFiles) {
+         bool ambig;
+         QSharedPointer<FileDef> fd = findFileDef(&Doxy_Globals::inputNameDict, fName, ambig);
+
+         if (! processedFiles.contains(fName) && fd != nullptr &&
+               (fd->getLanguage() == SrcLangExt_Cpp || fd->getLanguage() == SrcLangExt_ObjC)) {
+            clangFiles.append(fName);
+         }
+      }
+
+      ClangParser::instance()->prefetch(clangFiles);
+
       // process remaining files, treat as source files even if they are header files
       for (auto fName : Doxy_Globals::g_inputFiles) {
 
@@ -9470,6 +9596,8 @@ void Doxy_Work::parseFiles(QSharedPointer<Entry> root, QSharedPointer<EntryNav>
          }
       }
 
+      ClangParser::instance()->finishPrefetch();
+
    } else  {
       // use lex and not clang
 
@@ -9653,89 +9781,86 @@ void Doxy_Work::readDir(const QFileInfo &fi, ReadDirArgs &data)
       Doxy_Globals::g_pathsVisited.insert(dirName);
    }
 
-   QDir dir(dirName);
-   dir.setFilter(QDir::Files | QDir::Dirs | QDir::Hidden);
-
-   int totalSize = 0;
    msg("Searching for files in directory %s\n", csPrintable(fi.absoluteFilePath()) );
 
-   const QFileInfoList list = dir.entryInfoList();
+   const bool excludeSymlinks = Config::getBool("exclude-symlinks");
 
-   for (auto &cfi : list) {
-      QString filePath = cfi.absoluteFilePath();
+   // read the whole tree in parallel, then add the files in directory order
+   DirScanner scanner(data.excludeSet, data.includePatterns, data.excludePatterns, data.recursive, excludeSymlinks);
+   QSharedPointer<DirScanNode> root = scanner.scan(dirName);
 
-      if (! data.excludeSet.contains(filePath)) {
-         // file should not be excluded
+   addScannedDir(*root, data);
+}
 
-         if (! cfi.exists() || ! cfi.isReadable()) {
+void Doxy_Work::addScannedDir(const DirScanNode &node, ReadDirArgs &data)
+{
+   for (const auto &entry : node.entries) {
+      const QString &filePath = entry.filePath;
 
+      switch (entry.kind) {
+
+         case DirScanEntry::Unreadable:
             if (data.errorIfNotExist) {
                warn_uncond("Source %s is not a readable file or directory\n", csPrintable(filePath));
             }
 
-         } else {
-            bool excludeSymlink = Config::getBool("exclude-symlinks");
-
-            if (excludeSymlink && cfi.isSymLink())  {
-               continue;
-            }
-
-            if (cfi.isFile()) {
-
-               bool testA = (data.includePatternList.isEmpty() || patternMatch(cfi, data.includePatternList));
-               bool testB = (! patternMatch(cfi, data.excludePatternList));
-
-               if (testA && testB && ! data.killDict.contains(filePath) ) {
+            break;
 
-                  totalSize += cfi.size() + filePath.length() + 4;
-                  QString name = cfi.fileName();
+         case DirScanEntry::File:
 
-                  if (data.isFnDict) {
-                     QSharedPointer<FileDef> fd = QMakeShared<FileDef>(cfi.path() + "/", name);
-                     QSharedPointer<FileNameList> fn;
+            if (! data.killDict.contains(filePath)) {
+               const QString &name = entry.fileName;
 
-                     if (! name.isEmpty() && (fn = data.fnDict[name])) {
-                        fn->append(fd);
+               if (data.isFnDict) {
+                  QSharedPointer<FileDef> fd = QMakeShared<FileDef>(node.path + "/", name);
+                  QSharedPointer<FileNameList> fn;
 
-                     } else {
-                        fn = QMakeShared<FileNameList>(filePath, name);
-                        fn->append(fd);
+                  if (! name.isEmpty() && (fn = data.fnDict[name])) {
+                     fn->append(fd);
 
-                        if (data.isFnList) {
-                           data.fnList.inSort(fn);
-                        }
+                  } else {
+                     fn = QMakeShared<FileNameList>(filePath, name);
+                     fn->append(fd);
 
-                        data.fnDict.insert(name, fn);
+                     if (data.isFnList) {
+                        data.fnList.inSort(fn);
                      }
-                  }
 
-                  if (data.isResultList) {
-                     data.resultList.append(filePath);
-                  }
-
-                  if (data.isPrepExclude) {
-                     data.prepExcludeSet.insert(filePath);
-                  }
-
-                  if (data.isKillDict) {
-                     data.killDict.insert(filePath);
+                     data.fnDict.insert(name, fn);
                   }
                }
 
-            } else if (cfi.isDir() && data.recursive) {
+               if (data.isResultList) {
+                  data.resultList.append(filePath);
+               }
 
-               if (cfi.fileName().at(0) == '.') {
-                  continue;
+               if (data.isPrepExclude) {
+                  data.prepExcludeSet.insert(filePath);
                }
 
-               if (patternMatch(cfi, data.excludePatternList) ) {
-                  continue;
+               if (data.isKillDict) {
+                  data.killDict.insert(filePath);
                }
+            }
 
-               QFile tmp(filePath);
-               readDir(tmp, data);
+            break;
+
+         case DirScanEntry::Dir:
+
+            if (data.isPathSet && ! data.pathSet.contains(filePath)) {
+               data.pathSet.insert(filePath);
             }
-         }
+
+            msg("Searching for files in directory %s\n", csPrintable(filePath));
+            addScannedDir(*entry.node, data);
+
+            break;
+
+         case DirScanEntry::SymLinkDir:
+            // resolves the link and checks if the target was already visited
+            readDir(QFileInfo(filePath), data);
+
+            break;
       }
    }
 }
@@ -10054,14 +10179,19 @@ void searchInputFiles()
       includePatterns = inputPatterns;
    }
 
+   // compile each pattern list once, every directory entry is tested against them
+   const FilePatternSet inputPatternSet(inputPatterns);
+   const FilePatternSet excludePatternSet(excludePatterns);
+   const FilePatternSet includePatternSet(includePatterns);
+
    for (auto fName : includePath) {
       ReadDirArgs data;
 
       data.recursive          = inputRecursive;
       data.isFnDict           = true;
       data.fnDict             = Doxy_Globals::includeNameDict;
-      data.includePatternList = includePatterns;
-      data.excludePatternList = excludePatterns;
+      data.includePatterns    = includePatternSet;
+      data.excludePatterns    = excludePatternSet;
 
       readFileOrDirectory(fName, data);
 
@@ -10076,13 +10206,15 @@ void searchInputFiles()
    const QStringList examplePatterns = Config::getList("example-patterns");
    const bool exampleRecursive       = Config::getBool("example-recursive");
 
+   const FilePatternSet examplePatternSet(examplePatterns);
+
    for (auto s : examplePath) {
       ReadDirArgs data;
 
       data.recursive          = exampleRecursive;
       data.isFnDict           = true;
       data.fnDict             = Doxy_Globals::exampleNameDict;
-      data.includePatternList = examplePatterns;
+      data.includePatterns    = examplePatternSet;
 
       readFileOrDirectory(s, data);
 
@@ -10171,7 +10303,7 @@ void searchInputFiles()
 
       data.recursive          = inputRecursive;
       data.errorIfNotExist    = false;
-      data.includePatternList = inputPatterns;
+      data.includePatterns    = inputPatternSet;
       data.isPrepExclude      = true;
       data.prepExcludeSet     = excludeSet;
 
@@ -10205,8 +10337,8 @@ void searchInputFiles()
          data.fnList             = Doxy_Globals::inputNameList;
          data.isFnDict           = true;
          data.fnDict             = Doxy_Globals::inputNameDict;
-         data.includePatternList = inputPatterns;
-         data.excludePatternList = excludePatterns;
+         data.includePatterns    = inputPatternSet;
+         data.excludePatterns    = excludePatternSet;
          data.excludeSet         = excludeSet;
          data.isResultList       = true;
          data.resultList         = Doxy_Globals::g_inputFiles;
@@ -27,6 +27,7 @@
 #include <types.h>
 
 #include <arguments.h>
+#include <memorystats.h>
 #include <section.h>
 
 class EntryNav;
@@ -73,7 +74,7 @@ struct TagInfo {
  *
  *  parseMain() will generate a tree of these entries.
  */
-class Entry
+class Entry : private MemoryCounted<MemoryStats::EntryKind>
 {
  public:
 
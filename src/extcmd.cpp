@@ -0,0 +1,204 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#include <QMutexLocker>
+
+#include <extcmd.h>
+
+#include <config.h>
+#include <message.h>
+#include <portable.h>
+#include <profiler.h>
+
+ExtCmdManager *ExtCmdManager::instance()
+{
+   // initialization of a local static is thread safe
+   static ExtCmdManager retval;
+   return &retval;
+}
+
+// with one thread the commands run when they are submitted
+ExtCmdManager::ExtCmdManager()
+   : m_numThreads(WorkerPool::threadCount("external-num-threads")),
+     m_pool(m_numThreads == 1 ? 0 : m_numThreads), m_pending(0)
+{
+   const QStringList limitList = Config::getList("external-tool-limits");
+
+   for (auto item : limitList) {
+      int i = item.indexOf('=');
+
+      if (i == -1) {
+         err("Invalid value '%s' for External Tool Limits, use \"tool=number\"\n", csPrintable(item));
+         continue;
+      }
+
+      bool ok;
+      int limit = item.mid(i + 1).trimmed().toInt(&ok);
+
+      if (! ok || limit < 1) {
+         err("Invalid limit '%s' for External Tool Limits, use \"tool=number\"\n", csPrintable(item));
+         continue;
+      }
+
+      m_pool.setGroupLimit(item.left(i).trimmed(), limit);
+   }
+}
+
+ExtCmdManager::~ExtCmdManager()
+{
+   shutDown();
+}
+
+QSharedPointer<ExtCmdJob> ExtCmdManager::submit(const QString &tool, const QString &command, const QString &args,
+                  bool commandHasConsole, const QString &workingDir)
+{
+   QSharedPointer<ExtCmdJob> job = QMakeShared<ExtCmdJob>(tool, command, args, commandHasConsole, workingDir);
+
+   {
+      QMutexLocker locker(&m_mutex);
+      m_pending++;
+   }
+
+   if (m_pool.isSerial()) {
+      // single threaded mode, run now
+      execute(job, true);
+
+   } else {
+      m_pool.start([this, job] () {
+         execute(job, false);
+      }, tool);
+   }
+
+   return job;
+}
+
+void ExtCmdManager::execute(QSharedPointer<ExtCmdJob> job, bool isSerial)
+{
+   Debug::print(Debug::ExtCmd, 0, "Executing %s %s\n", csPrintable(job->m_command), csPrintable(job->m_args));
+
+   Profiler &profiler = Profiler::instance();
+   qint64 startTime   = profiler.now();
+
+   QElapsedTimer timer;
+   timer.start();
+
+   int exitCode = portable_system(job->m_command, job->m_args, job->m_commandHasConsole, job->m_workingDir);
+   double elapsed = timer.elapsed() / 1000.0;
+
+   qint64 duration = profiler.now() - startTime;
+   profiler.addEvent(job->m_tool, "tool", startTime, duration, Profiler::scopeDepth());
+
+   if (isSerial) {
+      // the caller was blocked while the command was running
+      profiler.addWaitTime(duration);
+   }
+
+   QMutexLocker locker(&m_mutex);
+
+   job->m_exitCode = exitCode;
+   job->m_elapsed  = elapsed;
+   job->m_finished = true;
+
+   ToolStat &stat = m_toolStats[job->m_tool];
+   stat.count++;
+   stat.elapsed += elapsed;
+
+   if (elapsed > stat.maxElapsed) {
+      stat.maxElapsed = elapsed;
+   }
+
+   if (exitCode != 0) {
+      stat.failed++;
+   }
+
+   m_pending--;
+
+   m_jobFinished.wakeAll();
+}
+
+int ExtCmdManager::wait(QSharedPointer<ExtCmdJob> job)
+{
+   QMutexLocker locker(&m_mutex);
+
+   if (! job->m_finished) {
+      QElapsedTimer timer;
+      timer.start();
+
+      while (! job->m_finished) {
+         m_jobFinished.wait(&m_mutex);
+      }
+
+      Profiler::instance().addWaitTime(timer.nsecsElapsed() / 1000);
+   }
+
+   return job->m_exitCode;
+}
+
+void ExtCmdManager::waitAll()
+{
+   QMutexLocker locker(&m_mutex);
+
+   if (m_pending > 0) {
+      QElapsedTimer timer;
+      timer.start();
+
+      while (m_pending > 0) {
+         m_jobFinished.wait(&m_mutex);
+      }
+
+      Profiler::instance().addWaitTime(timer.nsecsElapsed() / 1000);
+   }
+}
+
+int ExtCmdManager::run(const QString &tool, const QString &command, const QString &args,
+                  bool commandHasConsole, const QString &workingDir)
+{
+   return wait(submit(tool, command, args, commandHasConsole, workingDir));
+}
+
+double ExtCmdManager::toolTime(const QString &tool) const
+{
+   QMutexLocker locker(&m_mutex);
+   return m_toolStats.value(tool).elapsed;
+}
+
+void ExtCmdManager::printStatistics() const
+{
+   QMutexLocker locker(&m_mutex);
+
+   if (m_toolStats.isEmpty()) {
+      return;
+   }
+
+   msg("\n");
+   msg("External tools (%d threads)\n", m_numThreads);
+   msg("----------------------\n");
+
+   QStringList tools = m_toolStats.keys();
+   tools.sort();
+
+   for (const auto &tool : tools) {
+      const ToolStat &stat = m_toolStats[tool];
+
+      msg("%.3f seconds %-12s %d runs, %d failed, slowest %.3f seconds\n", stat.elapsed, csPrintable(tool),
+                  stat.count, stat.failed, stat.maxElapsed);
+   }
+}
+
+void ExtCmdManager::shutDown()
+{
+   m_pool.stop();
+}
@@ -0,0 +1,137 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#ifndef EXTCMD_H
+#define EXTCMD_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QWaitCondition>
+
+#include <workerpool.h>
+
+/** A single invocation of an external tool */
+class ExtCmdJob
+{
+ public:
+   ExtCmdJob(const QString &tool, const QString &command, const QString &args, bool commandHasConsole,
+                  const QString &workingDir)
+      : m_tool(tool), m_command(command), m_args(args), m_workingDir(workingDir),
+        m_commandHasConsole(commandHasConsole), m_finished(false), m_exitCode(-1), m_elapsed(0)
+   {}
+
+   const QString &tool() const {
+      return m_tool;
+   }
+
+   const QString &command() const {
+      return m_command;
+   }
+
+   const QString &args() const {
+      return m_args;
+   }
+
+   /** Exit status of the command, only valid when the job is finished */
+   int exitCode() const {
+      return m_exitCode;
+   }
+
+   /** Wall clock time in seconds spent running the command */
+   double elapsed() const {
+      return m_elapsed;
+   }
+
+ private:
+   QString m_tool;
+   QString m_command;
+   QString m_args;
+   QString m_workingDir;
+
+   bool    m_commandHasConsole;
+   bool    m_finished;
+   int     m_exitCode;
+   double  m_elapsed;
+
+   friend class ExtCmdManager;
+};
+
+/** @brief Singleton which runs all external tools
+ *
+ *  Commands are executed on a worker pool, the number of threads is set by 'external-num-threads'
+ *  and 'external-tool-limits' restricts how many instances of a given tool may run at the same
+ *  time. Call sites submit a job and wait for the result when it is required.
+ */
+class ExtCmdManager
+{
+ public:
+   /** Returns the one and only instance of this class */
+   static ExtCmdManager *instance();
+
+   /** Queues a command, the working directory of the command is \a workingDir or the current directory */
+   QSharedPointer<ExtCmdJob> submit(const QString &tool, const QString &command, const QString &args,
+                  bool commandHasConsole = true, const QString &workingDir = QString());
+
+   /** Blocks until \a job is finished and returns the exit code */
+   int wait(QSharedPointer<ExtCmdJob> job);
+
+   /** Blocks until every submitted job is finished */
+   void waitAll();
+
+   /** Submits a command and waits for the result */
+   int run(const QString &tool, const QString &command, const QString &args,
+                  bool commandHasConsole = true, const QString &workingDir = QString());
+
+   /** Total wall clock time spent running commands of \a tool */
+   double toolTime(const QString &tool) const;
+
+   /** Prints a summary of the commands executed per tool */
+   void printStatistics() const;
+
+   /** Waits for the queued commands and stops the worker threads, later commands run in submit() */
+   void shutDown();
+
+ private:
+   struct ToolStat {
+      ToolStat() : count(0), failed(0), elapsed(0), maxElapsed(0)
+      {}
+
+      int    count;
+      int    failed;
+      double elapsed;
+      double maxElapsed;
+   };
+
+   ExtCmdManager();
+   ~ExtCmdManager();
+
+   void execute(QSharedPointer<ExtCmdJob> job, bool isSerial);
+
+   int m_numThreads;
+   WorkerPool m_pool;
+
+   QHash<QString, ToolStat>  m_toolStats;
+
+   mutable QMutex  m_mutex;
+   QWaitCondition  m_jobFinished;
+
+   int  m_pending;
+};
+
+#endif
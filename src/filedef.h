@@ -25,6 +25,7 @@
 #include <definition.h>
 #include <filenamelist.h>
 #include <index.h>
+#include <memorystats.h>
 #include <sortedlist.h>
 #include <stringmap.h>
 
@@ -63,7 +64,7 @@ struct IncludeInfo {
  *  The member writeDocumentation() can be used to generate the page of
  *  documentation to HTML and LaTeX.
  */
-class FileDef : public Definition
+class FileDef : public Definition, private MemoryCounted<MemoryStats::FileDefKind>
 {
    friend class FileNameList;
 
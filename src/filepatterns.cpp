@@ -0,0 +1,281 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#include <filepatterns.h>
+
+FilePatternSet::FilePatternSet()
+   : m_cs(defaultCaseSensitivity()), m_hasWildcards(false)
+{
+}
+
+FilePatternSet::FilePatternSet(const QStringList &patList)
+   : m_cs(defaultCaseSensitivity()), m_hasWildcards(false)
+{
+   build(patList);
+}
+
+FilePatternSet::FilePatternSet(const QStringList &patList, Qt::CaseSensitivity cs)
+   : m_cs(cs), m_hasWildcards(false)
+{
+   build(patList);
+}
+
+Qt::CaseSensitivity FilePatternSet::defaultCaseSensitivity()
+{
+#if defined(_WIN32) || defined(__MACOSX__)
+   // Windows or MacOSX
+   return Qt::CaseInsensitive;
+#else
+   // unix
+   return Qt::CaseSensitive;
+#endif
+}
+
+bool FilePatternSet::isWildcardChar(QChar c)
+{
+   return c == '*' || c == '?' || c == '[';
+}
+
+// same translation QRegExp uses for QRegExp::Wildcard, the result can be combined with other patterns
+QString FilePatternSet::wildcardToRegExp(const QString &pattern)
+{
+   const int len = pattern.length();
+   QString retval;
+
+   int i = 0;
+
+   while (i < len) {
+      QChar c = pattern[i++];
+
+      switch (c.unicode()) {
+         case '\\':
+            retval += "\\\\";
+            break;
+
+         case '*':
+            retval += ".*";
+            break;
+
+         case '?':
+            retval += '.';
+            break;
+
+         case '$':
+         case '(':
+         case ')':
+         case '+':
+         case '.':
+         case '^':
+         case '{':
+         case '|':
+         case '}':
+            retval += '\\';
+            retval += c;
+            break;
+
+         case '[':
+            retval += c;
+
+            if (i < len && pattern[i] == '^') {
+               retval += pattern[i++];
+            }
+
+            if (i < len) {
+               if (pattern[i] == ']') {
+                  retval += pattern[i++];
+               }
+
+               while (i < len && pattern[i] != ']') {
+                  if (pattern[i] == '\\') {
+                     retval += '\\';
+                  }
+
+                  retval += pattern[i++];
+               }
+            }
+
+            break;
+
+         default:
+            retval += c;
+      }
+   }
+
+   return retval;
+}
+
+QString FilePatternSet::fold(const QString &str) const
+{
+   if (m_cs == Qt::CaseInsensitive) {
+      return str.toLower();
+   }
+
+   return str;
+}
+
+void FilePatternSet::build(const QStringList &patList)
+{
+   QStringList regExpList;
+
+   for (const auto &item : patList) {
+
+      if (item.isEmpty()) {
+         continue;
+      }
+
+      Pattern pattern;
+
+      int i = item.indexOf('=');
+
+      if (i == -1) {
+         pattern.text = item;
+
+      } else {
+         pattern.text  = item.left(i);     // strip off the filter
+         pattern.value = item.mid(i + 1);
+      }
+
+      const QString &text = pattern.text;
+      const int len = text.length();
+
+      int wildPos = -1;
+      int wildCount = 0;
+
+      for (int k = 0; k < len; k++) {
+         if (isWildcardChar(text[k])) {
+            wildPos = k;
+            wildCount++;
+         }
+      }
+
+      if (wildCount == 0) {
+         pattern.kind = Literal;
+
+         if (! text.isEmpty()) {
+            m_literals.insert(fold(text));
+         }
+
+      } else if (wildCount == 1 && wildPos == len - 1 && text[wildPos] == '*') {
+         // name*
+         pattern.kind = Prefix;
+
+         QString prefix = fold(text.left(len - 1));
+         m_prefixes[prefix.length()].insert(prefix);
+
+      } else if (wildCount == 1 && wildPos == 0 && text[wildPos] == '*') {
+         // *.ext
+         pattern.kind = Suffix;
+
+         QString suffix = fold(text.mid(1));
+         m_suffixes[suffix.length()].insert(suffix);
+
+      } else {
+         pattern.kind   = Wildcard;
+         pattern.regExp = QRegExp(text, m_cs, QRegExp::Wildcard);
+
+         // an invalid pattern never matches, leave it out so the combined expression stays valid
+         if (pattern.regExp.isValid()) {
+            regExpList.append("(?:" + wildcardToRegExp(text) + ")");
+         }
+      }
+
+      m_patterns.append(pattern);
+   }
+
+   if (! regExpList.isEmpty()) {
+      m_wildcards    = QRegExp(regExpList.join("|"), m_cs, QRegExp::RegExp);
+      m_hasWildcards = m_wildcards.isValid();
+   }
+}
+
+bool FilePatternSet::exactMatch(const QString &str) const
+{
+   if (m_patterns.isEmpty()) {
+      return false;
+   }
+
+   const QString name = fold(str);
+   const int len = name.length();
+
+   if (m_literals.contains(name)) {
+      return true;
+   }
+
+   for (auto iter = m_prefixes.constBegin(); iter != m_prefixes.constEnd() && iter.key() <= len; ++iter) {
+      if (iter.value().contains(name.left(iter.key()))) {
+         return true;
+      }
+   }
+
+   for (auto iter = m_suffixes.constBegin(); iter != m_suffixes.constEnd() && iter.key() <= len; ++iter) {
+      if (iter.value().contains(name.right(iter.key()))) {
+         return true;
+      }
+   }
+
+   if (m_hasWildcards) {
+      // QRegExp keeps the match state in the object, use a copy so the set can be shared
+      QRegExp re = m_wildcards;
+      return re.exactMatch(str);
+   }
+
+   return false;
+}
+
+bool FilePatternSet::match(const QFileInfo &fi) const
+{
+   if (m_patterns.isEmpty()) {
+      return false;
+   }
+
+   const QString fp  = fi.filePath();
+   const QString afp = fi.absoluteFilePath();
+
+   return exactMatch(fi.fileName()) || exactMatch(fp) || (afp != fp && exactMatch(afp));
+}
+
+int FilePatternSet::indexIn(const QString &str) const
+{
+   for (int i = 0; i < m_patterns.count(); i++) {
+      const Pattern &pattern = m_patterns.at(i);
+
+      bool found;
+
+      if (pattern.kind == Wildcard) {
+         QRegExp re = pattern.regExp;
+         found = (re.indexIn(str) != -1);
+
+      } else {
+         // a leading or trailing '*' does not change where a literal is found
+         QString text = pattern.text;
+
+         if (pattern.kind == Prefix) {
+            text.chop(1);
+
+         } else if (pattern.kind == Suffix) {
+            text = text.mid(1);
+         }
+
+         found = str.contains(text, m_cs);
+      }
+
+      if (found) {
+         return i;
+      }
+   }
+
+   return -1;
+}
@@ -0,0 +1,95 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#ifndef FILEPATTERNS_H
+#define FILEPATTERNS_H
+
+#include <QFileInfo>
+#include <QMap>
+#include <QRegExp>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/** @brief Compiled form of a list of wildcard file patterns
+ *
+ *  Patterns are split once when the set is built. Literal names are kept in a hash, patterns
+ *  of the form "*.ext" and "name*" are kept in suffix and prefix tables grouped by length, and
+ *  the remaining patterns are joined into a single regular expression. A trailing "=filter"
+ *  is stripped from each pattern. The set is read only after construction and can be shared
+ *  between threads.
+ */
+class FilePatternSet
+{
+ public:
+   FilePatternSet();
+   explicit FilePatternSet(const QStringList &patList);
+   FilePatternSet(const QStringList &patList, Qt::CaseSensitivity cs);
+
+   bool isEmpty() const {
+      return m_patterns.isEmpty();
+   }
+
+   /** Returns true if the name, path or absolute path of \a fi matches one of the patterns */
+   bool match(const QFileInfo &fi) const;
+
+   /** Returns true if all of \a str matches one of the patterns */
+   bool exactMatch(const QString &str) const;
+
+   /** Returns the index of the first pattern found anywhere in \a str, or -1 */
+   int indexIn(const QString &str) const;
+
+   /** Returns the text after the '=' of pattern \a index */
+   QString value(int index) const {
+      return m_patterns.at(index).value;
+   }
+
+   /** Returns the platform default used by the input and exclude patterns */
+   static Qt::CaseSensitivity defaultCaseSensitivity();
+
+ private:
+   enum PatternKind {
+      Literal,
+      Prefix,
+      Suffix,
+      Wildcard
+   };
+
+   struct Pattern {
+      PatternKind kind;
+      QString     text;
+      QString     value;
+      QRegExp     regExp;
+   };
+
+   void build(const QStringList &patList);
+   QString fold(const QString &str) const;
+
+   static bool isWildcardChar(QChar c);
+   static QString wildcardToRegExp(const QString &pattern);
+
+   Qt::CaseSensitivity m_cs;
+   QVector<Pattern>    m_patterns;
+
+   QSet<QString>             m_literals;
+   QMap<int, QSet<QString>>  m_prefixes;     // keyed by length
+   QMap<int, QSet<QString>>  m_suffixes;     // keyed by length
+   QRegExp                   m_wildcards;
+   bool                      m_hasWildcards;
+};
+
+#endif
@@ -0,0 +1,302 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QMutexLocker>
+#include <QPair>
+
+#include <stdio.h>
+
+#include <filtercache.h>
+
+#include <message.h>
+#include <util.h>
+
+// size of the chunks read from the filter pipe
+static const int filterBufSize = 65536;
+
+// maximum size of the cached filter output in KB
+static const int maxCacheSize = 256 * 1024;
+
+// maximum size of the prefetched output the parser has not read yet in KB, keeps the
+// prefetched files from being removed from the cache before they are used
+static const int maxPrefetchSize = maxCacheSize / 2;
+
+FilterCache &FilterCache::instance()
+{
+   static FilterCache filterCache;
+   return filterCache;
+}
+
+FilterCache::FilterCache()
+   : m_pool(WorkerPool::threadCount("external-num-threads")), m_prefetchedSize(0), m_stopping(false),
+     m_results(maxCacheSize)
+{
+}
+
+FilterCache::~FilterCache()
+{
+   finishPrefetch();
+}
+
+QString FilterCache::jobKey(const QString &fileName, const QString &filterName)
+{
+   return filterName + '\n' + fileName;
+}
+
+QString FilterCache::contentKey(const QString &fileName, const QString &filterName)
+{
+   QFileInfo fi(fileName);
+
+   if (! fi.exists()) {
+      return QString();
+   }
+
+   QDateTime lastModified = fi.lastModified();
+   qint64 size = fi.size();
+
+   {
+      QMutexLocker locker(&m_mutex);
+      auto iter = m_fileHashes.constFind(fileName);
+
+      if (iter != m_fileHashes.constEnd() && iter->lastModified == lastModified && iter->size == size) {
+         return filterName + '\n' + iter->hash;
+      }
+   }
+
+   QFile f(fileName);
+
+   if (! f.open(QIODevice::ReadOnly)) {
+      return QString();
+   }
+
+   QCryptographicHash hash(QCryptographicHash::Md5);
+
+   while (! f.atEnd()) {
+      hash.addData(f.read(filterBufSize));
+   }
+
+   QString hashText = QString::fromLatin1(hash.result().toHex());
+
+   {
+      QMutexLocker locker(&m_mutex);
+      m_fileHashes.insert(fileName, FileHash{lastModified, size, hashText});
+   }
+
+   return filterName + '\n' + hashText;
+}
+
+void FilterCache::storeResult(const QString &cKey, const QByteArray &output)
+{
+   // called with m_mutex locked, the cost is the size in KB
+   m_results.insert(cKey, new QByteArray(output), output.size() / 1024 + 1);
+}
+
+bool FilterCache::runFilter(const QString &fileName, const QString &filterName, QByteArray &output)
+{
+   QString cmd = filterName + " \"" + fileName + "\"";
+   Debug::print(Debug::ExtCmd, 0, "Executing popen(`%s`)\n", csPrintable(cmd));
+
+   FILE *f = popen(cmd.toUtf8().constData(), "r");
+
+   if (! f) {
+      err("Unable to execute filter %s\n", csPrintable(filterName));
+      return false;
+   }
+
+   output.clear();
+   size_t numRead;
+
+   do {
+      int oldSize = output.size();
+      output.resize(oldSize + filterBufSize);
+
+      numRead = fread(output.data() + oldSize, 1, filterBufSize, f);
+      output.resize(oldSize + numRead);
+
+   } while (numRead > 0);
+
+   pclose(f);
+
+   return true;
+}
+
+void FilterCache::prefetch(const QStringList &fileList, bool isSourceCode)
+{
+   QList<QPair<QString, QString>> jobList;
+
+   {
+      QMutexLocker locker(&m_mutex);
+
+      for (const auto &fileName : fileList) {
+         QString filterName = getFileFilter(fileName, isSourceCode);
+
+         if (filterName.isEmpty()) {
+            continue;
+         }
+
+         QString key = jobKey(fileName, filterName);
+
+         if (! m_queued.contains(key)) {
+            m_queued.insert(key);
+            jobList.append(qMakePair(fileName, filterName));
+         }
+      }
+   }
+
+   for (const auto &item : jobList) {
+      const QString fileName   = item.first;
+      const QString filterName = item.second;
+
+      m_pool.start([this, fileName, filterName] () {
+         if (claimJob(jobKey(fileName, filterName))) {
+            processJob(fileName, filterName);
+         }
+      } );
+   }
+}
+
+void FilterCache::finishPrefetch()
+{
+   {
+      // the files which were not started are no longer needed
+      QMutexLocker locker(&m_mutex);
+
+      m_stopping = true;
+      m_spaceAvailable.wakeAll();
+   }
+
+   m_pool.waitForDone();
+
+   QMutexLocker locker(&m_mutex);
+
+   m_queued.clear();
+   m_prefetched.clear();
+
+   m_prefetchedSize = 0;
+   m_stopping       = false;
+}
+
+// returns false when the parser claimed the file before a worker started it, waits while
+// the prefetched output which was not read yet exceeds maxPrefetchSize
+bool FilterCache::claimJob(const QString &key)
+{
+   QMutexLocker locker(&m_mutex);
+
+   while (m_prefetchedSize >= maxPrefetchSize && ! m_stopping && m_queued.contains(key)) {
+      m_spaceAvailable.wait(&m_mutex);
+   }
+
+   if (! m_stopping && m_queued.remove(key)) {
+      m_running.insert(key);
+      return true;
+   }
+
+   return false;
+}
+
+void FilterCache::processJob(const QString &fileName, const QString &filterName)
+{
+   QString cKey = contentKey(fileName, filterName);
+   QByteArray output;
+
+   bool found;
+
+   {
+      QMutexLocker locker(&m_mutex);
+      found = m_results.contains(cKey);
+   }
+
+   bool ok = found || cKey.isEmpty() || runFilter(fileName, filterName, output);
+
+   QMutexLocker locker(&m_mutex);
+
+   const QString key = jobKey(fileName, filterName);
+
+   if (ok && ! found && ! cKey.isEmpty()) {
+      storeResult(cKey, output);
+
+      const int size = output.size() / 1024 + 1;
+
+      m_prefetched.insert(key, size);
+      m_prefetchedSize += size;
+   }
+
+   m_running.remove(key);
+   m_jobFinished.wakeAll();
+}
+
+bool FilterCache::getFilteredContents(const QString &fileName, const QString &filterName, QByteArray &output)
+{
+   QString key = jobKey(fileName, filterName);
+
+   {
+      QMutexLocker locker(&m_mutex);
+
+      // claim the job when no worker started it yet
+      m_queued.remove(key);
+
+      while (m_running.contains(key)) {
+         m_jobFinished.wait(&m_mutex);
+      }
+
+      // the parser caught up with this file, the workers may run further ahead
+      auto iter = m_prefetched.find(key);
+
+      if (iter != m_prefetched.end()) {
+         m_prefetchedSize -= iter.value();
+         m_prefetched.erase(iter);
+      }
+
+      m_spaceAvailable.wakeAll();
+   }
+
+   QString cKey = contentKey(fileName, filterName);
+
+   if (! cKey.isEmpty()) {
+      QMutexLocker locker(&m_mutex);
+      QByteArray *result = m_results.object(cKey);
+
+      if (result != nullptr) {
+         output = *result;
+         return true;
+      }
+   }
+
+   if (! runFilter(fileName, filterName, output)) {
+      return false;
+   }
+
+   if (! cKey.isEmpty()) {
+      QMutexLocker locker(&m_mutex);
+      storeResult(cKey, output);
+   }
+
+   return true;
+}
+
+void FilterCache::clear()
+{
+   finishPrefetch();
+
+   QMutexLocker locker(&m_mutex);
+
+   m_results.clear();
+   m_fileHashes.clear();
+}
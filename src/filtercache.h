@@ -0,0 +1,99 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#ifndef FILTERCACHE_H
+#define FILTERCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QWaitCondition>
+
+#include <workerpool.h>
+
+/** @brief Singleton which caches the output of input filters
+ *
+ *  The output of 'filter-program' or 'filter-patterns' is stored by the filter command and
+ *  a hash of the input file. The parser and the source browser both read through this cache
+ *  so each file is filtered once. prefetch() filters the input files on a worker pool
+ *  while the parser is busy with earlier files.
+ *
+ *  The filter output is limited to maxCacheSize, the least recently used entries are
+ *  removed first and filtered again if required. Output which was prefetched and not yet
+ *  read is limited to half of that, the workers wait for the parser beyond it. The hash of
+ *  each input file is kept until its modification time or size changes.
+ */
+class FilterCache
+{
+ public:
+   /** Returns the one and only instance of this class */
+   static FilterCache &instance();
+
+   /** Starts filtering every file in \a fileList which has a filter */
+   void prefetch(const QStringList &fileList, bool isSourceCode);
+
+   /** Waits until the prefetched files are filtered */
+   void finishPrefetch();
+
+   /** Returns the output of \a filterName applied to \a fileName, runs the filter if required */
+   bool getFilteredContents(const QString &fileName, const QString &filterName, QByteArray &output);
+
+   /** Releases the cached filter output, called once the source browser is done */
+   void clear();
+
+ private:
+   struct FileHash {
+      QDateTime lastModified;
+      qint64    size;
+      QString   hash;
+   };
+
+   FilterCache();
+   ~FilterCache();
+
+   static QString jobKey(const QString &fileName, const QString &filterName);
+   QString contentKey(const QString &fileName, const QString &filterName);
+   void storeResult(const QString &cKey, const QByteArray &output);
+
+   static bool runFilter(const QString &fileName, const QString &filterName, QByteArray &output);
+
+   bool claimJob(const QString &key);
+   void processJob(const QString &fileName, const QString &filterName);
+
+   WorkerPool                  m_pool;
+
+   QSet<QString>               m_queued;
+   QSet<QString>               m_running;
+
+   // size in KB of the prefetched output by job key, removed when the parser reads it
+   QHash<QString, int>         m_prefetched;
+   int                         m_prefetchedSize;
+   bool                        m_stopping;
+
+   QCache<QString, QByteArray> m_results;
+   QHash<QString, FileHash>    m_fileHashes;
+
+   QMutex         m_mutex;
+   QWaitCondition m_jobFinished;
+   QWaitCondition m_spaceAvailable;
+};
+
+#endif
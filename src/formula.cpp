@@ -26,6 +26,7 @@
 
 #include <config.h>
 #include <doxy_globals.h>
+#include <extcmd.h>
 #include <image.h>
 #include <index.h>
 #include <message.h>
@@ -116,40 +117,43 @@ void FormulaList::generateBitmaps(const QString &path)
       if (latexCmd.isEmpty()) {
          latexCmd = "latex";
       }
-      portable_sysTimerStart();
 
-      if (portable_system(latexCmd, "_formulas.tex") != 0) {
+      ExtCmdManager *extCmd = ExtCmdManager::instance();
+      QString workingDir    = d.absolutePath();
+
+      if (extCmd->run("latex", latexCmd, "_formulas.tex", true, workingDir) != 0) {
          err("Unable to run LaTeX, verify your installation, _formulas.tex, and _formulas.log\n");
          formulaError = true;
       }
 
-      portable_sysTimerStop();
-
+      // run dvips to convert each page to an encapsulated postscript, the pages are independent
+      QList<QSharedPointer<ExtCmdJob>> dviJobs;
       int pageIndex = 1;
 
       for (auto pageNum : pagesToGenerate) {
-         msg("Generating image form_%d.png for formula\n", pageNum);
+         QString formBase = QString("_form%1").arg(pageNum);
 
-         QString formBase;
-         formBase = QString("_form%1").arg(pageNum);
+         QString dviArgs = QString("-q -D 600 -E -n 1 -p %1 -o %2.eps _formulas.dvi").arg(pageIndex).arg(formBase);
+         dviJobs.append(extCmd->submit("dvips", "dvips", dviArgs, true, workingDir));
 
-         // run dvips to convert the page with number pageIndex to an encapsulated postscript
+         ++pageIndex;
+      }
 
-         char dviArgs[4096];
-         sprintf(dviArgs, "-q -D 600 -E -n 1 -p %d -o %s.eps _formulas.dvi",pageIndex, qPrintable(formBase));
+      QString gsExe = Config::getString("ghostscript");
+      QList<QSharedPointer<ExtCmdJob>> gsJobs;
 
-         portable_sysTimerStart();
+      for (int index = 0; index < pagesToGenerate.count(); ++index) {
+         QString formBase = QString("_form%1").arg(pagesToGenerate.at(index));
 
-         if (portable_system("dvips", dviArgs) != 0) {
+         if (extCmd->wait(dviJobs.at(index)) != 0) {
             err("Unable to run dvips, check your installation\n");
-            portable_sysTimerStop();
+            extCmd->waitAll();
 
             // reset the directory to the original location
             QDir::setCurrent(oldDir);
 
             return;
          }
-         portable_sysTimerStop();
 
          // now we read the generated postscript file to extract the bounding box
          QFileInfo fi(formBase + ".eps");
@@ -203,18 +207,23 @@ void FormulaList::generateBitmaps(const QString &path)
          // run ghostscript to convert the postscript to a pixmap
          // The pixmap is a truecolor image, where only black and white are used
 
-         char gsArgs[4096];
-         sprintf(gsArgs, "-q -g%dx%d -r%dx%dx -sDEVICE=ppmraw "
-                 "-sOutputFile=%s.pnm -dNOPAUSE -dBATCH -- %s.ps",
-                 gx, gy, (int)(scaleFactor * 72), (int)(scaleFactor * 72), qPrintable(formBase), qPrintable(formBase) );
+         QString gsArgs = QString("-q -g%1x%2 -r%3x%4x -sDEVICE=ppmraw -sOutputFile=%5.pnm -dNOPAUSE -dBATCH -- %6.ps")
+                  .arg(gx).arg(gy).arg((int)(scaleFactor * 72)).arg((int)(scaleFactor * 72)).arg(formBase).arg(formBase);
 
-         portable_sysTimerStart();
+         gsJobs.append(extCmd->submit("ghostscript", gsExe, gsArgs, true, workingDir));
+      }
 
-         QString gsExe = Config::getString("ghostscript");
+      for (int index = 0; index < pagesToGenerate.count(); ++index) {
+         int pageNum = pagesToGenerate.at(index);
+         QString formBase = QString("_form%1").arg(pageNum);
 
-         if (portable_system(gsExe, gsArgs) != 0) {
-            err("Unable to run GhostScript %s %s. Verify your installation\n", qPrintable(gsExe), gsArgs);
-            portable_sysTimerStop();
+         msg("Generating image form_%d.png for formula\n", pageNum);
+
+         QSharedPointer<ExtCmdJob> gsJob = gsJobs.at(index);
+
+         if (extCmd->wait(gsJob) != 0) {
+            err("Unable to run GhostScript %s %s. Verify your installation\n", csPrintable(gsExe), csPrintable(gsJob->args()));
+            extCmd->waitAll();
 
             // reset the directory to the original location
             QDir::setCurrent(oldDir);
@@ -222,7 +231,6 @@ void FormulaList::generateBitmaps(const QString &path)
             return;
          }
 
-         portable_sysTimerStop();
          f.setFileName(formBase + ".pnm");
 
          uint imageX = 0, imageY = 0;
@@ -346,8 +354,6 @@ void FormulaList::generateBitmaps(const QString &path)
          thisDir.remove(formBase + ".eps");
          thisDir.remove(formBase + ".pnm");
          thisDir.remove(formBase + ".ps");
-
-         ++pageIndex;
       }
 
       // remove intermediate files produced by latex
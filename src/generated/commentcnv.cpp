@@ -1107,6 +1107,7 @@ char *commentcnvYYtext;
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <benchrecorder.h>
 #include <config.h>
 #include <condparser.h>
 #include <doxy_globals.h>
@@ -3848,6 +3849,10 @@ static bool recognizeFixedForm(const QString &contents)
 // main entry point
 QString convertCppComments(const QString &inBuf, const QString &fileName)
 {
+   if (BenchRecorder::isEnabled()) {
+      BenchRecorder::record("convertCppComments", {inBuf, fileName});
+   }
+
    g_mlBrief  = Config::getBool("multiline-cpp-brief");
 
    g_inBuf    = inBuf;
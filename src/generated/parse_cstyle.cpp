@@ -24786,6 +24786,7 @@ void CPPLanguageParser::parseInput(const QString &fileName, const QString &fileB
       } else {
          // an include file
          ClangParser::instance()->switchToFile(fileName);
+         ClangParser::instance()->addHeaderEntries(fileName, root);
 
       }
 
@@ -2619,6 +2619,7 @@ char *preYYtext;
 #include <doxy_globals.h>
 #include <default_args.h>
 #include <entry.h>
+#include <filepatterns.h>
 #include <message.h>
 #include <membername.h>
 #include <util.h>
@@ -3025,9 +3026,9 @@ static QSharedPointer<FileState> checkAndOpenFile(const QString &fileName, bool
    QFileInfo fi(fileName);
 
    if (fi.exists() && fi.isFile()) {
-      static const QStringList exclPatterns = Config::getList("exclude-patterns");
+      static const FilePatternSet exclPatterns(Config::getList("exclude-patterns"));
 
-      if (patternMatch(fi, exclPatterns)) {
+      if (exclPatterns.match(fi)) {
          return QSharedPointer<FileState>();
       }
 
@@ -23,6 +23,7 @@
 #include <htags.h>
 
 #include <config.h>
+#include <extcmd.h>
 #include <message.h>
 #include <portable.h>
 #include <util.h>
@@ -99,7 +100,7 @@ bool Htags::execute(const QString &htmldir)
   
    portable_sysTimerStart();
 
-   bool result = portable_system("htags", commandLine, false) == 0;
+   bool result = ExtCmdManager::instance()->run("htags", "htags", commandLine, false) == 0;
    portable_sysTimerStop();
 
    QDir::setCurrent(oldDir);
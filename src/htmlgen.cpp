@@ -22,6 +22,7 @@
 
 #include <htmlgen.h>
 
+#include <benchrecorder.h>
 #include <config.h>
 #include <docparser.h>
 #include <diagram.h>
@@ -378,6 +379,10 @@ void HtmlCodeGenerator::setRelativePath(const QString &path)
 
 void HtmlCodeGenerator::codify(const QString &str)
 {
+   if (BenchRecorder::isEnabled()) {
+      BenchRecorder::record("codify", {str});
+   }
+
    if (str.isEmpty()) {
       return;
    }
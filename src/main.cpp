@@ -22,6 +22,7 @@
 #include <doxy_setup.h>
 #include <language.h>
 #include <message.h>
+#include <searchfile.h>
 
 int main(int argc, char **argv)
 {      
@@ -36,6 +37,11 @@ int main(int argc, char **argv)
    struct CommandLine cmdArgs;
    cmdArgs = parseCommandLine(argList);
 
+   if (! cmdArgs.searchIndex.isEmpty()) {
+      // query a server side search index, no project file is read
+      return searchIndexFile(cmdArgs.searchIndex, cmdArgs.searchQuery);
+   }
+
    // read project file
    readConfiguration(cmdArgs);    
    initDoxyPress(); 
@@ -883,6 +883,11 @@ MemberDef::~MemberDef()
 {
 }
 
+int MemberDef::implSize()
+{
+   return sizeof(MemberDefImpl);
+}
+
 void MemberDef::setReimplements(QSharedPointer<MemberDef> md)
 {
    m_impl->redefines = md;
@@ -28,6 +28,7 @@
 
 #include <definition.h>
 #include <entry.h>
+#include <memorystats.h>
 #include <types.h>
 
 class ClassDef;
@@ -45,7 +46,7 @@ class MemberDefImpl;
 struct TagInfo;
 
 /** A model of a class/file/namespace member symbol. */
-class MemberDef : public Definition
+class MemberDef : public Definition, private MemoryCounted<MemoryStats::MemberDefKind>
 {
  public:
    MemberDef(const QString &defFileName, int defLine, int defColumn, const QString &type, const QString &name, 
@@ -420,6 +421,9 @@ class MemberDef : public Definition
 
    void findSectionsInDocumentation();
 
+   // size of the private data, used by MemoryStats
+   static int implSize();
+
    bool visited;
 
  protected:
@@ -0,0 +1,128 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#include <memorystats.h>
+
+#include <arguments.h>
+#include <classdef.h>
+#include <docparser.h>
+#include <doxy_globals.h>
+#include <entry.h>
+#include <filedef.h>
+#include <memberdef.h>
+#include <message.h>
+#include <namespacedef.h>
+
+bool MemoryStats::s_enabled = false;
+std::atomic<int> MemoryStats::s_live[MemoryStats::KindCount];
+
+// size of the text held by a definition
+static qint64 textSize(const Definition *def)
+{
+   qint64 retval = def->name().size() + def->localName().size() + def->documentation().size() +
+                  def->briefDescription().size() + def->inbodyDocumentation().size() + def->getDefFileName().size();
+
+   if (def->definitionType() == Definition::TypeMember) {
+      const MemberDef *md = static_cast<const MemberDef *>(def);
+      retval += md->typeString().size() + md->argsString().size() + md->definition().size() + md->initializer().size();
+   }
+
+   return retval * sizeof(QChar);
+}
+
+void MemoryStats::print(const QString &phase)
+{
+   // objects which are reachable from the dictionaries are measured, the size of the
+   // other live objects is assumed to be the same on average
+   struct Measured {
+      Measured()
+         : count(0), bytes(0)
+      {}
+
+      qint64 count;
+      qint64 bytes;
+   };
+
+   Measured measured[KindCount];
+
+   for (auto def : Doxy_Globals::glossary()) {
+
+      switch (def->definitionType()) {
+         case Definition::TypeClass:
+            measured[ClassDefKind].count++;
+            measured[ClassDefKind].bytes += sizeof(ClassDef) + textSize(def);
+            break;
+
+         case Definition::TypeMember:
+            measured[MemberDefKind].count++;
+            measured[MemberDefKind].bytes += sizeof(MemberDef) + MemberDef::implSize() + textSize(def);
+            break;
+
+         case Definition::TypeNamespace:
+            measured[NamespaceDefKind].count++;
+            measured[NamespaceDefKind].bytes += sizeof(NamespaceDef) + textSize(def);
+            break;
+
+         default:
+            break;
+      }
+   }
+
+   for (auto fnl : Doxy_Globals::inputNameList) {
+      for (auto fd : *fnl) {
+         measured[FileDefKind].count++;
+         measured[FileDefKind].bytes += sizeof(FileDef) + textSize(fd.data());
+      }
+   }
+
+   static const char *names[KindCount] = { "ClassDef", "MemberDef", "FileDef", "NamespaceDef", "Entry",
+                  "ArgumentList", "DocNode" };
+
+   static const qint64 sizes[KindCount] = { sizeof(ClassDef), sizeof(MemberDef) + MemberDef::implSize(),
+                  sizeof(FileDef), sizeof(NamespaceDef), sizeof(Entry), sizeof(ArgumentList), sizeof(DocNode) };
+
+   msg("Memory after %s\n", csPrintable(phase.trimmed()));
+
+   qint64 total = 0;
+
+   for (int kind = 0; kind < KindCount; kind++) {
+      qint64 count = live(Kind(kind));
+      qint64 bytes;
+
+      if (measured[kind].count > 0) {
+         bytes = count * measured[kind].bytes / measured[kind].count;
+      } else {
+         bytes = count * sizes[kind];
+      }
+
+      total += bytes;
+
+      msg("   %-14s %10lld objects %10.1f MB\n", names[kind], count, bytes / (1024.0 * 1024.0));
+   }
+
+   msg("   %-14s %10s         %10.1f MB\n", "total", "", total / (1024.0 * 1024.0));
+   msg("   sizes do not include the contents of ArgumentList and Entry objects\n");
+
+   msg("   dictionaries: classSDict %d, memberNameSDict %d, functionNameSDict %d, namespaceSDict %d, "
+                  "inputNameDict %d, glossary %d, clangUsrMap %d, xrefLists %d, sectionDict %d, lookupCache %d, "
+                  "classEntries %d\n",
+                  Doxy_Globals::classSDict.count(), Doxy_Globals::memberNameSDict.count(),
+                  Doxy_Globals::functionNameSDict.count(), Doxy_Globals::namespaceSDict.count(),
+                  Doxy_Globals::inputNameDict.count(), Doxy_Globals::glossary().count(),
+                  Doxy_Globals::clangUsrMap.count(), Doxy_Globals::xrefLists.count(),
+                  Doxy_Globals::sectionDict.count(), Doxy_Globals::lookupCache.count(),
+                  Doxy_Globals::g_classEntries.count());
+}
@@ -0,0 +1,101 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include <QString>
+
+#include <atomic>
+
+/** @brief Counts the live objects of the types which use most of the memory
+ *
+ *  Objects are counted by deriving from MemoryCounted. When the memory debug flag is given
+ *  the number of live objects, their approximate size and the size of the global dictionaries
+ *  are printed at the end of every phase. Without the flag the objects are not counted,
+ *  setEnabled() is called before the first counted object is created.
+ */
+class MemoryStats
+{
+ public:
+   enum Kind {
+      ClassDefKind,
+      MemberDefKind,
+      FileDefKind,
+      NamespaceDefKind,
+      EntryKind,
+      ArgumentListKind,
+      DocNodeKind,
+      KindCount
+   };
+
+   static bool isEnabled() {
+      return s_enabled;
+   }
+
+   static void setEnabled(bool enabled) {
+      s_enabled = enabled;
+   }
+
+   static void increment(Kind kind) {
+      s_live[kind].fetch_add(1, std::memory_order_relaxed);
+   }
+
+   static void decrement(Kind kind) {
+      s_live[kind].fetch_sub(1, std::memory_order_relaxed);
+   }
+
+   static int live(Kind kind) {
+      return s_live[kind].load(std::memory_order_relaxed);
+   }
+
+   /** Prints the object counts and dictionary sizes at the end of \a phase */
+   static void print(const QString &phase);
+
+ private:
+   static bool s_enabled;
+   static std::atomic<int> s_live[KindCount];
+};
+
+/** Base class which keeps the number of live objects of a type in MemoryStats */
+template <MemoryStats::Kind K>
+class MemoryCounted
+{
+ protected:
+   MemoryCounted() {
+      if (MemoryStats::isEnabled()) {
+         MemoryStats::increment(K);
+      }
+   }
+
+   MemoryCounted(const MemoryCounted &) {
+      if (MemoryStats::isEnabled()) {
+         MemoryStats::increment(K);
+      }
+   }
+
+   ~MemoryCounted() {
+      if (MemoryStats::isEnabled()) {
+         MemoryStats::decrement(K);
+      }
+   }
+
+   MemoryCounted &operator=(const MemoryCounted &) {
+      return *this;
+   }
+};
+
+#endif
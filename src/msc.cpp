@@ -21,6 +21,7 @@
 #include <config.h>
 #include <docparser.h>
 #include <doxy_globals.h>
+#include <extcmd.h>
 #include <index.h>
 #include <message.h>
 #include <msc.h>
@@ -156,7 +157,7 @@ void writeMscGraphFromFile(const QString &inFile, const QString &outDir, const Q
    int exitCode;
    
    portable_sysTimerStart();
-   if ((exitCode = portable_system(mscExe, mscArgs, false)) != 0) {
+   if ((exitCode = ExtCmdManager::instance()->run("mscgen", mscExe, mscArgs, false)) != 0) {
       portable_sysTimerStop();
      
       QDir::setCurrent(oldDir);
@@ -171,7 +172,7 @@ void writeMscGraphFromFile(const QString &inFile, const QString &outDir, const Q
       epstopdfArgs = QString("\"%1.eps\" --outfile=\"%2.pdf\"").arg(outFile).arg(outFile);
 
       portable_sysTimerStart();
-      if (portable_system("epstopdf", epstopdfArgs) != 0) {
+      if (ExtCmdManager::instance()->run("epstopdf", "epstopdf", epstopdfArgs) != 0) {
          err("Unable to run epstopdf. Verify your TeX installation\n");
       }
 
@@ -197,7 +198,7 @@ QString getMscImageMapFromFile(const QString &inFile, const QString &outDir, con
    QString mscArgs = "-T ismap -i \"" + inFile + "\" -o \"" + outFile + "\"";
 
    portable_sysTimerStart();
-   int exitCode = portable_system(mscExe, mscArgs, false);
+   int exitCode = ExtCmdManager::instance()->run("mscgen", mscExe, mscArgs, false);
    portable_sysTimerStop();
 
    if (exitCode == 0) {         
@@ -25,6 +25,7 @@
 
 #include <definition.h>
 #include <filenamelist.h>
+#include <memorystats.h>
 #include <stringmap.h>
 
 class ClassDef;
@@ -37,7 +38,7 @@ class NamespaceSDict;
 class OutputList;
 
 /** model of a namespace symbol */
-class NamespaceDef : public Definition
+class NamespaceDef : public Definition, private MemoryCounted<MemoryStats::NamespaceDefKind>
 {
  public:
    NamespaceDef(const QString &defFileName, int defLine, int defColumn, const QString &name, const QString &ref = QString(),
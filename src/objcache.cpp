@@ -21,10 +21,10 @@
 
 #include <objcache.h>
 
-ObjCache::ObjCache(unsigned int logSize)
+ObjCache::ObjCache(unsigned int logSize, const char *name)
    : m_head(-1), m_tail(-1), //m_numEntries(0),
      m_size(1 << logSize), m_count(0), m_freeHashNodes(0), m_freeCacheNodes(0),
-     m_lastHandle(-1)
+     m_lastHandle(-1), m_evictions(0), m_name(name)
 {
    int i;
    m_cache = new CacheNode[m_size];
@@ -56,6 +56,10 @@ int ObjCache::add(void *obj, void **victim)
       moveToFront(hnode->index);
       m_hits++;
 
+      if (CacheStats::isEnabled()) {
+         CacheStats::record(m_name, CacheStats::Hit);
+      }
+
    } else { 
       // object not in the cache
       void *lruObj = 0;
@@ -86,6 +90,12 @@ int ObjCache::add(void *obj, void **victim)
          lruObj = m_cache[m_tail].obj;
          hashRemove(lruObj);
          moveToFront(m_tail); // m_tail indexes the emptied element, which becomes m_head
+
+         m_evictions++;
+
+         if (CacheStats::isEnabled()) {
+            CacheStats::record(m_name, CacheStats::Eviction);
+         }
       }
 
       
@@ -94,6 +104,11 @@ int ObjCache::add(void *obj, void **victim)
       hnode->index = m_head;
       *victim = lruObj;
       m_misses++;
+
+      if (CacheStats::isEnabled()) {
+         CacheStats::record(m_name, CacheStats::Miss);
+         CacheStats::setUsage(m_name, m_count, m_size);
+      }
    }
 
    return m_head;
@@ -142,14 +157,6 @@ void ObjCache::printLRU()
 }
 #endif
 
-#ifdef CACHE_STATS
-#define cache_stats_printf printf
-void ObjCache::printStats()
-{
-   cache_stats_printf("ObjCache: hits = %d, misses = %d,  hit ratio=%f\n", m_hits, m_misses, m_hits * 100.0 / (m_hits + m_misses));
-}
-#endif
-
 void ObjCache::moveToFront(int index)
 {
    int prev, next;
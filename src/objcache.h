@@ -18,11 +18,11 @@
 #ifndef OBJCACHE_H
 #define OBJCACHE_H
 
+#include <cachestats.h>
+
 //#define CACHE_TEST
 //#define CACHE_DEBUG
 
-#define CACHE_STATS
-
 /** @brief Cache for objects.
  *
  *  This cache is used to decide which objects should remain in
@@ -50,9 +50,10 @@ class ObjCache
 
  public:
    /*! Creates the cache. The number of elements in the cache is 2 to
-    *  the power of \a logSize.
+    *  the power of \a logSize. The hits, misses and evictions are reported
+    *  to the cache statistics as \a name, which must be a string literal.
     */
-   ObjCache(unsigned int logSize);
+   ObjCache(unsigned int logSize, const char *name = "objcache");
 
    /*! Deletes the cache and free all internal data-structures used. */
    ~ObjCache();
@@ -74,6 +75,11 @@ class ObjCache
       }
       m_lastHandle = handle;
       m_hits++;
+
+      if (CacheStats::isEnabled()) {
+         CacheStats::record(m_name, CacheStats::Hit);
+      }
+
       moveToFront(handle);
    }
 
@@ -84,8 +90,6 @@ class ObjCache
 
    /*! Debug function. Prints the LRU list */
    void printLRU();
-   /*! Print miss/hits statistics */
-   void printStats();
 
    /*! total size of the cache */
    int size() const {
@@ -104,6 +108,10 @@ class ObjCache
       return m_misses;
    }
 
+   int evictions() const {
+      return m_evictions;
+   }
+
 
  private:
    void moveToFront(int index);
@@ -123,6 +131,9 @@ class ObjCache
    int        m_lastHandle;
    int        m_misses;
    int        m_hits;
+   int        m_evictions;
+
+   const char *m_name;
 };
 
 #endif // OBJCACHE_H
@@ -0,0 +1,96 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#include <QFile>
+#include <QMutexLocker>
+
+#include <outputwriter.h>
+
+#include <message.h>
+
+// characters of text which may be waiting for the workers
+static const qint64 s_maxQueuedSize = 32 * 1024 * 1024;
+
+OutputFileWriter::OutputFileWriter()
+   : m_pool(WorkerPool::threadCount("output-num-threads") - 1), m_queuedSize(0)
+{
+}
+
+OutputFileWriter::~OutputFileWriter()
+{
+   finish();
+}
+
+bool OutputFileWriter::writeFile(const QString &fileName, const QString &text)
+{
+   QFile f(fileName);
+
+   if (! f.open(QIODevice::WriteOnly)) {
+      return false;
+   }
+
+   const QByteArray data = text.toUtf8();
+
+   return f.write(data) == data.size();
+}
+
+void OutputFileWriter::add(const QString &fileName, const QString &text)
+{
+   if (m_pool.isSerial()) {
+      if (! writeFile(fileName, text)) {
+         err("Unable to open file for writing %s\n", csPrintable(fileName));
+      }
+
+      return;
+   }
+
+   {
+      QMutexLocker locker(&m_mutex);
+
+      while (m_queuedSize > s_maxQueuedSize) {
+         m_spaceAvailable.wait(&m_mutex);
+      }
+
+      m_queuedSize += text.size();
+   }
+
+   m_pool.start([this, fileName, text] () {
+      const bool ok = writeFile(fileName, text);
+
+      QMutexLocker locker(&m_mutex);
+      m_queuedSize -= text.size();
+
+      if (! ok) {
+         m_failed.append(fileName);
+      }
+
+      m_spaceAvailable.wakeAll();
+   } );
+}
+
+void OutputFileWriter::finish()
+{
+   m_pool.waitForDone();
+
+   // errors are reported by the generating thread
+   QMutexLocker locker(&m_mutex);
+
+   for (const auto &fileName : m_failed) {
+      err("Unable to open file for writing %s\n", csPrintable(fileName));
+   }
+
+   m_failed.clear();
+}
@@ -0,0 +1,85 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#ifndef OUTPUTWRITER_H
+#define OUTPUTWRITER_H
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QWaitCondition>
+
+#include <workerpool.h>
+
+/** @brief Writes generated files, optionally on a worker pool
+ *
+ *  A generator formats a compound into a string and passes it to add(). With the default of one
+ *  for 'output-num-threads' add() writes the file. Larger values only move the UTF-8 encoding
+ *  and the write to one less than that number of threads, the compounds are still generated on
+ *  the calling thread. When the queued text exceeds a limit add() waits for the writers.
+ */
+class OutputFileWriter
+{
+ public:
+   OutputFileWriter();
+   ~OutputFileWriter();
+
+   /** Queues \a text to be written to \a fileName */
+   void add(const QString &fileName, const QString &text);
+
+   /** Waits until all queued files are written, reports the files which could not be written */
+   void finish();
+
+ private:
+   static bool writeFile(const QString &fileName, const QString &text);
+
+   WorkerPool  m_pool;
+   QStringList m_failed;
+
+   // number of characters queued and not yet written
+   qint64 m_queuedSize;
+
+   QMutex         m_mutex;
+   QWaitCondition m_spaceAvailable;
+};
+
+/** Text of one output file, passed to an OutputFileWriter when the object is destroyed */
+class QueuedOutputFile
+{
+ public:
+   QueuedOutputFile(OutputFileWriter &writer, const QString &fileName)
+      : m_writer(writer), m_fileName(fileName), m_stream(&m_text)
+   {}
+
+   ~QueuedOutputFile() {
+      m_stream.flush();
+      m_writer.add(m_fileName, m_text);
+   }
+
+   QTextStream &stream() {
+      return m_stream;
+   }
+
+ private:
+   OutputFileWriter &m_writer;
+
+   QString     m_fileName;
+   QString     m_text;
+   QTextStream m_stream;
+};
+
+#endif
@@ -16,14 +16,24 @@
 *************************************************************************/
 
 #include <QByteArray>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
 #include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QSet>
+#include <QVector>
+#include <QWaitCondition>
 
+#include <atomic>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <parse_clang.h>
 
+#include <clangbuffers.h>
 #include <config.h>
 #include <doxy_globals.h>
 #include <entry.h>
@@ -34,11 +44,35 @@
 #include <stringmap.h>
 #include <tooltip.h>
 #include <util.h>
+#include <workerpool.h>
+
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/TextDiagnosticPrinter.h>
+#include <clang/Tooling/ArgumentsAdjusters.h>
+#include <clang/Tooling/CompilationDatabase.h>
 
 static QSet<QString>                 s_includedFiles;
 static QSharedPointer<Definition>    s_currentDefinition;
 static QSharedPointer<MemberDef>     s_currentMemberDef;
 
+// AST files saved by the entry pass, indexed by the name of the source file. Each file is about
+// the size of the preprocessed translation unit. Without a source code pass a file is removed
+// once the entry pass loaded it, otherwise after the source browser loaded it. The files which
+// are left are removed by removeSavedAsts()
+static QHash<QString, QString>       s_savedAstFiles;
+
+// once the saved files reach this size the remaining translation units are not saved and
+// the token passes parse them again
+static const qint64 maxSavedAstSize = qint64(2048) * 1024 * 1024;
+static std::atomic<qint64>           s_savedAstSize(0);
+
+// entries for declarations in headers, kept until the header is parsed as an include file or
+// as its own translation unit, entries which are left are released by finishPrefetch()
+static QHash<QString, QList<QSharedPointer<Entry>>> s_headerEntries;
+
+// headers whose declarations were added by an earlier translation unit
+static QSet<QString>                 s_claimedHeaders;
+
 static uint g_currentLine    = 0;
 static uint g_bracketCount   = 0;
 static bool g_searchForBody  = false;
@@ -46,6 +80,7 @@ static bool g_insideBody     = false;
 
 QSharedPointer<Entry>                s_current_root;
 QMap<QString, QSharedPointer<Entry>> s_entryMap;
+QSet<QString>                        s_headerFiles;
 
 static void writeLineNumber(CodeOutputInterface &ol, QSharedPointer<FileDef> fd, uint line);
 
@@ -55,20 +90,18 @@ class ClangParser::Private
    enum DetectedLang { Detected_Cpp, Detected_ObjC, Detected_ObjCpp };
 
    Private()
-      : tu(0), tokens(0), numTokens(0), cursors(0), ufs(0), sources(0), numFiles(0),
-        fileMapping(), detectedLang(Detected_Cpp)
+      : tu(0), tokens(0), numTokens(0), cursors(0), ufs(0), numFiles(0),
+        fileMapping(), detectedLang(Detected_Cpp), sourcePass(false)
    {
    }
 
-   int getCurrentTokenLine();
+   void buildTokenIndex();
+   void clearTokenIndex();
 
    QString fileName;
-   QByteArray *sources;
 
    uint numFiles;
    uint numTokens;
-   uint curLine;
-   uint curToken;
 
    CXIndex            index;
    CXTranslationUnit  tu;
@@ -78,26 +111,75 @@ class ClangParser::Private
 
    QHash<QString, uint> fileMapping;
    DetectedLang detectedLang;
+
+   // true when start() was called by the source browser
+   bool sourcePass;
+
+   // contents of the files in ufs, shared with other translation units
+   QVector<QSharedPointer<ClangBuffer>> buffers;
+
+   // token index, built once after the file is tokenized
+   QVector<uint> lineFirstToken;     // first token at or after each line
+   QVector<uint> tokenLine;
+   QVector<uint> tokenOffset;        // start of the spelling in tokenText
+   QVector<uint> tokenLength;
+   QByteArray    tokenText;          // UTF-8 spelling of all tokens
 };
 
-int ClangParser::Private::getCurrentTokenLine()
+void ClangParser::Private::buildTokenIndex()
 {
-   if (numTokens == 0) {
-      return 1;
+   clearTokenIndex();
+
+   tokenLine.resize(numTokens);
+   tokenOffset.resize(numTokens);
+   tokenLength.resize(numTokens);
+
+   uint maxLine = 0;
+
+   for (uint i = 0; i < numTokens; i++) {
+      uint line;
+      uint column;
+
+      CXSourceLocation start = clang_getTokenLocation(tu, tokens[i]);
+      clang_getSpellingLocation(start, 0, &line, &column, 0);
+
+      CXString text  = clang_getTokenSpelling(tu, tokens[i]);
+      const char *ts = clang_getCString(text);
+      uint tl        = ts ? strlen(ts) : 0;
+
+      tokenLine[i]   = line;
+      tokenOffset[i] = tokenText.size();
+      tokenLength[i] = tl;
+
+      tokenText.append(ts, tl);
+      clang_disposeString(text);
+
+      if (line > maxLine) {
+         maxLine = line;
+      }
    }
 
-   // guard against filters that reduce the number of lines
-   uint retval;
-   uint c;
+   // tokens are in source order, lines without tokens point to the next token
+   lineFirstToken.fill(numTokens, maxLine + 2);
 
-   if (curToken >= numTokens) {
-      curToken = numTokens - 1;
+   for (uint i = numTokens; i > 0; i--) {
+      lineFirstToken[tokenLine[i - 1]] = i - 1;
    }
 
-   CXSourceLocation start = clang_getTokenLocation(tu, tokens[curToken]);
-   clang_getSpellingLocation(start, 0, &retval, &c, 0);
+   for (int line = maxLine; line >= 0; line--) {
+      if (lineFirstToken[line] == numTokens) {
+         lineFirstToken[line] = lineFirstToken[line + 1];
+      }
+   }
+}
 
-   return retval;
+void ClangParser::Private::clearTokenIndex()
+{
+   lineFirstToken.clear();
+   tokenLine.clear();
+   tokenOffset.clear();
+   tokenLength.clear();
+   tokenText.clear();
 }
 
 ClangParser *ClangParser::instance()
@@ -113,6 +195,7 @@ ClangParser::ClangParser()
 
 ClangParser::~ClangParser()
 {
+   removeSavedAsts();
    delete p;
 }
 
@@ -179,57 +262,6 @@ static void codifyLines(CodeOutputInterface &ol, QSharedPointer<FileDef> fd,
    }
 }
 
-static QString detab(const QString &str)
-{
-   static int tabSize = Config::getInt("tab-size");
-
-   QString out;
-   int col = 0;
-
-   const int maxIndent = 1000000;    // value representing infinity
-   int minIndent = maxIndent;
-
-   for (auto c : str) {
-
-      switch (c.unicode()) {
-
-         case '\t': {
-            // expand tab
-            int stop = tabSize - (col % tabSize);
-            col += stop;
-
-            while (stop--) {
-               out += ' ';
-            }
-         }
-         break;
-
-         case '\n':
-            // reset colomn counter
-            out += c;
-            col = 0;
-            break;
-
-         case ' ':
-            // increment column counter
-            out += c;
-            col++;
-            break;
-
-         default:
-            // non-whitespace, update minIndent
-            out += c;
-
-            if (col < minIndent) {
-               minIndent = col;
-            }
-            col++;
-      }
-   }
-
-   return out;
-}
-
 static void detectFunctionBody(const QString s)
 {
   if (g_searchForBody && (s == ":" || s == "{")) {
@@ -487,382 +519,1203 @@ static bool documentKind(CXCursor cursor)
    return false;
 }
 
-// ** entry point
-void ClangParser::start(const QString &fileName, QStringList &includeFiles, QSharedPointer<Entry> root)
+// call back, collects the files used to build a precompiled header
+static void pchInclusionVisitor(CXFile file, CXSourceLocation *, uint, CXClientData clientData)
 {
-   static QStringList includePath = Config::getList("include-path");
-   static QStringList clangFlags  = Config::getList("clang-flags");
+   QStringList *list = static_cast<QStringList *>(clientData);
+   list->append(getFileName(file));
+}
 
-   std::vector<std::string> argList;
+static QByteArray hashFile(const QString &fileName)
+{
+   QFile f(fileName);
 
-   // add include paths for input files
-   for (auto &item : Doxy_Globals::inputPaths) {
-      std::string inc = std::string("-I") + item.toUtf8().constData();
-      argList.push_back(std::move(inc));
+   if (! f.open(QIODevice::ReadOnly)) {
+      return QByteArray();
    }
 
-   // add external include paths
-   for (auto &item : includePath) {
-      std::string inc = std::string("-I") + item.toUtf8().constData();
-      argList.push_back(std::move(inc));
-   }
+   QCryptographicHash hash(QCryptographicHash::Md5);
 
-   // user specified flags
-   for (auto &item : clangFlags) {
-      argList.push_back(item.toUtf8().constData());
+   while (! f.atEnd()) {
+      hash.addData(f.read(65536));
    }
 
-   argList.push_back("-ferror-limit=0");
-   argList.push_back("-x");
+   return hash.result().toHex();
+}
 
-   // if the file is an .h file it can contain C, C++, or Objective C  (review)
-   // detection will fail if we pass .h files containing ObjC code and no source
+// the dependency file lists the hash and name of each header used by the precompiled header,
+// the header is current when none of these files changed
+static bool pchIsCurrent(const QString &pchFile, const QString &depFile)
+{
+   if (! QFile::exists(pchFile)) {
+      return false;
+   }
 
-   SrcLangExt lang = getLanguageFromFileName(fileName);
+   QFile f(depFile);
 
-   if (lang == SrcLangExt_ObjC || p->detectedLang != ClangParser::Private::Detected_Cpp) {
-      QFileInfo fi(fileName);
-      QString ext = fi.suffix().toLower();
+   if (! f.open(QIODevice::ReadOnly)) {
+      return false;
+   }
 
-      if (p->detectedLang == ClangParser::Private::Detected_Cpp &&
-            (ext == "cpp" || ext == "cxx" || ext == "cc" || ext == "c")) {
+   bool isEmpty = true;
 
-         // fall back to C/C++ once we see an extension that indicates C++
-         p->detectedLang = ClangParser::Private::Detected_Cpp;
+   while (! f.atEnd()) {
+      QByteArray line = f.readLine().trimmed();
+      int i = line.indexOf(' ');
 
-      } else if (ext == "mm") {
-         // switch to Objective C++
-         p->detectedLang = ClangParser::Private::Detected_ObjCpp;
+      if (i == -1) {
+         continue;
+      }
 
-      } else if (ext == "m") {
-         // switch to Objective C
-         p->detectedLang = ClangParser::Private::Detected_ObjC;
+      if (hashFile(QString::fromUtf8(line.mid(i + 1))) != line.left(i)) {
+         return false;
       }
+
+      isEmpty = false;
    }
 
-   switch (p->detectedLang) {
-      case ClangParser::Private::Detected_Cpp:
-         argList.push_back("c++");
-         break;
+   return ! isEmpty;
+}
 
-      case ClangParser::Private::Detected_ObjC:
-         argList.push_back("objective-c");
-         break;
+// returns a precompiled header for 'clang-pch-headers' built with the flags in argList, the header
+// is created in the output directory and reused as long as the flags and the headers do not change
+static QString getPrecompiledHeader(const std::vector<std::string> &argList)
+{
+   static const QStringList pchHeaders = Config::getList("clang-pch-headers");
+   static QHash<QByteArray, QString> pchFiles;
 
-      case ClangParser::Private::Detected_ObjCpp:
-         argList.push_back("objective-c++");
-         break;
+   if (pchHeaders.isEmpty()) {
+      return QString();
    }
 
-   argList.push_back(fileName.toUtf8().constData());
-
-   // exclude PCH files, disable diagnostics
-   p->index    = clang_createIndex(false, false);
+   QCryptographicHash hash(QCryptographicHash::Md5);
 
-   p->fileName = fileName;
-   p->curLine  = 1;
-   p->curToken = 0;
+   CXString version = clang_getClangVersion();
+   hash.addData(QByteArray(clang_getCString(version)));
+   clang_disposeString(version);
 
-   // provide the input and their dependencies as unsaved files in memory
-   static bool filterSourceFiles = Config::getBool("filter-source-files");
+   for (const auto &item : argList) {
+      hash.addData(item.c_str(), static_cast<int>(item.size()) + 1);
+   }
 
-   uint numUnsavedFiles = includeFiles.count() + 1;
+   for (const auto &item : pchHeaders) {
+      hash.addData(item.toUtf8());
+      hash.addData("\n", 1);
+   }
 
-   p->numFiles = numUnsavedFiles;
-   p->sources  = new QByteArray[numUnsavedFiles];
-   p->ufs      = new CXUnsavedFile[numUnsavedFiles];
+   QByteArray key = hash.result().toHex();
 
-   p->sources[0]      = detab(fileToString(fileName, filterSourceFiles, true)).toUtf8();
-   p->ufs[0].Filename = strdup(fileName.toUtf8());
-   p->ufs[0].Contents = p->sources[0].constData();
-   p->ufs[0].Length   = p->sources[0].length();
+   auto iter = pchFiles.constFind(key);
 
-   //
-   uint i = 1;
-   for (auto item : includeFiles) {
+   if (iter != pchFiles.constEnd()) {
+      return iter.value();
+   }
 
-      p->fileMapping.insert(item, i);
+   static const QString pchDir = Config::getString("output-dir") + "/clang_pch";
 
-      p->sources[i]      = detab(fileToString(item, filterSourceFiles, true)).toUtf8();
-      p->ufs[i].Filename = strdup(item.toUtf8());
-      p->ufs[i].Contents = p->sources[i].constData();
-      p->ufs[i].Length   = p->sources[i].length();
+   QString baseName = pchDir + "/" + QString::fromLatin1(key);
+   QString pchFile  = baseName + ".pch";
+   QString depFile  = baseName + ".deps";
 
-      i++;
+   if (pchIsCurrent(pchFile, depFile)) {
+      pchFiles.insert(key, pchFile);
+      return pchFile;
    }
 
-   // data structure, source filename (in argv), cmd line args, num of cmd line args
-   // pass unsaved files(?), num of unsaved files, options flag, trans unit
-
-   std::vector<const char *> argv;
-   for (auto &item : argList) {
-      argv.push_back(item.c_str());
-   }
+   msg("Building precompiled header for Clang\n");
 
-   int argc = argList.size();
+   QString headerFile = baseName + ".h";
+   QFile f(headerFile);
 
-   CXErrorCode errorCode = clang_parseTranslationUnit2(p->index, 0, &argv[0], argc, p->ufs, numUnsavedFiles,
-                  CXTranslationUnit_DetailedPreprocessingRecord, &(p->tu) );
+   if (! QDir().mkpath(pchDir) || ! f.open(QIODevice::WriteOnly)) {
+      err("Unable to create precompiled header %s\n", csPrintable(pchFile));
 
-   if (p->tu && errorCode == CXError_Success) {
-      // filter out any includes not found by the clang parser
-      determineInputFiles(includeFiles);
+      pchFiles.insert(key, QString());
+      return QString();
+   }
 
-      // show any warnings the compiler produced
-      uint diagCnt = clang_getNumDiagnostics(p->tu);
+   for (const auto &item : pchHeaders) {
+      if (item.startsWith('<') || item.startsWith('"')) {
+         f.write("#include " + item.toUtf8() + "\n");
+      } else {
+         f.write("#include \"" + item.toUtf8() + "\"\n");
+      }
+   }
 
-      for (uint i = 0; i != diagCnt; i++) {
-         CXDiagnostic diag = clang_getDiagnostic(p->tu, i);
-         CXString diagMsg  = clang_formatDiagnostic(diag, clang_defaultDiagnosticDisplayOptions());
+   f.close();
 
-         err("%s\n", clang_getCString(diagMsg));
+   // same flags as the translation units, the language is changed to the header variant
+   std::vector<std::string> pchArgs(argList);
 
-         clang_disposeDiagnostic(diag);
-         clang_disposeString(diagMsg);
+   for (size_t i = 0; i + 1 < pchArgs.size(); i++) {
+      if (pchArgs[i] == "-x") {
+         pchArgs[i + 1] += "-header";
       }
+   }
 
-      if (diagCnt > 0) {
-         msg("\n");
-      }
+   pchArgs.push_back(headerFile.toUtf8().constData());
 
-      if (root == nullptr)  {
-         // called from writeSouce in fileDef
+   std::vector<const char *> argv;
 
-      } else {
-         // start adding to entry
-         s_current_root = root;
+   for (auto &item : pchArgs) {
+      argv.push_back(item.c_str());
+   }
 
-         argList.erase(argList.end() - 1);
+   CXIndex index = clang_createIndex(false, false);
+   CXTranslationUnit tu = nullptr;
 
-         // pass the list of files to parse
-         clang::tooling::FixedCompilationDatabase options(".", argList);
+   CXErrorCode errorCode = clang_parseTranslationUnit2(index, 0, &argv[0], argv.size(), 0, 0,
+                  CXTranslationUnit_Incomplete | CXTranslationUnit_ForSerialization, &tu);
 
-         // pass the list of files to parse
-         std::vector<std::string> sourceList;
-         sourceList.push_back(fileName.toUtf8().constData());
+   QString retval;
 
-         // create a new clang tooling instance
-         clang::tooling::ClangTool tool(options, sourceList);
+   if (tu && errorCode == CXError_Success &&
+         clang_saveTranslationUnit(tu, pchFile.toUtf8().constData(), clang_defaultSaveOptions(tu)) == CXSaveError_None) {
 
-         // run the clang tooling to create a new FrontendAction
-         int result = tool.run(clang::tooling::newFrontendActionFactory<DoxyFrontEnd>().get());
+      QStringList depList;
+      clang_getInclusions(tu, pchInclusionVisitor, &depList);
+
+      QFile deps(depFile);
+
+      if (deps.open(QIODevice::WriteOnly)) {
+         for (const auto &item : depList) {
+            deps.write(hashFile(item) + " " + item.toUtf8() + "\n");
+         }
       }
 
-      // create a source range for the file
-      QFileInfo fi(fileName);
-      CXFile f = clang_getFile(p->tu, fileName.toUtf8());
+      retval = pchFile;
 
-      CXSourceLocation fileBegin = clang_getLocationForOffset(p->tu, f, 0);
-      CXSourceLocation fileEnd   = clang_getLocationForOffset(p->tu, f, p->ufs[0].Length);
-      CXSourceRange    fileRange = clang_getRange(fileBegin, fileEnd);
+   } else {
+      err("Unable to create precompiled header %s, parsing without it\n", csPrintable(pchFile));
 
-      // generate tokens for the tu
-      clang_tokenize(p->tu, fileRange, &p->tokens, &p->numTokens);
+   }
 
-      // generate cursors for each token
-      p->cursors = new CXCursor[p->numTokens];
-      clang_annotateTokens(p->tu, p->tokens, p->numTokens, p->cursors);
+   if (tu) {
+      clang_disposeTranslationUnit(tu);
+   }
 
-      if (root == nullptr)  {
-         // called from writeSouce in fileDef
-         return;
-      }
+   clang_disposeIndex(index);
 
-      static bool javadoc_auto_brief = Config::getBool("javadoc-auto-brief");
-      static bool qt_auto_brief      = Config::getBool("qt-auto-brief");
+   pchFiles.insert(key, retval);
 
-      // walk the tokens
-      for (int index = 0; index < p->numTokens; index++)  {
+   return retval;
+}
 
-         CXTokenKind tokenKind = clang_getTokenKind(p->tokens[index]);
+static QString astDirName()
+{
+   static const QString astDir = Config::getString("output-dir") + "/clang_ast";
+   return astDir;
+}
 
-         if (tokenKind == CXToken_Comment) {
-            QString comment = getTokenSpelling(p->tu, p->tokens[index]);
-            comment = comment.trimmed();
+static void removeAstFile(const QString &astFile)
+{
+   s_savedAstSize -= QFileInfo(astFile).size();
+   QFile::remove(astFile);
+}
 
-            CXCursor cursor;
-            bool isBrief = false;
+// true if the source code pass loads the saved ASTs, call graphs requested by a
+// command in the documentation are only known later and parse the files again
+static bool sourcePassNeeded()
+{
+   static const bool sourceBrowser = Config::getBool("source-code");
+   return sourceBrowser || Doxy_Globals::parseSourcesNeeded;
+}
 
-            // figure out which cursor this comment is associated with
-            if (comment.isEmpty()) {
-               // not a valid comment
-               continue;
+static QString astFileName(const QString &fileName)
+{
+   static const QString astDir = astDirName();
+   static const bool dirOk     = QDir().mkpath(astDir);
 
-            } else if (comment.mid(3, 1) == "<")  {
-               int tmpIndex = index - 1;
+   if (! dirOk) {
+      return QString();
+   }
 
-               while (tmpIndex >= 0)   {
-                  cursor = p->cursors[tmpIndex];
-                  bool found = true;
+   return astDir + "/" + QString::fromLatin1(QCryptographicHash::hash(fileName.toUtf8(),
+                  QCryptographicHash::Md5).toHex()) + ".ast";
+}
 
-                  if (clang_Cursor_isNull(cursor) || ! documentKind(cursor)) {
-                     found = false;
+// one translation unit parsed by libTooling
+struct ClangAstJob {
+   enum State { Queued, Running, Done, Dropped };
 
-                  } else {
-                     QString phrase = getTokenSpelling(p->tu, p->tokens[tmpIndex]);
+   ClangAstJob(const QString &name, const std::vector<std::string> &args)
+      : fileName(name), argList(args), state(Queued)
+   {}
 
-                     if (phrase == "," || phrase == ";") {
-                        found = false;
-                     }
-                  }
+   QString fileName;
+   std::vector<std::string> argList;          // last entry is the file name
 
-                  if (found) {
-                     break;
+   std::unique_ptr<clang::ASTUnit> ast;
+   std::string diagnostics;
+   QString astFile;                           // empty if the AST was not saved
 
-                  } else {
-                    tmpIndex--;
-                    continue;
+   State state;
+};
 
-                  }
-               }
+// build the AST for a translation unit and save it for the token pass, called on a
+// worker thread when clang-num-threads is not one
+static void buildAst(ClangAstJob &job, const CXUnsavedFile *ufs, uint numFiles)
+{
+   std::vector<std::string> argList(job.argList.begin(), job.argList.end() - 1);
 
-               QChar char2  = comment.at(2);
+   // the preprocessing record provides the cursors for macros and includes
+   argList.push_back("-Xclang");
+   argList.push_back("-detailed-preprocessing-record");
 
-               if (javadoc_auto_brief && char2 == '*') {
-                  isBrief = true;
+   clang::tooling::FixedCompilationDatabase options(".", argList);
 
-               } else if (qt_auto_brief && char2 == '!') {
-                  isBrief = true;
+   std::vector<std::string> sourceList;
+   sourceList.push_back(job.argList.back());
 
-               } else if (char2 == '/' || char2 == '!') {
-                  isBrief = true;
+   clang::tooling::ClangTool tool(options, sourceList);
 
-               }
+   // parse the same (filtered and detabbed) buffers libclang would see
+   for (uint i = 0; i < numFiles; i++) {
+      tool.mapVirtualFile(ufs[i].Filename, llvm::StringRef(ufs[i].Contents, ufs[i].Length));
+   }
 
-               if (comment.startsWith("/**<") || comment.startsWith("/*!<")) {
-                  // */ (editor syntax fix)
+   // collect the diagnostics so they are reported in the order the files are parsed
+   llvm::raw_string_ostream diagStream(job.diagnostics);
+   clang::TextDiagnosticPrinter diagPrinter(diagStream, new clang::DiagnosticOptions());
+   tool.setDiagnosticConsumer(&diagPrinter);
 
-                  int len = comment.length() - 6;
-                  comment = comment.mid(4, len);
+   std::vector<std::unique_ptr<clang::ASTUnit>> astList;
 
-               } else {
-                  comment = comment.mid(4);
+   if (tool.buildASTs(astList) == 0 && astList.size() == 1) {
+      job.ast = std::move(astList[0]);
 
-               }
+      QString astFile = astFileName(job.fileName);
 
-            } else if (comment.startsWith("/**")) {
-               // */ (editor syntax fix),   javadoc comment
+      if (! astFile.isEmpty() && s_savedAstSize < maxSavedAstSize && ! job.ast->Save(astFile.toUtf8().constData())) {
+         job.astFile = astFile;
+         s_savedAstSize += QFileInfo(astFile).size();
+      }
+   }
 
-               cursor = p->cursors[index+1];
+   diagStream.flush();
+}
 
-               int len = comment.length() - 5;
-               comment = comment.mid(3, len);
+// add the entries of a parsed translation unit to the current root, returns false if there is no AST
+static bool useAstJob(ClangAstJob &job)
+{
+   QString diagnostics = QString::fromUtf8(job.diagnostics.c_str());
 
-               // remove single *
-               QRegExp reg("\n\\s*\\*");
-               comment.replace(reg, "\n");
+   if (! diagnostics.isEmpty()) {
+      for (const auto &line : diagnostics.split('\n', QString::SkipEmptyParts)) {
+         err("%s\n", csPrintable(line));
+      }
 
-               if (javadoc_auto_brief) {
-                  isBrief = true;
-               }
+      msg("\n");
+   }
 
-            } else if (comment.startsWith("/*!")) {
-               // */ (editor syntax fix),   qt comment
+   if (! job.ast) {
+      return false;
+   }
 
-               cursor = p->cursors[index+1];
+   traverseDoxyAST(job.ast->getASTContext());
+   job.ast.reset();
 
-               int len = comment.length() - 5;
-               comment = comment.mid(3, len);
+   if (job.astFile.isEmpty()) {
+      // entries were added, the token pass will parse the file again
+      s_savedAstFiles.remove(job.fileName);
 
-               if (qt_auto_brief) {
-                  isBrief = true;
-               }
+   } else {
+      s_savedAstFiles.insert(job.fileName, job.astFile);
+   }
 
-            } else if (comment.startsWith("///") || comment.startsWith("//!")  ) {
-               // triple slash or //!  which is always a brief
+   return true;
+}
 
-               comment = comment.mid(3);
-               isBrief = true;
+// parse the translation unit once using libTooling, add the entries to the current root and save the AST
+// so the token and cursor passes can load it with libclang, returns false if the AST could not be built
+static bool parseSingleAst(const QString &fileName, const std::vector<std::string> &argList,
+                  const CXUnsavedFile *ufs, uint numFiles)
+{
+   ClangAstJob job(fileName, argList);
+   buildAst(job, ufs, numFiles);
 
-               int tmpIndex = index + 1;
+   return useAstJob(job);
+}
 
-               while (tmpIndex < p->numTokens)  {
+static int clangNumThreads()
+{
+   static int numThreads = -1;
 
-                  // is this next cursor a comment?
-                  CXTokenKind tokenKind = clang_getTokenKind(p->tokens[tmpIndex]);
+   if (numThreads == -1) {
+      numThreads = WorkerPool::threadCount("clang-num-threads");
+   }
 
-                  if (tokenKind == CXToken_Comment) {
-                     tmpIndex++;
+   return numThreads;
+}
 
-                  }  else {
-                     cursor = p->cursors[tmpIndex];
-                     break;
-                  }
-               }
+/** Queue of translation units which are parsed on a worker pool, the entries are added to
+ *  the root by ClangParser::start() in the original order so the result does not depend on
+ *  the number of threads
+ */
+class ClangAstQueue
+{
+ public:
+   static ClangAstQueue &instance() {
+      static ClangAstQueue queue;
+      return queue;
+   }
 
-            } else  {
-               continue;
+   void addJobs(const QList<QSharedPointer<ClangAstJob>> &jobList, const QStringList &sourceList);
+   QSharedPointer<ClangAstJob> take(const QString &fileName);
+   void shutDown();
 
-            }
+ private:
+   ClangAstQueue()
+      : m_pool(clangNumThreads()), m_nextJob(0), m_ready(0), m_running(0), m_stopping(false)
+   {}
 
-            // test the cursor
-            if (documentKind(cursor)) {
+   ~ClangAstQueue() {
+      shutDown();
+   }
 
-               // add the comment to cursor
-               QString name = getCursorSpelling(cursor);
-               QString key  = getCursorUSR(cursor);
+   void startJobs();
+   void jobFinished(QSharedPointer<ClangAstJob> job);
+   void runJob(ClangAstJob &job);
 
-               QSharedPointer<Entry> current = s_entryMap.value(key);
+   WorkerPool m_pool;
 
-               if (current) {
-                  if (isBrief && current->brief.isEmpty()) {
-                     QString brief;
-                     QRegExp reg("([^.]*\\.)\\s(.*)");
+   // jobs not yet taken by the parser, in parse order
+   QList<QSharedPointer<ClangAstJob>> m_jobs;
 
-                     if (reg.exactMatch(comment)) {
-                        brief   = reg.cap(1);
-                        comment = reg.cap(2);
+   // filtered and detabbed sources, shared by all jobs
+   QList<QSharedPointer<ClangBuffer>> m_buffers;
+   QVector<CXUnsavedFile> m_ufs;
+   QSet<QString>          m_sourceNames;
 
-                     } else {
-                        brief   = comment;
-                        comment = "";
-                     }
+   int  m_nextJob;
+   int  m_ready;
+   int  m_running;
+   bool m_stopping;
 
-                     current->brief = brief;
-                  }
+   QMutex         m_mutex;
+   QWaitCondition m_jobFinished;
+};
 
-                  current->doc += comment;
-               }
+void ClangAstQueue::addJobs(const QList<QSharedPointer<ClangAstJob>> &jobList, const QStringList &sourceList)
+{
+   {
+      QMutexLocker locker(&m_mutex);
+
+      if (m_stopping) {
+         return;
+      }
+
+      // buffers are only added while no job is running, the jobs read them without a lock
+      if (m_running == 0) {
+         for (const auto &item : sourceList) {
+
+            if (m_sourceNames.contains(item)) {
+               continue;
             }
+
+            m_sourceNames.insert(item);
+            m_buffers.append(ClangBufferCache::instance().buffer(item));
+            m_ufs.append(m_buffers.last()->unsavedFile());
          }
       }
 
-   } else {
-      p->tokens    = 0;
-      p->numTokens = 0;
-      p->cursors   = 0;
-
-      err("Clang failed to parse file %s\n", csPrintable(fileName));
+      m_jobs.append(jobList);
    }
+
+   startJobs();
 }
 
-void ClangParser::finish()
+// passes the next jobs to the pool, the number of ASTs which are built or waiting for the parser is
+// limited to the number of threads
+void ClangAstQueue::startJobs()
 {
-   if (p->tu) {
+   if (m_pool.isSerial()) {
+      // the pool was stopped, remaining files are parsed by ClangParser::start()
+      return;
+   }
 
-      delete[] p->cursors;
+   QList<QSharedPointer<ClangAstJob>> startList;
 
-      clang_disposeTokens(p->tu, p->tokens, p->numTokens);
-      clang_disposeTranslationUnit(p->tu);
-      clang_disposeIndex(p->index);
+   {
+      QMutexLocker locker(&m_mutex);
 
-      p->fileMapping.clear();
+      const int maxReady = qMax(2, clangNumThreads());
+
+      while (! m_stopping && m_nextJob < m_jobs.count() && m_ready + m_running < maxReady) {
+         QSharedPointer<ClangAstJob> job = m_jobs.at(m_nextJob);
+         ++m_nextJob;
+
+         job->state = ClangAstJob::Running;
+         m_running++;
+
+         startList.append(job);
+      }
+   }
+
+   for (const auto &job : startList) {
+      m_pool.start([this, job] () {
+         runJob(*job);
+         jobFinished(job);
+      } );
+   }
+}
+
+void ClangAstQueue::runJob(ClangAstJob &job)
+{
+   buildAst(job, m_ufs.constData(), m_ufs.count());
+}
+
+void ClangAstQueue::jobFinished(QSharedPointer<ClangAstJob> job)
+{
+   {
+      QMutexLocker locker(&m_mutex);
+      m_running--;
+
+      if (job->state == ClangAstJob::Dropped) {
+         // the parser no longer needs this file
+         job->ast.reset();
+
+      } else {
+         job->state = ClangAstJob::Done;
+         m_ready++;
+      }
+
+      m_jobFinished.wakeAll();
+   }
+
+   startJobs();
+}
+
+// returns the parsed translation unit for fileName or an empty pointer if the file was not queued,
+// jobs queued before fileName are dropped since the parser has moved past them
+QSharedPointer<ClangAstJob> ClangAstQueue::take(const QString &fileName)
+{
+   QSharedPointer<ClangAstJob> job;
+
+   {
+      QMutexLocker locker(&m_mutex);
+
+      int index = -1;
+
+      for (int i = 0; i < m_jobs.count(); i++) {
+         if (m_jobs.at(i)->fileName == fileName) {
+            index = i;
+            break;
+         }
+      }
+
+      if (index == -1) {
+         return QSharedPointer<ClangAstJob>();
+      }
+
+      for (int i = 0; i < index; i++) {
+         QSharedPointer<ClangAstJob> item = m_jobs.takeFirst();
+
+         if (item->state == ClangAstJob::Done) {
+            item->ast.reset();
+            m_ready--;
+         }
+
+         item->state = ClangAstJob::Dropped;
+      }
+
+      m_nextJob = qMax(0, m_nextJob - index);
+
+      job = m_jobs.takeFirst();
+
+      if (job->state == ClangAstJob::Queued) {
+         // no worker started this file yet, parse it now
+         m_nextJob = qMax(0, m_nextJob - 1);
+         job->state = ClangAstJob::Running;
+
+         locker.unlock();
+         runJob(*job);
+         locker.relock();
+
+      } else {
+         m_nextJob = qMax(0, m_nextJob - 1);
+
+         while (job->state == ClangAstJob::Running) {
+            m_jobFinished.wait(&m_mutex);
+         }
+
+         m_ready--;
+      }
+
+      job->state = ClangAstJob::Done;
+   }
+
+   startJobs();
+
+   return job;
+}
+
+void ClangAstQueue::shutDown()
+{
+   {
+      QMutexLocker locker(&m_mutex);
+      m_stopping = true;
+   }
+
+   // waits for the jobs which were started
+   m_pool.stop();
+
+   for (auto &job : m_jobs) {
+      job->ast.reset();
+   }
+
+   m_jobs.clear();
+   m_nextJob = 0;
+   m_ready   = 0;
+
+   m_ufs.clear();
+   m_buffers.clear();
+   m_sourceNames.clear();
+
+   m_stopping = false;
+}
+
+// compilation database from 'clang-compilation-path', nullptr when the option is not set
+static clang::tooling::CompilationDatabase *compilationDatabase()
+{
+   static std::unique_ptr<clang::tooling::CompilationDatabase> database;
+   static bool loaded = false;
+
+   if (! loaded) {
+      loaded = true;
+
+      QString dbPath = Config::getString("clang-compilation-path");
+
+      if (! dbPath.isEmpty()) {
+         QFileInfo fi(dbPath);
+
+         if (fi.isFile()) {
+            // path to the compile_commands.json file
+            dbPath = fi.absolutePath();
+         }
+
+         std::string errorMsg;
+         database = clang::tooling::CompilationDatabase::loadFromDirectory(dbPath.toUtf8().constData(), errorMsg);
+
+         if (database == nullptr) {
+            err("Unable to load the compilation database in %s, %s\n", csPrintable(dbPath), errorMsg.c_str());
+         }
+      }
+   }
+
+   return database.get();
+}
+
+// adds the flags the compilation database has for fileName, returns false if the file has no entry
+static bool addCompileCommand(const QString &fileName, std::vector<std::string> &argList)
+{
+   clang::tooling::CompilationDatabase *database = compilationDatabase();
+
+   if (database == nullptr) {
+      return false;
+   }
+
+   std::vector<clang::tooling::CompileCommand> commandList = database->getCompileCommands(fileName.toUtf8().constData());
+
+   if (commandList.empty()) {
+      return false;
+   }
+
+   // a file built with several sets of flags is only parsed with the first one
+   const clang::tooling::CompileCommand &command = commandList.front();
+
+   clang::tooling::CommandLineArguments cmdLine = command.CommandLine;
+   cmdLine = clang::tooling::getClangStripOutputAdjuster()(cmdLine, command.Filename);
+   cmdLine = clang::tooling::getClangStripDependencyFileAdjuster()(cmdLine, command.Filename);
+
+   const std::string absFileName = QDir(QString::fromUtf8(command.Directory.c_str()))
+                  .absoluteFilePath(QString::fromUtf8(command.Filename.c_str())).toUtf8().constData();
+
+   // relative paths in the flags are relative to the build directory
+   argList.push_back("-working-directory");
+   argList.push_back(command.Directory);
+
+   // skip the compiler, the file name is added by the caller
+   for (size_t i = 1; i < cmdLine.size(); i++) {
+      const std::string &item = cmdLine[i];
+
+      if (item == "-c" || item == command.Filename || item == absFileName) {
+         continue;
+      }
+
+      argList.push_back(item);
+   }
+
+   return true;
+}
+
+// returns the command line for a translation unit, the last entry is the file name
+static std::vector<std::string> buildArgList(const QString &fileName, ClangParser::Private::DetectedLang &detectedLang)
+{
+   static const QStringList includePath = Config::getList("include-path");
+   static const QStringList clangFlags  = Config::getList("clang-flags");
+
+   std::vector<std::string> argList;
+
+   if (addCompileCommand(fileName, argList)) {
+      // the real flags of the file, the language is selected by the compiler flags
+      argList.push_back("-ferror-limit=0");
+      argList.push_back(fileName.toUtf8().constData());
+
+      return argList;
+   }
+
+   // add include paths for input files
+   for (auto &item : Doxy_Globals::inputPaths) {
+      std::string inc = std::string("-I") + item.toUtf8().constData();
+      argList.push_back(std::move(inc));
+   }
+
+   // add external include paths
+   for (auto &item : includePath) {
+      std::string inc = std::string("-I") + item.toUtf8().constData();
+      argList.push_back(std::move(inc));
+   }
+
+   // user specified flags
+   for (auto &item : clangFlags) {
+      argList.push_back(item.toUtf8().constData());
+   }
+
+   argList.push_back("-ferror-limit=0");
+   argList.push_back("-x");
+
+   // if the file is an .h file it can contain C, C++, or Objective C  (review)
+   // detection will fail if we pass .h files containing ObjC code and no source
+
+   SrcLangExt lang = getLanguageFromFileName(fileName);
+
+   if (lang == SrcLangExt_ObjC || detectedLang != ClangParser::Private::Detected_Cpp) {
+      QFileInfo fi(fileName);
+      QString ext = fi.suffix().toLower();
+
+      if (detectedLang == ClangParser::Private::Detected_Cpp &&
+            (ext == "cpp" || ext == "cxx" || ext == "cc" || ext == "c")) {
+
+         // fall back to C/C++ once we see an extension that indicates C++
+         detectedLang = ClangParser::Private::Detected_Cpp;
+
+      } else if (ext == "mm") {
+         // switch to Objective C++
+         detectedLang = ClangParser::Private::Detected_ObjCpp;
+
+      } else if (ext == "m") {
+         // switch to Objective C
+         detectedLang = ClangParser::Private::Detected_ObjC;
+      }
+   }
+
+   switch (detectedLang) {
+      case ClangParser::Private::Detected_Cpp:
+         argList.push_back("c++");
+         break;
+
+      case ClangParser::Private::Detected_ObjC:
+         argList.push_back("objective-c");
+         break;
+
+      case ClangParser::Private::Detected_ObjCpp:
+         argList.push_back("objective-c++");
+         break;
+   }
+
+   QString pchFile = getPrecompiledHeader(argList);
+
+   if (! pchFile.isEmpty()) {
+      argList.push_back("-include-pch");
+      argList.push_back(pchFile.toUtf8().constData());
+   }
+
+   argList.push_back(fileName.toUtf8().constData());
+
+   return argList;
+}
+
+// attaches the documentation in the comments of the tokenized file to the entries
+static void attachComments(ClangParser::Private *p)
+{
+   static bool javadoc_auto_brief = Config::getBool("javadoc-auto-brief");
+   static bool qt_auto_brief      = Config::getBool("qt-auto-brief");
+
+   // walk the tokens
+   for (int index = 0; index < p->numTokens; index++)  {
+
+      CXTokenKind tokenKind = clang_getTokenKind(p->tokens[index]);
+
+      if (tokenKind == CXToken_Comment) {
+         QString comment = getTokenSpelling(p->tu, p->tokens[index]);
+         comment = comment.trimmed();
+
+         CXCursor cursor;
+         bool isBrief = false;
+
+         // figure out which cursor this comment is associated with
+         if (comment.isEmpty()) {
+            // not a valid comment
+            continue;
+
+         } else if (comment.mid(3, 1) == "<")  {
+            int tmpIndex = index - 1;
+
+            while (tmpIndex >= 0)   {
+               cursor = p->cursors[tmpIndex];
+               bool found = true;
+
+               if (clang_Cursor_isNull(cursor) || ! documentKind(cursor)) {
+                  found = false;
+
+               } else {
+                  QString phrase = getTokenSpelling(p->tu, p->tokens[tmpIndex]);
+
+                  if (phrase == "," || phrase == ";") {
+                     found = false;
+                  }
+               }
+
+               if (found) {
+                  break;
+
+               } else {
+                 tmpIndex--;
+                 continue;
+
+               }
+            }
+
+            QChar char2  = comment.at(2);
+
+            if (javadoc_auto_brief && char2 == '*') {
+               isBrief = true;
+
+            } else if (qt_auto_brief && char2 == '!') {
+               isBrief = true;
+
+            } else if (char2 == '/' || char2 == '!') {
+               isBrief = true;
+
+            }
+
+            if (comment.startsWith("/**<") || comment.startsWith("/*!<")) {
+               // */ (editor syntax fix)
+
+               int len = comment.length() - 6;
+               comment = comment.mid(4, len);
+
+            } else {
+               comment = comment.mid(4);
+
+            }
+
+         } else if (comment.startsWith("/**")) {
+            // */ (editor syntax fix),   javadoc comment
+
+            cursor = p->cursors[index+1];
+
+            int len = comment.length() - 5;
+            comment = comment.mid(3, len);
+
+            // remove single *
+            QRegExp reg("\n\\s*\\*");
+            comment.replace(reg, "\n");
+
+            if (javadoc_auto_brief) {
+               isBrief = true;
+            }
+
+         } else if (comment.startsWith("/*!")) {
+            // */ (editor syntax fix),   qt comment
+
+            cursor = p->cursors[index+1];
+
+            int len = comment.length() - 5;
+            comment = comment.mid(3, len);
+
+            if (qt_auto_brief) {
+               isBrief = true;
+            }
+
+         } else if (comment.startsWith("///") || comment.startsWith("//!")  ) {
+            // triple slash or //!  which is always a brief
+
+            comment = comment.mid(3);
+            isBrief = true;
+
+            int tmpIndex = index + 1;
+
+            while (tmpIndex < p->numTokens)  {
+
+               // is this next cursor a comment?
+               CXTokenKind tokenKind = clang_getTokenKind(p->tokens[tmpIndex]);
+
+               if (tokenKind == CXToken_Comment) {
+                  tmpIndex++;
+
+               }  else {
+                  cursor = p->cursors[tmpIndex];
+                  break;
+               }
+            }
+
+         } else  {
+            continue;
+
+         }
+
+         // test the cursor
+         if (documentKind(cursor)) {
+
+            // add the comment to cursor
+            QString name = getCursorSpelling(cursor);
+            QString key  = getCursorUSR(cursor);
+
+            QSharedPointer<Entry> current = s_entryMap.value(key);
+
+            if (current) {
+               if (isBrief && current->brief.isEmpty()) {
+                  QString brief;
+                  QRegExp reg("([^.]*\\.)\\s(.*)");
+
+                  if (reg.exactMatch(comment)) {
+                     brief   = reg.cap(1);
+                     comment = reg.cap(2);
+
+                  } else {
+                     brief   = comment;
+                     comment = "";
+                  }
+
+                  current->brief = brief;
+               }
+
+               current->doc += comment;
+            }
+         }
+      }
+   }
+}
+
+// moves the entries below parent for declarations in headers, each together with its subtree
+static void moveHeaderEntries(QSharedPointer<Entry> parent, QHash<QString, QList<QSharedPointer<Entry>>> &found)
+{
+   QList<QSharedPointer<Entry>> moveList;
+
+   for (const auto &item : parent->children()) {
+      QString name = QDir::cleanPath(item->fileName);
+
+      if (s_headerFiles.contains(name)) {
+         found[name].append(item);
+         moveList.append(item);
+
+      } else {
+         // a nested entry has a qualified name so it can be added to the root of the header
+         moveHeaderEntries(item, found);
+      }
+   }
+
+   for (const auto &item : moveList) {
+      parent->removeSubEntry(item);
+   }
+}
+
+// moves the entries for declarations in headers out of the translation unit, they are added back
+// by ClangParser::addHeaderEntries() when the header is parsed so they belong to the header
+static void claimHeaderEntries(QSharedPointer<Entry> root, const QStringList &includeFiles)
+{
+   QHash<QString, QList<QSharedPointer<Entry>>> found;
+   moveHeaderEntries(root, found);
+
+   for (auto iter = found.begin(); iter != found.end(); ++iter) {
+      // replaces the entries an earlier translation unit found for a header it did not parse
+      s_headerEntries.insert(iter.key(), iter.value());
+   }
+
+   // headers this translation unit did not include can be claimed by a later one
+   for (const auto &item : includeFiles) {
+      QString name = QDir::cleanPath(item);
+
+      if (s_headerFiles.contains(name)) {
+         s_claimedHeaders.insert(name);
+      }
+   }
+
+   s_headerFiles.clear();
+}
+
+// ** entry point
+void ClangParser::start(const QString &fileName, QStringList &includeFiles, QSharedPointer<Entry> root)
+{
+   std::vector<std::string> argList = buildArgList(fileName, p->detectedLang);
+
+   if (root != nullptr && compilationDatabase() != nullptr) {
+      // a header parsed as its own translation unit adds its declarations again
+      s_headerEntries.remove(QDir::cleanPath(fileName));
+
+      // declarations in a header are added by the first translation unit which includes it
+      for (const auto &item : includeFiles) {
+         QString name = QDir::cleanPath(item);
+
+         if (! s_claimedHeaders.contains(name)) {
+            s_headerFiles.insert(name);
+         }
+      }
+   }
+
+   // exclude PCH files, disable diagnostics
+   p->index    = clang_createIndex(false, false);
+
+   p->fileName   = fileName;
+   p->sourcePass = (root == nullptr);
+
+   // provide the input and their dependencies as unsaved files in memory, the buffers are
+   // shared with the other translation units which include the same files
+   ClangBufferCache &bufferCache = ClangBufferCache::instance();
+
+   uint numUnsavedFiles = includeFiles.count() + 1;
+
+   p->numFiles = numUnsavedFiles;
+   p->ufs      = new CXUnsavedFile[numUnsavedFiles];
+
+   p->buffers.reserve(numUnsavedFiles);
+
+   p->buffers.append(bufferCache.buffer(fileName));
+   p->ufs[0] = p->buffers[0]->unsavedFile();
+
+   //
+   uint i = 1;
+   for (auto item : includeFiles) {
+
+      p->fileMapping.insert(item, i);
+
+      p->buffers.append(bufferCache.buffer(item));
+      p->ufs[i] = p->buffers[i]->unsavedFile();
+
+      i++;
+   }
+
+   // data structure, source filename (in argv), cmd line args, num of cmd line args
+   // pass unsaved files(?), num of unsaved files, options flag, trans unit
+
+   std::vector<const char *> argv;
+   for (auto &item : argList) {
+      argv.push_back(item.c_str());
+   }
+
+   int argc = argList.size();
+
+   // parsing on worker threads uses the single parse code path
+   static const bool singleParse = Config::getBool("clang-single-parse") || clangNumThreads() != 1;
+
+   CXErrorCode errorCode = CXError_Failure;
+   bool entriesDone      = false;
+
+   if (singleParse) {
+      if (root != nullptr) {
+         s_current_root = root;
+
+         QSharedPointer<ClangAstJob> job = ClangAstQueue::instance().take(fileName);
+
+         if (job && job->argList == argList) {
+            entriesDone = useAstJob(*job);
+         }
+
+         if (! entriesDone) {
+            entriesDone = parseSingleAst(fileName, argList, p->ufs, numUnsavedFiles);
+         }
+      }
+
+      auto iter = s_savedAstFiles.constFind(fileName);
+
+      if (iter != s_savedAstFiles.constEnd()) {
+         // load the AST saved by the entry pass, no need to parse again
+         errorCode = clang_createTranslationUnit2(p->index, iter.value().toUtf8().constData(), &(p->tu));
+      }
+   }
+
+   if (p->tu == nullptr || errorCode != CXError_Success) {
+      errorCode = clang_parseTranslationUnit2(p->index, 0, &argv[0], argc, p->ufs, numUnsavedFiles,
+                  CXTranslationUnit_DetailedPreprocessingRecord, &(p->tu) );
+   }
+
+   if (p->tu && errorCode == CXError_Success) {
+      // filter out any includes not found by the clang parser
+      determineInputFiles(includeFiles);
+
+      // show any warnings the compiler produced
+      uint diagCnt = clang_getNumDiagnostics(p->tu);
+
+      for (uint i = 0; i != diagCnt; i++) {
+         CXDiagnostic diag = clang_getDiagnostic(p->tu, i);
+         CXString diagMsg  = clang_formatDiagnostic(diag, clang_defaultDiagnosticDisplayOptions());
+
+         err("%s\n", clang_getCString(diagMsg));
+
+         clang_disposeDiagnostic(diag);
+         clang_disposeString(diagMsg);
+      }
+
+      if (diagCnt > 0) {
+         msg("\n");
+      }
+
+      if (root == nullptr || entriesDone)  {
+         // called from writeSouce in fileDef, or the entries were added by parseSingleAst()
+
+      } else {
+         // start adding to entry
+         s_current_root = root;
+
+         argList.erase(argList.end() - 1);
+
+         // pass the list of files to parse
+         clang::tooling::FixedCompilationDatabase options(".", argList);
+
+         // pass the list of files to parse
+         std::vector<std::string> sourceList;
+         sourceList.push_back(fileName.toUtf8().constData());
+
+         // create a new clang tooling instance
+         clang::tooling::ClangTool tool(options, sourceList);
+
+         // run the clang tooling to create a new FrontendAction
+         int result = tool.run(clang::tooling::newFrontendActionFactory<DoxyFrontEnd>().get());
+      }
+
+      // create a source range for the file
+      QFileInfo fi(fileName);
+      CXFile f = clang_getFile(p->tu, fileName.toUtf8());
+
+      CXSourceLocation fileBegin = clang_getLocationForOffset(p->tu, f, 0);
+      CXSourceLocation fileEnd   = clang_getLocationForOffset(p->tu, f, p->ufs[0].Length);
+      CXSourceRange    fileRange = clang_getRange(fileBegin, fileEnd);
+
+      // generate tokens for the tu
+      clang_tokenize(p->tu, fileRange, &p->tokens, &p->numTokens);
+
+      // generate cursors for each token
+      p->cursors = new CXCursor[p->numTokens];
+      clang_annotateTokens(p->tu, p->tokens, p->numTokens, p->cursors);
+
+      p->buildTokenIndex();
+
+      if (root == nullptr)  {
+         // called from writeSouce in fileDef
+         return;
+      }
+
+      attachComments(p);
+   } else {
       p->tokens    = 0;
       p->numTokens = 0;
       p->cursors   = 0;
+
+      err("Clang failed to parse file %s\n", csPrintable(fileName));
+   }
+
+   if (root != nullptr && ! s_headerFiles.isEmpty()) {
+      claimHeaderEntries(root, includeFiles);
    }
+}
+
+void ClangParser::finish()
+{
+   if (p->tu) {
+
+      delete[] p->cursors;
+
+      clang_disposeTokens(p->tu, p->tokens, p->numTokens);
+      clang_disposeTranslationUnit(p->tu);
+      clang_disposeIndex(p->index);
+
+      p->fileMapping.clear();
+      p->clearTokenIndex();
 
-   for (uint i = 0; i < p->numFiles; i++) {
-      free((void *)p->ufs[i].Filename);
+      p->tokens    = 0;
+      p->numTokens = 0;
+      p->cursors   = 0;
    }
 
    delete[] p->ufs;
-   delete[] p->sources;
+   p->buffers.clear();
 
    p->ufs       = 0;
-   p->sources   = 0;
    p->numFiles  = 0;
    p->tu        = 0;
+
+   if (p->sourcePass || ! sourcePassNeeded()) {
+      // no later pass loads the saved AST
+      auto iter = s_savedAstFiles.find(p->fileName);
+
+      if (iter != s_savedAstFiles.end()) {
+         removeAstFile(iter.value());
+         s_savedAstFiles.erase(iter);
+      }
+   }
+}
+
+void ClangParser::prefetch(const QStringList &fileList)
+{
+   if (clangNumThreads() == 1 || fileList.isEmpty()) {
+      return;
+   }
+
+   // the buffers for every C and C++ input file are shared by the workers
+   static QStringList sourceList;
+
+   if (sourceList.isEmpty()) {
+      for (const auto &item : Doxy_Globals::g_inputFiles) {
+         SrcLangExt lang = getLanguageFromFileName(item);
+
+         if (lang == SrcLangExt_Cpp || lang == SrcLangExt_ObjC) {
+            sourceList.append(item);
+         }
+      }
+   }
+
+   // start() detects the language as it goes, follow the same steps for the queued files
+   ClangParser::Private::DetectedLang detectedLang = p->detectedLang;
+   QList<QSharedPointer<ClangAstJob>> jobList;
+
+   for (const auto &item : fileList) {
+      jobList.append(QMakeShared<ClangAstJob>(item, buildArgList(item, detectedLang)));
+   }
+
+   ClangAstQueue::instance().addJobs(jobList, sourceList);
+}
+
+void ClangParser::finishPrefetch()
+{
+   ClangAstQueue::instance().shutDown();
+
+   // every translation unit was parsed, the headers which are left are not input files
+   s_headerEntries.clear();
+
+   releaseBuffers();
+}
+
+void ClangParser::releaseBuffers()
+{
+   ClangBufferCache::instance().clear();
+}
+
+void ClangParser::removeSavedAsts()
+{
+   if (s_savedAstFiles.isEmpty()) {
+      return;
+   }
+
+   for (const auto &item : s_savedAstFiles) {
+      removeAstFile(item);
+   }
+
+   s_savedAstFiles.clear();
+
+   // only removed when empty
+   QDir().rmdir(astDirName());
 }
 
 // filter the files keeping those which where found as include files within the TU
@@ -889,92 +1742,62 @@ QString ClangParser::lookup(uint line, const QString &symbol)
 {
    QString retval;
 
-   if (symbol.isEmpty()) {
+   if (symbol.isEmpty() || line >= uint(p->lineFirstToken.size())) {
       return retval;
    }
 
-   int symLen     = symbol.length();
-   uint tokenLine = p->getCurrentTokenLine();
+   const QByteArray sym = symbol.toUtf8();
+   const char *symData  = sym.constData();
+   const uint symLen    = sym.length();
 
-   while (tokenLine >= line && p->curToken > 0) {
+   const char *text     = p->tokenText.constData();
 
-      if (tokenLine == line) {
-         // already at the right line
+   // only the tokens on the given line are candidates for the start of the symbol
+   for (uint i = p->lineFirstToken[line]; i < p->numTokens && p->tokenLine[i] == line; i++) {
+      uint tl = p->tokenLength[i];
 
-         p->curToken--;                   // linear search to start of the line
-         tokenLine = p->getCurrentTokenLine();
-
-      } else {
-         p->curToken /= 2;                // binary search backward
-         tokenLine = p->getCurrentTokenLine();
+      if (tl > symLen || memcmp(text + p->tokenOffset[i], symData, tl) != 0) {
+         continue;
       }
-   }
-
-   bool found = false;
-
-   while (tokenLine <= line && p->curToken < p->numTokens && !found) {
-      CXString tokenString = clang_getTokenSpelling(p->tu, p->tokens[p->curToken]);
-
-      const char *ts = clang_getCString(tokenString);
-      int tl         = strlen(ts);
-      int startIndex = p->curToken;
-
-      if (tokenLine == line && strncmp(ts, symbol.toUtf8(), tl) == 0) {
-         // found partial match at the correct line
-         int offset = tl;
 
-         while (offset < symLen) {
-            // symbol spans multiple tokens
+      // found partial match at the correct line
+      uint index  = i;
+      uint offset = tl;
 
-            p->curToken++;
+      while (offset < symLen) {
+         // symbol spans multiple tokens
+         ++index;
 
-            if (p->curToken >= p->numTokens) {
-               // end of token stream
-               break;
-            }
-
-            tokenLine = p->getCurrentTokenLine();
-            clang_disposeString(tokenString);
-
-            tokenString = clang_getTokenSpelling(p->tu, p->tokens[p->curToken]);
-            ts = clang_getCString(tokenString);
-            tl = ts ? strlen(ts) : 0;
-
-            // skip over any spaces in the symbol
-            QChar c;
-
-            while (offset < symLen && ((c = symbol[offset]) == ' ' || c == '\t' || c == '\r' || c == '\n')) {
-               offset++;
-            }
+         if (index >= p->numTokens) {
+            // end of token stream
+            break;
+         }
 
-            if (strncmp(ts, symbol.mid(offset).toUtf8(), tl) != 0) {
-               // next token does not match
-               break;
-            }
+         // skip over any spaces in the symbol
+         char c;
 
-            offset += tl;
+         while (offset < symLen && ((c = symData[offset]) == ' ' || c == '\t' || c == '\r' || c == '\n')) {
+            offset++;
          }
 
-         if (offset == symLen) {
-            // symbol matches the token(s)
-            CXCursor c   = p->cursors[p->curToken];
-            CXString usr = clang_getCursorUSR(c);
-
-            retval = clang_getCString(usr);
-            clang_disposeString(usr);
-            found = true;
+         tl = p->tokenLength[index];
 
-         } else {
-            // reset token cursor to start of the search
-            p->curToken = startIndex;
+         if (tl > symLen - offset || memcmp(text + p->tokenOffset[index], symData + offset, tl) != 0) {
+            // next token does not match
+            break;
          }
+
+         offset += tl;
       }
 
-      clang_disposeString(tokenString);
-      p->curToken++;
+      if (offset == symLen) {
+         // symbol matches the token(s)
+         CXString usr = clang_getCursorUSR(p->cursors[index]);
+
+         retval = clang_getCString(usr);
+         clang_disposeString(usr);
 
-      if (p->curToken < p->numTokens) {
-         tokenLine = p->getCurrentTokenLine();
+         break;
       }
    }
 
@@ -1083,6 +1906,7 @@ void ClangParser::switchToFile(const QString &fileName)
       delete[] p->cursors;
 
       clang_disposeTokens(p->tu, p->tokens, p->numTokens);
+      p->clearTokenIndex();
 
       p->tokens    = 0;
       p->numTokens = 0;
@@ -1105,8 +1929,7 @@ void ClangParser::switchToFile(const QString &fileName)
          p->cursors = new CXCursor[p->numTokens];
          clang_annotateTokens(p->tu, p->tokens, p->numTokens, p->cursors);
 
-         p->curLine  = 1;
-         p->curToken = 0;
+         p->buildTokenIndex();
 
       } else {
          err("Clang failed to find input file %s\n", csPrintable(fileName));
@@ -1115,6 +1938,31 @@ void ClangParser::switchToFile(const QString &fileName)
    }
 }
 
+void ClangParser::addHeaderEntries(const QString &fileName, QSharedPointer<Entry> root)
+{
+   auto iter = s_headerEntries.find(QDir::cleanPath(fileName));
+
+   if (iter == s_headerEntries.end()) {
+      return;
+   }
+
+   if (p->tu) {
+      // the tokens of the header were created by switchToFile()
+      attachComments(p);
+   }
+
+   for (const auto &item : iter.value()) {
+      root->addSubEntry(item, root);
+   }
+
+   s_headerEntries.erase(iter);
+}
+
+bool ClangParser::hasCompilationDatabase() const
+{
+   return compilationDatabase() != nullptr;
+}
+
 void ClangParser::writeSources(CodeOutputInterface &ol, QSharedPointer<FileDef> fd)
 {
    static const bool stripCodeComments = Config::getBool("strip-code-comments");
@@ -1163,7 +2011,7 @@ void ClangParser::writeSources(CodeOutputInterface &ol, QSharedPointer<FileDef>
          column++;
       }
 
-      QString text = getTokenSpelling(p->tu, p->tokens[i]);
+      QString text = QString::fromUtf8(p->tokenText.constData() + p->tokenOffset[i], p->tokenLength[i]);
 
       CXCursorKind cursorKind  = clang_getCursorKind(p->cursors[i]);
       CXTokenKind tokenKind    = clang_getTokenKind(p->tokens[i]);
@@ -43,9 +43,30 @@ class ClangParser
    // fileName - name of the file to switch to   
    void switchToFile(const QString &fileName);
 
+   // adds the entries for declarations in an include file which were found while parsing the
+   // translation unit, only used with a compilation database
+   void addHeaderEntries(const QString &fileName, QSharedPointer<Entry> root);
+
+   // true if 'clang-compilation-path' provides the flags for the translation units
+   bool hasCompilationDatabase() const;
+
    // clean up, free resources used in parsing   
    void finish();
 
+   // queue the translation units in fileList to be parsed on worker threads, start() must be
+   // called for these files in the same order, used when clang-num-threads is not one
+   void prefetch(const QStringList &fileList);
+
+   // stops the worker threads and releases any translation units which were not used
+   void finishPrefetch();
+
+   // releases the input buffers shared by the translation units, called at the end of a parse pass
+   void releaseBuffers();
+
+   // removes the AST files which were not loaded by the source browser, called once the
+   // source code pages are written
+   void removeSavedAsts();
+
    // looks for a symbol which should be found at line, returns a clang unique ref to the symbol    
    QString lookup(uint line, const QString &symbol);
 
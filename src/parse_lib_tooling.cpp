@@ -15,6 +15,9 @@
  *
 *************************************************************************/
 
+#include <QDir>
+#include <QHash>
+
 #include <parse_lib_tooling.h>
 
 static QMap<QString, clang::DeclContext *> s_parentNodeMap;
@@ -131,13 +134,42 @@ class DoxyVisitor : public clang::RecursiveASTVisitor<DoxyVisitor>
 
          clang::SourceManager & sourceManager = m_context->getSourceManager();
 
-         if (sourceManager.isWrittenInMainFile(node->getLocation()) || std::string(node->getDeclKindName()) == "TranslationUnit") {
+         if (sourceManager.isWrittenInMainFile(node->getLocation()) || std::string(node->getDeclKindName()) == "TranslationUnit" ||
+               isWrittenInHeaderFile(sourceManager, node->getLocation())) {
             retval = clang::RecursiveASTVisitor<DoxyVisitor>::TraverseDecl(node);
          }
 
          return retval;
       }
 
+      // true if the location is in one of the headers this translation unit adds entries for
+      bool isWrittenInHeaderFile(clang::SourceManager &sourceManager, clang::SourceLocation location) {
+
+         if (s_headerFiles.isEmpty() || location.isInvalid()) {
+            return false;
+         }
+
+         clang::FileID fileId = sourceManager.getFileID(sourceManager.getExpansionLoc(location));
+         uint key = fileId.getHashValue();
+
+         auto iter = m_headerFileIds.constFind(key);
+
+         if (iter != m_headerFileIds.constEnd()) {
+            return iter.value();
+         }
+
+         bool retval = false;
+         const clang::FileEntry *fileEntry = sourceManager.getFileEntryForID(fileId);
+
+         if (fileEntry != nullptr) {
+            retval = s_headerFiles.contains(QDir::cleanPath(toQString(fileEntry->getName())));
+         }
+
+         m_headerFileIds.insert(key, retval);
+
+         return retval;
+      }
+
       virtual bool VisitCXXRecordDecl(clang::CXXRecordDecl *node) {
          // class, struct, union
 
@@ -1041,6 +1073,8 @@ class DoxyVisitor : public clang::RecursiveASTVisitor<DoxyVisitor>
    private:
       clang::ASTContext *m_context;
       clang::PrintingPolicy m_policy;
+
+      QHash<uint, bool> m_headerFileIds;
 };
 
 class DoxyASTConsumer : public clang::ASTConsumer {
@@ -1062,3 +1096,9 @@ class DoxyASTConsumer : public clang::ASTConsumer {
 std::unique_ptr<clang::ASTConsumer> DoxyFrontEnd::CreateASTConsumer(clang::CompilerInstance &compiler, llvm::StringRef file) {
    return std::unique_ptr<clang::ASTConsumer>(new DoxyASTConsumer(&compiler.getASTContext()));
 }
+
+void traverseDoxyAST(clang::ASTContext &context)
+{
+   DoxyASTConsumer consumer(&context);
+   consumer.HandleTranslationUnit(context);
+}
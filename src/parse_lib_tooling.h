@@ -18,7 +18,9 @@
 #ifndef PARSE_LIB_TOOLING_H
 #define PARSE_LIB_TOOLING_H
 
+#include <QSet>
 #include <QSharedPointer>
+#include <QString>
 
 #include <entry.h>
 
@@ -32,10 +34,16 @@
 extern QSharedPointer<Entry> s_current_root;
 extern QMap<QString, QSharedPointer<Entry>> s_entryMap;
 
+// input headers whose declarations are added by the current translation unit
+extern QSet<QString> s_headerFiles;
+
 class DoxyFrontEnd : public clang::ASTFrontendAction
 {
    public:
       std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance &compiler, llvm::StringRef file) override;
 };
 
+// add the entries for a translation unit which was already parsed
+void traverseDoxyAST(clang::ASTContext &context);
+
 #endif
\ No newline at end of file
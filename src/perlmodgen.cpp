@@ -36,69 +36,100 @@
 
 #define PERLOUTPUT_MAX_INDENTATION 40
 
+// output is written to the file in chunks of this size
+static const int s_perlModChunkSize = 64 * 1024;
+
 class PerlModOutputStream
 {
  public:
 
+   // UTF-8 text which was not yet written
    QByteArray m_s;
-   QTextStream *m_t;
 
-   PerlModOutputStream(QTextStream *t = 0) : m_t(t) { }
+   PerlModOutputStream(QFile *f = nullptr) : m_file(f), m_error(false) { }
+
+   ~PerlModOutputStream() {
+      flush();
+   }
 
    void add(char c);
    void add(QChar c);
-   void add(const QString &s);   
+   void add(const char *s);
+   void add(const QString &s);
    void add(int n);
    void add(unsigned int n);
-};
 
+   // writes the buffered text, returns false when the file could not be written
+   bool flush();
+
+ private:
+   inline void checkFlush() {
+      if (m_file != nullptr && m_s.size() >= s_perlModChunkSize) {
+         flush();
+      }
+   }
+
+   QFile *m_file;
+   bool m_error;
+};
 
 void PerlModOutputStream::add(char c)
 {
-   if (m_t != 0) {
-      (*m_t) << c;
-
-   } else {
-      m_s += c;
-   }
+   m_s += c;
+   checkFlush();
 }
 
 void PerlModOutputStream::add(QChar c)
 {
-   if (m_t != 0) {
-      (*m_t) << c;
+   if (c.unicode() < 0x80) {
+      m_s += static_cast<char>(c.unicode());
 
    } else {
-      m_s += c;
+      m_s += QString(c).toUtf8();
    }
+
+   checkFlush();
 }
 
-void PerlModOutputStream::add(const QString &s)
+void PerlModOutputStream::add(const char *s)
 {
-   if (m_t != 0) {
-      (*m_t) << s;
+   m_s += s;
+   checkFlush();
+}
 
-   } else {
-      m_s += s;
-   }
+void PerlModOutputStream::add(const QString &s)
+{
+   m_s += s.toUtf8();
+   checkFlush();
 }
 
 void PerlModOutputStream::add(int n)
 {
-   if (m_t != 0) {
-      (*m_t) << n;
-   } else {
-      m_s += n;
-   }
+   m_s += QByteArray::number(n);
+   checkFlush();
 }
 
 void PerlModOutputStream::add(unsigned int n)
 {
-   if (m_t != 0) {
-      (*m_t) << n;
-   } else {
-      m_s += n;
+   m_s += QByteArray::number(n);
+   checkFlush();
+}
+
+bool PerlModOutputStream::flush()
+{
+   if (m_file == nullptr) {
+      return true;
    }
+
+   if (! m_s.isEmpty()) {
+      if (m_file->write(m_s) != m_s.size()) {
+         m_error = true;
+      }
+
+      m_s.clear();
+   }
+
+   return ! m_error;
 }
 
 class PerlModOutput
@@ -118,6 +149,13 @@ class PerlModOutput
       m_stream = os;
    }
 
+   // starts a new document, used when every compound is written to its own file
+   inline void reset() {
+      m_indentation = 0;
+      m_blockstart  = true;
+      m_spaces[0]   = 0;
+   }
+
    inline PerlModOutput &openSave() {
       iopenSave();
       return *this;
@@ -255,7 +293,7 @@ void PerlModOutput::iopenSave()
 
 void PerlModOutput::icloseSave(QString &s)
 {
-   s = m_stream->m_s;
+   s = QString::fromUtf8(m_stream->m_s);
    delete m_stream;
    m_stream = m_saved.pop();
 }
@@ -1698,11 +1736,15 @@ class PerlModGenerator
    QString pathDoxyLatexPDF;
    QString pathDoxyStructureTex;
    QString pathDoxyDocsPM;
+   QString pathDoxyDocsDir;
    QString pathDoxyLatexPL;
    QString pathDoxyLatexStructurePL;
    QString pathDoxyRules;
    QString pathMakefile;
 
+   // buffer for one compound when 'perl-split-output' is set
+   PerlModOutputStream m_compoundStream;
+
    inline PerlModGenerator(bool pretty) : m_output(pretty) { }
 
    void generatePerlModForMember(QSharedPointer<MemberDef> md, QSharedPointer<Definition> def);
@@ -1727,6 +1769,10 @@ class PerlModGenerator
    bool generateDoxyRules();
    bool generateMakefile();
    bool generatePerlModOutput();
+   bool generatePerlModSplitOutput();
+
+   void beginCompoundFile();
+   bool endCompoundFile(const QString &kind, const QString &id, QStringList &index);
 
    void generate();
 };
@@ -2390,18 +2436,17 @@ bool PerlModGenerator::generatePerlModOutput()
       return false;
    }
 
-   QTextStream outputTextStream(&outputFile);
-   PerlModOutputStream outputStream(&outputTextStream);
+   PerlModOutputStream outputStream(&outputFile);
    m_output.setPerlModOutputStream(&outputStream);
    m_output.add("$doxydocs=").openHash();
 
-   m_output.openList("classes");  
+   m_output.openList("classes");
    for (auto cd : Doxy_Globals::classSDict) {
       generatePerlModForClass(cd);
    }
    m_output.closeList();
 
-   m_output.openList("namespaces");  
+   m_output.openList("namespaces");
    for (auto &nd : Doxy_Globals::namespaceSDict) {
       generatePerlModForNamespace(nd);
    }
@@ -2422,7 +2467,7 @@ bool PerlModGenerator::generatePerlModOutput()
    m_output.closeList();
 
 
-   m_output.openList("pages");  
+   m_output.openList("pages");
    for (auto &pd : Doxy_Globals::pageSDict) {
       generatePerlModForPage(pd);
    }
@@ -2435,6 +2480,197 @@ bool PerlModGenerator::generatePerlModOutput()
 
 
    m_output.closeHash().add(";\n1;\n");
+   m_output.setPerlModOutputStream(nullptr);
+
+   if (! outputStream.flush()) {
+      err("Unable to write file %s\n", csPrintable(pathDoxyDocsPM));
+      return false;
+   }
+
+   return true;
+}
+
+static QString perlModQuoted(const QString &str)
+{
+   QString retval = "'";
+
+   for (auto c : str) {
+      if (c == '\'' || c == '\\') {
+         retval += '\\';
+      }
+
+      retval += c;
+   }
+
+   retval += '\'';
+
+   return retval;
+}
+
+void PerlModGenerator::beginCompoundFile()
+{
+   m_compoundStream.m_s.clear();
+
+   m_output.reset();
+   m_output.setPerlModOutputStream(&m_compoundStream);
+}
+
+bool PerlModGenerator::endCompoundFile(const QString &kind, const QString &id, QStringList &index)
+{
+   m_output.setPerlModOutputStream(nullptr);
+
+   if (m_compoundStream.m_s.isEmpty()) {
+      // compound was skipped
+      return true;
+   }
+
+   QString fileName = pathDoxyDocsDir + "/" + kind + "/" + id + ".pm";
+   QFile f;
+
+   if (! createOutputFile(f, fileName)) {
+      return false;
+   }
+
+   QByteArray data = "my $compound =" + m_compoundStream.m_s + ";\n\n$compound;\n";
+   m_compoundStream.m_s.clear();
+
+   if (f.write(data) != data.size()) {
+      err("Unable to write file %s\n", csPrintable(fileName));
+      return false;
+   }
+
+   index.append(id);
+
+   return true;
+}
+
+bool PerlModGenerator::generatePerlModSplitOutput()
+{
+   // every compound is written to DoxyDocs/<kind>/<id>.pm and DoxyDocs.pm only contains the
+   // list of compounds, a consumer can load all of them or only the ones it needs
+
+   static const QStringList kinds = { "classes", "namespaces", "files", "groups", "pages" };
+
+   QDir docsDir;
+
+   for (const auto &kind : kinds) {
+      if (! docsDir.mkpath(pathDoxyDocsDir + "/" + kind)) {
+         err("Unable to create directory %s\n", csPrintable(pathDoxyDocsDir + "/" + kind));
+         return false;
+      }
+   }
+
+   QHash<QString, QStringList> index;
+   bool ok = true;
+
+   for (auto cd : Doxy_Globals::classSDict) {
+      beginCompoundFile();
+      generatePerlModForClass(cd);
+      ok = endCompoundFile("classes", cd->getOutputFileBase(), index["classes"]) && ok;
+   }
+
+   for (auto &nd : Doxy_Globals::namespaceSDict) {
+      beginCompoundFile();
+      generatePerlModForNamespace(nd);
+      ok = endCompoundFile("namespaces", nd->getOutputFileBase(), index["namespaces"]) && ok;
+   }
+
+   for (auto &fn : Doxy_Globals::inputNameList) {
+      for (auto fd : *fn)  {
+         beginCompoundFile();
+         generatePerlModForFile(fd);
+         ok = endCompoundFile("files", fd->getOutputFileBase(), index["files"]) && ok;
+      }
+   }
+
+   for (auto gd : Doxy_Globals::groupSDict) {
+      beginCompoundFile();
+      generatePerlModForGroup(gd);
+      ok = endCompoundFile("groups", gd->getOutputFileBase(), index["groups"]) && ok;
+   }
+
+   for (auto &pd : Doxy_Globals::pageSDict) {
+      beginCompoundFile();
+      generatePerlModForPage(pd);
+      ok = endCompoundFile("pages", pd->getOutputFileBase(), index["pages"]) && ok;
+   }
+
+   if (Doxy_Globals::mainPage) {
+      beginCompoundFile();
+      generatePerlModForPage(Doxy_Globals::mainPage);
+      ok = endCompoundFile("pages", Doxy_Globals::mainPage->getOutputFileBase(), index["pages"]) && ok;
+   }
+
+   if (! ok) {
+      return false;
+   }
+
+   // loader
+   QFile outputFile;
+   if (! createOutputFile(outputFile, pathDoxyDocsPM)) {
+      return false;
+   }
+
+   PerlModOutputStream outputStream(&outputFile);
+
+   outputStream.add("package DoxyDocs;\n"
+                    "\n"
+                    "use File::Basename;\n"
+                    "use File::Spec;\n"
+                    "\n"
+                    "my $dir = File::Spec->catdir(dirname(File::Spec->rel2abs(__FILE__)), 'DoxyDocs');\n"
+                    "\n"
+                    "our @kinds = ('classes', 'namespaces', 'files', 'groups', 'pages');\n"
+                    "\n"
+                    "our %index = (\n");
+
+   for (const auto &kind : kinds) {
+      outputStream.add("  " + kind + " => [");
+
+      bool first = true;
+
+      for (const auto &id : index[kind]) {
+         outputStream.add(first ? "\n    " : ",\n    ");
+         outputStream.add(perlModQuoted(id));
+
+         first = false;
+      }
+
+      outputStream.add(first ? "],\n" : "\n  ],\n");
+   }
+
+   outputStream.add(");\n"
+                    "\n"
+                    "# returns the documentation of one compound, for example compound('classes', 'class_foo')\n"
+                    "sub compound($$) {\n"
+                    "  my ($kind, $id) = @_;\n"
+                    "  my $file = File::Spec->catfile($dir, $kind, $id . '.pm');\n"
+                    "  my $data = do $file;\n"
+                    "  die \"Unable to load $file: \" . ($@ || $!) . \"\\n\" unless defined $data;\n"
+                    "  return $data;\n"
+                    "}\n"
+                    "\n"
+                    "# returns the documentation of all compounds in the layout of the single file output\n"
+                    "sub load_all() {\n"
+                    "  my %docs;\n"
+                    "  foreach my $kind (@kinds) {\n"
+                    "    $docs{$kind} = [ map { compound($kind, $_) } @{$index{$kind}} ];\n"
+                    "  }\n"
+                    "  return \\%docs;\n"
+                    "}\n"
+                    "\n"
+                    "# 'use DoxyDocs;' sets $doxydocs like the single file output, 'use DoxyDocs qw(:lazy);' loads nothing\n"
+                    "sub import {\n"
+                    "  my ($package, @args) = @_;\n"
+                    "  $main::doxydocs = load_all() unless grep { $_ eq ':lazy' } @args;\n"
+                    "}\n"
+                    "\n"
+                    "1;\n");
+
+   if (! outputStream.flush()) {
+      err("Unable to write file %s\n", csPrintable(pathDoxyDocsPM));
+      return false;
+   }
 
    return true;
 }
@@ -2667,7 +2903,8 @@ bool PerlModGenerator::generateDoxyRules()
    }
 
    bool perlmodLatex = Config::getBool("perl-latex");
-   QString prefix = Config::getString("perl-prefix");
+   bool splitOutput  = Config::getBool("perl-split-output");
+   QString prefix    = Config::getString("perl-prefix");
 
    QTextStream doxyRulesStream(&doxyRules);
    doxyRulesStream <<
@@ -2677,6 +2914,10 @@ bool PerlModGenerator::generateDoxyRules()
                    prefix << "DOXYSTRUCTURE_PM = " << pathDoxyStructurePM << "\n" <<
                    prefix << "DOXYRULES = " << pathDoxyRules << "\n";
 
+   if (splitOutput)
+      doxyRulesStream <<
+                      prefix << "DOXYDOCS_DIR = " << pathDoxyDocsDir << "\n";
+
    if (perlmodLatex)
       doxyRulesStream <<
                       prefix << "DOXYLATEX_PL = " << pathDoxyLatexPL << "\n" <<
@@ -2707,6 +2948,11 @@ bool PerlModGenerator::generateDoxyRules()
                       "\t$(" << prefix << "DOXYLATEX_PDF) \\\n"
                       "\t$(" << prefix << "DOXYLATEX_DVI) \\\n"
                       "\t$(addprefix $(" << prefix << "DOXYLATEX_TEX:tex=),out aux log)";
+
+   if (splitOutput)
+      doxyRulesStream <<
+                      "\n\trm -rf $(" << prefix << "DOXYDOCS_DIR)";
+
    doxyRulesStream << "\n\n";
 
    doxyRulesStream <<
@@ -3160,6 +3406,7 @@ void PerlModGenerator::generate()
    QString perlModAbsPath = perlModDir.absolutePath();
 
    pathDoxyDocsPM         = perlModAbsPath + "/DoxyDocs.pm";
+   pathDoxyDocsDir        = perlModAbsPath + "/DoxyDocs";
    pathDoxyStructurePM    = perlModAbsPath + "/DoxyStructure.pm";
    pathMakefile           = perlModAbsPath + "/Makefile";
    pathDoxyRules          = perlModAbsPath + "/doxyrules.make";
@@ -3175,7 +3422,15 @@ void PerlModGenerator::generate()
       pathDoxyLatexStructurePL = perlModAbsPath + "/doxylatex-structure.pl";
    }
 
-   if (! (generatePerlModOutput() && generateDoxyStructurePM() && generateMakefile() && generateDoxyRules())) { 
+   bool docsOk;
+
+   if (Config::getBool("perl-split-output")) {
+      docsOk = generatePerlModSplitOutput();
+   } else {
+      docsOk = generatePerlModOutput();
+   }
+
+   if (! (docsOk && generateDoxyStructurePM() && generateMakefile() && generateDoxyRules())) {
       return;
    }
 
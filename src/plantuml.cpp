@@ -16,15 +16,20 @@
 *************************************************************************/
 
 #include <QDir>
+#include <QMutexLocker>
 
 #include <plantuml.h>
 
 #include <config.h>
+#include <extcmd.h>
 #include <portable.h>
 #include <message.h>
 
 static const int maxCmdLine = 40960;
 
+// diagrams per batch, larger batches start fewer JVMs while smaller ones start rendering sooner
+static const int maxBatchFiles = 32;
+
 QString writePlantUMLSource(const QString &outDir, const QString &fileName, const QString &content)
 {
    QString baseName;
@@ -64,74 +69,189 @@ QString writePlantUMLSource(const QString &outDir, const QString &fileName, cons
 
 void generatePlantUMLOutput(const QString &baseName, const QString &outDir, PlantUMLOutputFormat format)
 {
-   static QString plantumlJarPath         = Config::getString("plantuml-jar-path"); 
+   static const bool plantumlBatch = Config::getBool("plantuml-batch");
+
+   if (plantumlBatch) {
+      // rendered in batches by PlantUMLManager
+      PlantUMLManager::instance()->insert(baseName, outDir, format);
+
+   } else {
+      portable_sysTimerStart();
+      generatePlantUMLOutput(QStringList() << baseName, outDir, format);
+      portable_sysTimerStop();
+
+   }
+}
+
+static QString plantUMLArgs(const QStringList &baseNames, const QString &outDir, PlantUMLOutputFormat format)
+{
+   static QString plantumlJarPath         = Config::getString("plantuml-jar-path");
    static QStringList pumlIncludePathList = Config::getList("plantuml-inc-path");
 
-   QString pumlExe  = "java";
    QString pumlArgs = "";
-   
-   if (! pumlIncludePathList.isEmpty()) {                   
+
+   if (! pumlIncludePathList.isEmpty()) {
       pumlArgs += "-Dplantuml.include.path=\"";
       pumlArgs += pumlIncludePathList.join( QChar(portable_pathListSeparator()) );
-      pumlArgs += "\" ";     
+      pumlArgs += "\" ";
    }
-   
+
    pumlArgs += "-Djava.awt.headless=true -jar \"" + plantumlJarPath + "plantuml.jar\" ";
    pumlArgs += "-o \"";
    pumlArgs += outDir;
    pumlArgs += "\" ";
 
-   QString extension;
-
    switch (format) {
       case PUML_BITMAP:
          pumlArgs += "-tpng";
-         extension = ".png";
          break;
 
       case PUML_EPS:
          pumlArgs += "-teps";
-         extension = ".eps";
          break;
 
       case PUML_SVG:
          pumlArgs += "-tsvg";
-         extension = ".svg";
          break;
    }
 
-   pumlArgs += " \"";
-   pumlArgs += baseName;
-   pumlArgs += ".pu\" ";
-   pumlArgs += "-charset UTF-8 ";
+   for (const auto &baseName : baseNames) {
+      pumlArgs += " \"";
+      pumlArgs += baseName;
+      pumlArgs += ".pu\"";
+   }
 
-   int exitCode;
-   
-   msg("Running PlantUML on generated file %s.pu\n", qPrintable(baseName));
-   portable_sysTimerStart();
+   pumlArgs += " -charset UTF-8 ";
+
+   return pumlArgs;
+}
+
+static void reportPlantUMLStart(const QStringList &baseNames)
+{
+   if (baseNames.count() == 1) {
+      msg("Running PlantUML on generated file %s.pu\n", csPrintable(baseNames.first()));
+   } else {
+      msg("Running PlantUML on %d generated files\n", baseNames.count());
+   }
+}
+
+// reports the result of plantuml and runs the steps which need the generated images
+static void finishPlantUMLOutput(const QStringList &baseNames, PlantUMLOutputFormat format, int exitCode)
+{
+   static QString plantumlJarPath = Config::getString("plantuml-jar-path");
 
-   if ((exitCode = portable_system(pumlExe, pumlArgs, true)) != 0) {
+   if (exitCode != 0) {
       err("Unable to run PlantUML, verify the command 'java -jar \"%splantuml.jar\" -h' works from "
-         "the command line. Exit code: %d\n", qPrintable(plantumlJarPath), exitCode);
+         "the command line. Exit code: %d\n", csPrintable(plantumlJarPath), exitCode);
 
    } else if (Config::getBool("dot-cleanup")) {
-      QFile(baseName + ".pu").remove();
-
+      for (const auto &baseName : baseNames) {
+         QFile(baseName + ".pu").remove();
+      }
    }
 
-   portable_sysTimerStop();
    if ( (format == PUML_EPS) && (Config::getBool("latex-pdf")) ) {
 
-      QString epstopdfArgs;
-      epstopdfArgs = QString("\"%1.eps\" --outfile=\"%2.pdf\"").arg(baseName).arg(baseName);
-
-      portable_sysTimerStart();
+      for (const auto &baseName : baseNames) {
+         QString epstopdfArgs;
+         epstopdfArgs = QString("\"%1.eps\" --outfile=\"%2.pdf\"").arg(baseName).arg(baseName);
 
-      if ((exitCode = portable_system("epstopdf", epstopdfArgs)) != 0) {
-         err("Unable to run epstopdf, verify your TeX installation, exit code: %d\n", exitCode);
+         if ((exitCode = ExtCmdManager::instance()->run("epstopdf", "epstopdf", epstopdfArgs)) != 0) {
+            err("Unable to run epstopdf, verify your TeX installation, exit code: %d\n", exitCode);
+         }
       }
+   }
+}
 
-      portable_sysTimerStop();
+void generatePlantUMLOutput(const QStringList &baseNames, const QString &outDir, PlantUMLOutputFormat format)
+{
+   if (baseNames.isEmpty()) {
+      return;
+   }
+
+   reportPlantUMLStart(baseNames);
+
+   int exitCode = ExtCmdManager::instance()->run("plantuml", "java", plantUMLArgs(baseNames, outDir, format), true);
+   finishPlantUMLOutput(baseNames, format, exitCode);
+}
+
+PlantUMLManager *PlantUMLManager::instance()
+{
+   static PlantUMLManager retval;
+   return &retval;
+}
+
+PlantUMLManager::PlantUMLManager()
+   : m_finished(false)
+{
+}
+
+void PlantUMLManager::insert(const QString &baseName, const QString &outDir, PlantUMLOutputFormat format)
+{
+   QMutexLocker locker(&m_mutex);
+
+   if (m_finished) {
+      // run() was already called, nothing would render a new batch
+      locker.unlock();
+      generatePlantUMLOutput(QStringList() << baseName, outDir, format);
+
+      return;
+   }
+
+   QPair<QString, int> key(outDir, format);
+
+   auto iter = m_pending.find(key);
+
+   if (iter == m_pending.end()) {
+      PlantUMLBatch batch;
+      batch.outDir = outDir;
+      batch.format = format;
+
+      iter = m_pending.insert(key, batch);
+   }
+
+   PlantUMLBatch &batch = iter.value();
+
+   batch.baseNames.append(baseName);
+   batch.length += baseName.length() + 6;
+
+   if (batch.length >= maxCmdLine || batch.baseNames.count() >= maxBatchFiles) {
+      // start rendering while the documentation is generated
+      submit(batch);
+      m_pending.erase(iter);
    }
 }
 
+void PlantUMLManager::submit(PlantUMLBatch &batch)
+{
+   // called with m_mutex locked
+   reportPlantUMLStart(batch.baseNames);
+
+   batch.job = ExtCmdManager::instance()->submit("plantuml", "java",
+                  plantUMLArgs(batch.baseNames, batch.outDir, batch.format), true);
+
+   m_submitted.append(batch);
+}
+
+void PlantUMLManager::run()
+{
+   QMutexLocker locker(&m_mutex);
+
+   portable_sysTimerStart();
+
+   for (auto &batch : m_pending) {
+      submit(batch);
+   }
+
+   m_pending.clear();
+
+   for (const auto &batch : m_submitted) {
+      int exitCode = ExtCmdManager::instance()->wait(batch.job);
+      finishPlantUMLOutput(batch.baseNames, batch.format, exitCode);
+   }
+
+   m_submitted.clear();
+   m_finished = true;
+
+   portable_sysTimerStop();
+}
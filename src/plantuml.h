@@ -18,11 +18,65 @@
 #ifndef PLANTUML_H
 #define PLANTUML_H
 
-class QByteArray;
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <QSharedPointer>
+#include <QStringList>
+
+class ExtCmdJob;
 
 /** Plant UML output image formats */
 enum PlantUMLOutputFormat { PUML_BITMAP, PUML_EPS, PUML_SVG };
 
+/** A set of PlantUML sources rendered by one invocation of plantuml.jar */
+struct PlantUMLBatch {
+   PlantUMLBatch()
+      : format(PUML_BITMAP), length(0)
+   {}
+
+   QString outDir;
+   PlantUMLOutputFormat format;
+   QStringList baseNames;
+
+   // length of the file names on the command line
+   int length;
+
+   QSharedPointer<ExtCmdJob> job;
+};
+
+/** Singleton which collects PlantUML sources and renders them in batches
+ *
+ *  Starting a JVM for every diagram is expensive. When 'plantuml-batch' is set
+ *  generatePlantUMLOutput() only registers the file, sources for the same output
+ *  directory and format are passed to a single plantuml invocation. A batch is
+ *  submitted to ExtCmdManager as soon as it is full so the diagrams are rendered
+ *  while the documentation is generated.
+ */
+class PlantUMLManager
+{
+ public:
+   static PlantUMLManager *instance();
+
+   void insert(const QString &baseName, const QString &outDir, PlantUMLOutputFormat format);
+
+   /** Submits the remaining batches and waits until every diagram is rendered, diagrams
+    *  inserted after this call are rendered immediately */
+   void run();
+
+ private:
+   PlantUMLManager();
+
+   void submit(PlantUMLBatch &batch);
+
+   QMap<QPair<QString, int>, PlantUMLBatch> m_pending;
+   QList<PlantUMLBatch> m_submitted;
+
+   QMutex m_mutex;
+   bool   m_finished;
+};
+
 /** Write a PlantUML compatible file.
  *  @param[in] outDir   the output directory to write the file to.
  *  @param[in] fileName the name of the file. If empty a name will be chosen automatically.
@@ -38,5 +92,12 @@ QString writePlantUMLSource(const QString &outDir, const QString &fileName, cons
  */
 void generatePlantUMLOutput(const QString &baseName, const QString &outDir, PlantUMLOutputFormat format);
 
+/** Convert a list of PlantUML files to images using one invocation of plantuml.
+ *  @param[in] baseNames the names of the generated files (as returned by writePlantUMLSource())
+ *  @param[in] outDir    the directory to write the resulting images into.
+ *  @param[in] format    the image format to generate.
+ */
+void generatePlantUMLOutput(const QStringList &baseNames, const QString &outDir, PlantUMLOutputFormat format);
+
 #endif
 
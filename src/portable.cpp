@@ -47,7 +47,7 @@ extern char **environ;
 static double g_sysElapsedTime;
 static QTime  g_time;
 
-int portable_system(const QString &command, const QString &args, bool commandHasConsole)
+int portable_system(const QString &command, const QString &args, bool commandHasConsole, const QString &workingDir)
 {
    QString fullCmd = command.trimmed();
 
@@ -77,6 +77,10 @@ int portable_system(const QString &command, const QString &args, bool commandHas
    if (pid == 0) {
       QByteArray tempCmd = fullCmd.toUtf8();
 
+      if (! workingDir.isEmpty() && chdir(workingDir.toUtf8().constData()) != 0) {
+         exit(127);
+      }
+
       const char *argv[4];
 
       argv[0] = "sh";
@@ -107,11 +111,18 @@ int portable_system(const QString &command, const QString &args, bool commandHas
    // Windows
 
    if (commandHasConsole) {
+
+      if (! workingDir.isEmpty()) {
+         fullCmd = "cd /d \"" + QDir::toNativeSeparators(workingDir) + "\" && " + fullCmd;
+      }
+
       return system(fullCmd.toUtf8());
 
    } else {               
       CoInitializeEx(NULL, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
 
+      QString nativeDir = QDir::toNativeSeparators(workingDir);
+
       SHELLEXECUTEINFOW sInfo = {
          sizeof(SHELLEXECUTEINFOW),   
 
@@ -122,7 +133,7 @@ int portable_system(const QString &command, const QString &args, bool commandHas
          NULL,                       /* action to perform: open */
          (LPCWSTR)command.utf16(),   /* file to execute */
          (LPCWSTR)args.utf16(),      /* argument list */
-         NULL,                       /* use current working dir */
+         nativeDir.isEmpty() ? NULL : (LPCWSTR)nativeDir.utf16(),   /* working dir */
          SW_HIDE,                    /* minimize on start-up */
          0,                          /* application instance handle */
          NULL,                       /* ignored: id list */
@@ -34,7 +34,8 @@ typedef off_t portable_off_t;
  *  @brief Portable versions of functions that are platform dependent.
  */
 
-int            portable_system(const QString &command, const QString &args, bool commandHasConsole = true);
+int            portable_system(const QString &command, const QString &args, bool commandHasConsole = true,
+                  const QString &workingDir = QString());
 uint           portable_pid();
 QString        portable_getenv(const QString &variable);
 void           portable_setenv(const QString &variable, const QString &value);
@@ -0,0 +1,253 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#include <QFile>
+#include <QMutexLocker>
+#include <QTextStream>
+
+#if ! defined(_WIN32) || defined(__CYGWIN__)
+#include <sys/resource.h>
+#endif
+
+#include <profiler.h>
+
+static QString jsonEscape(const QString &str)
+{
+   QString retval;
+
+   for (auto c : str) {
+
+      switch (c.unicode()) {
+         case '"':
+            retval += "\\\"";
+            break;
+
+         case '\\':
+            retval += "\\\\";
+            break;
+
+         case '\n':
+            retval += "\\n";
+            break;
+
+         case '\t':
+            retval += "\\t";
+            break;
+
+         default:
+            if (c.unicode() < 0x20) {
+               retval += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+            } else {
+               retval += c;
+            }
+            break;
+      }
+   }
+
+   return retval;
+}
+
+static QString csvEscape(const QString &str)
+{
+   QString retval = str;
+   retval.replace('"', "\"\"");
+
+   return '"' + retval + '"';
+}
+
+Profiler &Profiler::instance()
+{
+   static Profiler retval;
+   return retval;
+}
+
+Profiler::Profiler()
+   : m_enabled(false), m_waitTime(0)
+{
+   m_timer.start();
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+   QMutexLocker locker(&m_mutex);
+
+   if (m_threads.isEmpty()) {
+      m_threads.insert(QThread::currentThread(), 0);
+   }
+
+   m_enabled = enabled;
+}
+
+int &Profiler::scopeDepth()
+{
+   static thread_local int depth = 0;
+   return depth;
+}
+
+qint64 Profiler::peakRss()
+{
+#if ! defined(_WIN32) || defined(__CYGWIN__)
+   struct rusage usage;
+
+   if (getrusage(RUSAGE_SELF, &usage) != 0) {
+      return 0;
+   }
+
+#if defined(__APPLE__)
+   return usage.ru_maxrss;
+#else
+   return qint64(usage.ru_maxrss) * 1024;
+#endif
+
+#else
+   return 0;
+
+#endif
+}
+
+int Profiler::threadIndex()
+{
+   // called with m_mutex locked
+   QThread *thread = QThread::currentThread();
+
+   auto iter = m_threads.find(thread);
+
+   if (iter == m_threads.end()) {
+      iter = m_threads.insert(thread, m_threads.count());
+   }
+
+   return iter.value();
+}
+
+void Profiler::addEvent(const QString &name, const char *category, qint64 start, qint64 duration,
+                  int depth, qint64 peakRss)
+{
+   if (! m_enabled) {
+      return;
+   }
+
+   QMutexLocker locker(&m_mutex);
+
+   Event event;
+   event.name     = name.trimmed();
+   event.category = category;
+   event.start    = start;
+   event.duration = duration;
+   event.peakRss  = peakRss;
+   event.depth    = depth;
+   event.thread   = threadIndex();
+
+   m_events.append(std::move(event));
+}
+
+void Profiler::addWaitTime(qint64 duration)
+{
+   QMutexLocker locker(&m_mutex);
+   m_waitTime += duration;
+}
+
+qint64 Profiler::waitTime() const
+{
+   QMutexLocker locker(&m_mutex);
+   return m_waitTime;
+}
+
+bool Profiler::write(const QString &fileName) const
+{
+   if (fileName.endsWith(".csv", Qt::CaseInsensitive)) {
+      return writeCsv(fileName);
+   }
+
+   return writeTrace(fileName);
+}
+
+bool Profiler::writeTrace(const QString &fileName) const
+{
+   QFile f(fileName);
+
+   if (! f.open(QIODevice::WriteOnly)) {
+      return false;
+   }
+
+   QMutexLocker locker(&m_mutex);
+
+   QTextStream t(&f);
+   t.setCodec("UTF-8");
+
+   t << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+   for (int i = 0; i < m_threads.count(); i++) {
+      t << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i
+        << ",\"args\":{\"name\":\"" << (i == 0 ? QString("main") : QString("worker %1").arg(i)) << "\"}},\n";
+   }
+
+   bool first = true;
+
+   for (const auto &event : m_events) {
+      if (! first) {
+         t << ",\n";
+      }
+
+      first = false;
+
+      t << "{\"name\":\"" << jsonEscape(event.name) << "\",\"cat\":\"" << event.category
+        << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+        << ",\"ts\":" << event.start << ",\"dur\":" << event.duration
+        << ",\"args\":{\"depth\":" << event.depth;
+
+      if (event.peakRss >= 0) {
+         t << ",\"peak_rss\":" << event.peakRss;
+      }
+
+      t << "}}";
+   }
+
+   t << "\n]}\n";
+   t.flush();
+
+   return f.error() == QFile::NoError;
+}
+
+bool Profiler::writeCsv(const QString &fileName) const
+{
+   QFile f(fileName);
+
+   if (! f.open(QIODevice::WriteOnly)) {
+      return false;
+   }
+
+   QMutexLocker locker(&m_mutex);
+
+   QTextStream t(&f);
+   t.setCodec("UTF-8");
+
+   t << "category,name,thread,depth,start_us,duration_us,peak_rss\n";
+
+   for (const auto &event : m_events) {
+      t << event.category << "," << csvEscape(event.name) << "," << event.thread << ","
+        << event.depth << "," << event.start << "," << event.duration << ",";
+
+      if (event.peakRss >= 0) {
+         t << event.peakRss;
+      }
+
+      t << "\n";
+   }
+
+   t.flush();
+
+   return f.error() == QFile::NoError;
+}
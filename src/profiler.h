@@ -0,0 +1,133 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+/** @brief Collects timed events for a profile of a run
+ *
+ *  Events are recorded by the phases of Statistics, by ProfileScope and by the external tool
+ *  manager. Recording is enabled when 'profile-output' is set or the time debug flag is given,
+ *  otherwise only the total time spent waiting for external tools is kept. The profile is
+ *  written in the Chrome trace event format or as CSV when the file name ends with ".csv".
+ *  All methods are thread safe.
+ */
+class Profiler
+{
+ public:
+   static Profiler &instance();
+
+   /** Enables recording of events, the calling thread is shown as the main thread */
+   void setEnabled(bool enabled);
+
+   bool isEnabled() const {
+      return m_enabled;
+   }
+
+   /** Microseconds since the profiler was created */
+   qint64 now() const {
+      return m_timer.nsecsElapsed() / 1000;
+   }
+
+   /** Records an event which started at \a start and took \a duration microseconds, \a peakRss
+    *  is the peak resident set size at the end of the event or -1 when it was not measured */
+   void addEvent(const QString &name, const char *category, qint64 start, qint64 duration,
+                  int depth, qint64 peakRss = -1);
+
+   /** Adds \a duration microseconds to the time spent waiting for external tools */
+   void addWaitTime(qint64 duration);
+
+   /** Total microseconds spent waiting for external tools, summed over all threads */
+   qint64 waitTime() const;
+
+   /** Writes the recorded events, returns false when the file can not be written */
+   bool write(const QString &fileName) const;
+
+   /** Peak resident set size of the process in bytes, 0 when not available */
+   static qint64 peakRss();
+
+   /** Current nesting depth of ProfileScope for the calling thread */
+   static int &scopeDepth();
+
+ private:
+   Profiler();
+
+   struct Event {
+      QString     name;
+      const char *category;
+      qint64      start;
+      qint64      duration;
+      qint64      peakRss;
+      int         depth;
+      int         thread;
+   };
+
+   int threadIndex();
+
+   bool writeTrace(const QString &fileName) const;
+   bool writeCsv(const QString &fileName) const;
+
+   QElapsedTimer m_timer;
+   bool          m_enabled;
+
+   qint64 m_waitTime;
+
+   QVector<Event> m_events;
+   QHash<QThread *, int> m_threads;
+
+   mutable QMutex m_mutex;
+};
+
+/** Records the time from construction to destruction as one nested event */
+class ProfileScope
+{
+ public:
+   ProfileScope(const char *category, const QString &name)
+      : m_category(category), m_start(-1)
+   {
+      Profiler &profiler = Profiler::instance();
+
+      if (profiler.isEnabled()) {
+         m_name  = name;
+         m_start = profiler.now();
+
+         Profiler::scopeDepth()++;
+      }
+   }
+
+   ~ProfileScope() {
+      if (m_start >= 0) {
+         Profiler &profiler = Profiler::instance();
+
+         int depth = --Profiler::scopeDepth();
+         profiler.addEvent(m_name, m_category, m_start, profiler.now() - m_start, depth);
+      }
+   }
+
+ private:
+   QString     m_name;
+   const char *m_category;
+   qint64      m_start;
+};
+
+#endif
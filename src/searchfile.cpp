@@ -0,0 +1,550 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#include <QFile>
+#include <QSet>
+#include <QStringList>
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#if ! defined(_WIN32) || defined(__CYGWIN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <searchfile.h>
+
+#include <config.h>
+#include <message.h>
+#include <portable.h>
+
+static const int s_headerSize    = 32;
+static const int s_termEntrySize = 16;
+static const int s_urlEntrySize  = 16;
+static const int s_version       = 1;
+
+static void appendInt(QByteArray &data, quint32 value)
+{
+   data.append((char)(value & 0xff));
+   data.append((char)((value >> 8) & 0xff));
+   data.append((char)((value >> 16) & 0xff));
+   data.append((char)(value >> 24));
+}
+
+static void appendVarInt(QByteArray &data, quint32 value)
+{
+   while (value >= 0x80) {
+      data.append((char)((value & 0x7f) | 0x80));
+      value >>= 7;
+   }
+
+   data.append((char)value);
+}
+
+// returns false when the value runs past end
+static bool readVarInt(const uchar *&ptr, const uchar *end, quint32 &value)
+{
+   value = 0;
+
+   for (int shift = 0; shift < 35; shift += 7) {
+
+      if (ptr == end) {
+         return false;
+      }
+
+      const uchar c = *ptr++;
+      value |= (quint32)(c & 0x7f) << shift;
+
+      if ((c & 0x80) == 0) {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+SearchFileWriter::SearchFileWriter()
+   : m_postingsSize(0), m_error(false)
+{
+   m_postingsFile.setFileName(QString("%1/doxy_search_%2.dxi.tmp").arg(Config::getString("output-dir")).arg(portable_pid()));
+
+   if (! m_postingsFile.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+      err("Unable to open temporary file %s, error: %d\n", csPrintable(m_postingsFile.fileName()), m_postingsFile.error());
+      m_error = true;
+   }
+}
+
+SearchFileWriter::~SearchFileWriter()
+{
+   if (m_postingsFile.isOpen()) {
+      m_postingsFile.close();
+      m_postingsFile.remove();
+   }
+}
+
+int SearchFileWriter::addString(const QByteArray &str)
+{
+   int retval = m_strings.size();
+   m_strings.append(str);
+
+   return retval;
+}
+
+void SearchFileWriter::addUrl(const QString &name, const QString &url)
+{
+   QByteArray nameStr = name.toUtf8();
+   QByteArray urlStr  = url.toUtf8();
+
+   m_urlTable.append(addString(nameStr));
+   m_urlTable.append(nameStr.size());
+   m_urlTable.append(addString(urlStr));
+   m_urlTable.append(urlStr.size());
+}
+
+void SearchFileWriter::addTerm(const QString &term, const QVector<QPair<int, int>> &postings)
+{
+   if (postings.isEmpty() || m_error) {
+      return;
+   }
+
+   QByteArray data;
+   int lastUrl = 0;
+
+   for (const auto &item : postings) {
+      appendVarInt(data, item.first - lastUrl);
+      appendVarInt(data, item.second);
+
+      lastUrl = item.first;
+   }
+
+   if (m_postingsFile.write(data) != data.size()) {
+      err("Unable to write temporary file %s, error: %d\n", csPrintable(m_postingsFile.fileName()), m_postingsFile.error());
+      m_error = true;
+
+      return;
+   }
+
+   TermEntry entry;
+   entry.term           = term.toUtf8();
+   entry.stringOffset   = addString(entry.term);
+   entry.postingsOffset = m_postingsSize;
+   entry.numPostings    = postings.size();
+
+   m_postingsSize += data.size();
+   m_terms.append(entry);
+}
+
+bool SearchFileWriter::write(const QString &fileName)
+{
+   if (m_error) {
+      return false;
+   }
+
+   // the reader compares the UTF-8 bytes of the terms
+   std::sort(m_terms.begin(), m_terms.end(), [] (const TermEntry &a, const TermEntry &b) {
+      return a.term < b.term;
+   } );
+
+   const int numTerms = m_terms.size();
+   const int numUrls  = m_urlTable.size() / 4;
+
+   const quint32 termTable = s_headerSize;
+   const quint32 urlTable  = termTable + numTerms * s_termEntrySize;
+   const quint32 strings   = urlTable  + numUrls  * s_urlEntrySize;
+   const quint32 postings  = strings   + m_strings.size();
+
+   QByteArray data;
+   data.reserve(strings);
+
+   data.append("DXI1");
+   appendInt(data, s_version);
+   appendInt(data, numTerms);
+   appendInt(data, numUrls);
+   appendInt(data, termTable);
+   appendInt(data, urlTable);
+   appendInt(data, strings);
+   appendInt(data, postings);
+
+   for (const auto &item : m_terms) {
+      appendInt(data, item.stringOffset);
+      appendInt(data, item.term.size());
+      appendInt(data, item.postingsOffset);
+      appendInt(data, item.numPostings);
+   }
+
+   for (auto item : m_urlTable) {
+      appendInt(data, item);
+   }
+
+   QFile f(fileName);
+
+   if (! f.open(QIODevice::WriteOnly)) {
+      err("Unable to open file for writing %s, error: %d\n", csPrintable(fileName), f.error());
+      return false;
+   }
+
+   bool ok = f.write(data) == data.size() && f.write(m_strings) == m_strings.size();
+
+   // copy the postings from the temporary file
+   ok = ok && m_postingsFile.seek(0);
+
+   while (ok && ! m_postingsFile.atEnd()) {
+      const QByteArray block = m_postingsFile.read(1024 * 1024);
+      ok = ! block.isEmpty() && f.write(block) == block.size();
+   }
+
+   ok = ok && f.flush();
+
+   if (! ok) {
+      err("Unable to write file %s, error: %d\n", csPrintable(fileName), f.error());
+      return false;
+   }
+
+   return true;
+}
+
+SearchFileReader::SearchFileReader()
+   : m_data(nullptr), m_length(0), m_isMapped(false), m_numTerms(0), m_numUrls(0),
+     m_termTable(0), m_urlTable(0), m_strings(0), m_postings(0)
+{
+}
+
+SearchFileReader::~SearchFileReader()
+{
+   close();
+}
+
+void SearchFileReader::close()
+{
+#if ! defined(_WIN32) || defined(__CYGWIN__)
+   if (m_isMapped) {
+      munmap((void *)m_data, m_length);
+   }
+#endif
+
+   m_contents.clear();
+
+   m_data     = nullptr;
+   m_length   = 0;
+   m_isMapped = false;
+   m_numTerms = 0;
+   m_numUrls  = 0;
+}
+
+bool SearchFileReader::open(const QString &fileName)
+{
+   close();
+
+#if ! defined(_WIN32) || defined(__CYGWIN__)
+   int fd = ::open(QFile::encodeName(fileName).constData(), O_RDONLY);
+
+   if (fd != -1) {
+      struct stat st;
+
+      if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= s_headerSize && st.st_size <= 0x7fffffff) {
+         void *ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+         if (ptr != MAP_FAILED) {
+            m_data     = (const uchar *)ptr;
+            m_length   = st.st_size;
+            m_isMapped = true;
+         }
+      }
+
+      ::close(fd);
+   }
+#endif
+
+   if (m_data == nullptr) {
+      QFile f(fileName);
+
+      if (! f.open(QIODevice::ReadOnly)) {
+         return false;
+      }
+
+      m_contents = f.readAll();
+      m_data     = (const uchar *)m_contents.constData();
+      m_length   = m_contents.size();
+   }
+
+   if (m_length < s_headerSize || memcmp(m_data, "DXI1", 4) != 0 || readInt(4) != s_version) {
+      close();
+      return false;
+   }
+
+   m_numTerms  = readInt(8);
+   m_numUrls   = readInt(12);
+   m_termTable = readInt(16);
+   m_urlTable  = readInt(20);
+   m_strings   = readInt(24);
+   m_postings  = readInt(28);
+
+   // tables must fit in the file, the string and postings offsets are checked when used
+   bool isValid = m_numTerms >= 0 && m_numUrls >= 0 &&
+                  (quint64)m_termTable + (quint64)m_numTerms * s_termEntrySize <= m_length &&
+                  (quint64)m_urlTable  + (quint64)m_numUrls  * s_urlEntrySize  <= m_length &&
+                  m_strings <= m_length && m_postings <= m_length;
+
+   if (! isValid) {
+      close();
+      return false;
+   }
+
+   return true;
+}
+
+quint32 SearchFileReader::readInt(quint32 offset) const
+{
+   const uchar *ptr = m_data + offset;
+   return ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | ((quint32)ptr[3] << 24);
+}
+
+QByteArray SearchFileReader::termAt(int index) const
+{
+   const quint32 entry  = m_termTable + index * s_termEntrySize;
+   const quint64 offset = (quint64)m_strings + readInt(entry);
+   const quint32 length = readInt(entry + 4);
+
+   if (offset + length > m_length) {
+      return QByteArray();
+   }
+
+   // raw data is not copied, the array is only valid while the file is open
+   return QByteArray::fromRawData((const char *)m_data + offset, length);
+}
+
+QString SearchFileReader::urlName(int index) const
+{
+   if (index < 0 || index >= m_numUrls) {
+      return QString();
+   }
+
+   const quint32 entry  = m_urlTable + index * s_urlEntrySize;
+   const quint64 offset = (quint64)m_strings + readInt(entry);
+   const quint32 length = readInt(entry + 4);
+
+   if (offset + length > m_length) {
+      return QString();
+   }
+
+   return QString::fromUtf8((const char *)m_data + offset, length);
+}
+
+QString SearchFileReader::url(int index) const
+{
+   if (index < 0 || index >= m_numUrls) {
+      return QString();
+   }
+
+   const quint32 entry  = m_urlTable + index * s_urlEntrySize;
+   const quint64 offset = (quint64)m_strings + readInt(entry + 8);
+   const quint32 length = readInt(entry + 12);
+
+   if (offset + length > m_length) {
+      return QString();
+   }
+
+   return QString::fromUtf8((const char *)m_data + offset, length);
+}
+
+// index of the first term which is not less than term
+int SearchFileReader::lowerBound(const QByteArray &term) const
+{
+   int first = 0;
+   int count = m_numTerms;
+
+   while (count > 0) {
+      int step = count / 2;
+      int mid  = first + step;
+
+      if (termAt(mid) < term) {
+         first = mid + 1;
+         count -= step + 1;
+
+      } else {
+         count = step;
+      }
+   }
+
+   return first;
+}
+
+void SearchFileReader::addPostings(int termIndex, double weight, QHash<int, double> &scores) const
+{
+   const quint32 entry       = m_termTable + termIndex * s_termEntrySize;
+   const quint64 offset      = (quint64)m_postings + readInt(entry + 8);
+   const quint32 numPostings = readInt(entry + 12);
+
+   if (offset > m_length || numPostings == 0) {
+      return;
+   }
+
+   // rare terms count more than terms found in most documents
+   const double idf = log(1.0 + (double)m_numUrls / numPostings);
+
+   const uchar *ptr = m_data + offset;
+   const uchar *end = m_data + m_length;
+
+   quint32 urlIndex = 0;
+
+   for (quint32 i = 0; i < numPostings; i++) {
+      quint32 delta;
+      quint32 freq;
+
+      if (! readVarInt(ptr, end, delta) || ! readVarInt(ptr, end, freq)) {
+         break;
+      }
+
+      urlIndex += delta;
+
+      double score = weight * idf * log(1.0 + (freq >> 1));
+
+      if (freq & 1) {
+         // word is part of the name or the brief description
+         score *= 2.0;
+      }
+
+      scores[urlIndex] += score;
+   }
+}
+
+QVector<SearchFileReader::Result> SearchFileReader::search(const QString &query) const
+{
+   QVector<Result> retval;
+
+   QHash<int, double> totalScores;
+   QSet<int> excluded;
+
+   QList<QSet<int>> requiredList;
+   bool hasOptional = false;
+
+   const QStringList wordList = query.toLower().split(' ', QString::SkipEmptyParts);
+
+   for (QString word : wordList) {
+      QChar mode;
+
+      if (word.startsWith('+') || word.startsWith('-')) {
+         mode = word.at(0);
+         word = word.mid(1);
+      }
+
+      if (word.isEmpty()) {
+         continue;
+      }
+
+      // exact matches and words starting with the query word, as doxysearch does
+      const QByteArray prefix = word.toUtf8();
+      QHash<int, double> scores;
+
+      for (int i = lowerBound(prefix); i < m_numTerms; i++) {
+         QByteArray term = termAt(i);
+
+         if (! term.startsWith(prefix)) {
+            break;
+         }
+
+         addPostings(i, term.size() == prefix.size() ? 1.0 : 0.5, scores);
+      }
+
+      if (mode == '-') {
+         for (auto iter = scores.constBegin(); iter != scores.constEnd(); ++iter) {
+            excluded.insert(iter.key());
+         }
+
+         continue;
+      }
+
+      if (mode == '+') {
+         QSet<int> required;
+
+         for (auto iter = scores.constBegin(); iter != scores.constEnd(); ++iter) {
+            required.insert(iter.key());
+         }
+
+         requiredList.append(required);
+
+      } else {
+         hasOptional = true;
+      }
+
+      for (auto iter = scores.constBegin(); iter != scores.constEnd(); ++iter) {
+         totalScores[iter.key()] += iter.value();
+      }
+   }
+
+   if (requiredList.isEmpty() && ! hasOptional) {
+      return retval;
+   }
+
+   for (auto iter = totalScores.constBegin(); iter != totalScores.constEnd(); ++iter) {
+      const int urlIndex = iter.key();
+
+      if (excluded.contains(urlIndex)) {
+         continue;
+      }
+
+      bool isMatch = true;
+
+      for (const auto &required : requiredList) {
+         if (! required.contains(urlIndex)) {
+            isMatch = false;
+            break;
+         }
+      }
+
+      if (isMatch) {
+         retval.append(Result{urlIndex, iter.value()});
+      }
+   }
+
+   std::sort(retval.begin(), retval.end(), [] (const Result &a, const Result &b) {
+      if (a.score != b.score) {
+         return a.score > b.score;
+      }
+
+      return a.urlIndex < b.urlIndex;
+   } );
+
+   return retval;
+}
+
+int searchIndexFile(const QString &fileName, const QString &query)
+{
+   // no project file is read, msg() uses the default settings
+   Config::load_Defaults();
+
+   SearchFileReader reader;
+
+   if (! reader.open(fileName)) {
+      err("Unable to open search index %s\n", csPrintable(fileName));
+      return 1;
+   }
+
+   const QVector<SearchFileReader::Result> results = reader.search(query);
+
+   msg("%d documents match \"%s\"\n", results.size(), csPrintable(query));
+
+   for (const auto &item : results) {
+      msg("%8.3f  %s  %s\n", item.score, csPrintable(reader.urlName(item.urlIndex)),
+                  csPrintable(reader.url(item.urlIndex)));
+   }
+
+   return 0;
+}
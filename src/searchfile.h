@@ -0,0 +1,133 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#ifndef SEARCHFILE_H
+#define SEARCHFILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+// file format of search.dxi, all integers are 32 bit little endian
+//
+//   header       magic "DXI1", version, number of terms, number of urls,
+//                offset of the term table, the url table, the strings and the postings
+//   term table   per term: string offset, string length, postings offset, number of postings
+//                sorted by the UTF-8 bytes of the term
+//   url table    per url: name offset, name length, url offset, url length
+//   strings      UTF-8 text of the terms, names and urls, not terminated
+//   postings     per term and url: varint of the url index delta, varint of the frequency
+//                the frequency is twice the number of hits, bit 0 marks a high priority document
+//
+// The file is used as it is mapped, a query only does a binary search of the term table and
+// decodes the postings of the matching terms.
+
+/** Writes a server side search index in the search.dxi format */
+class SearchFileWriter
+{
+ public:
+   SearchFileWriter();
+   ~SearchFileWriter();
+
+   /** Adds a url, the first url has index 0 */
+   void addUrl(const QString &name, const QString &url);
+
+   /** Adds a term, \a postings holds pairs of url index and frequency sorted by url index */
+   void addTerm(const QString &term, const QVector<QPair<int, int>> &postings);
+
+   /** Writes the index to \a fileName, returns false and reports an error when it could not be written */
+   bool write(const QString &fileName);
+
+ private:
+   struct TermEntry {
+      QByteArray term;
+      int        stringOffset;
+      int        postingsOffset;
+      int        numPostings;
+   };
+
+   int addString(const QByteArray &str);
+
+   QVector<TermEntry> m_terms;
+   QVector<int>       m_urlTable;
+
+   QByteArray m_strings;
+
+   // the encoded postings are kept in a temporary file until write() copies them
+   QFile   m_postingsFile;
+   quint32 m_postingsSize;
+   bool    m_error;
+};
+
+/** Read access to a mapped search.dxi file */
+class SearchFileReader
+{
+ public:
+   struct Result {
+      int    urlIndex;
+      double score;
+   };
+
+   SearchFileReader();
+   ~SearchFileReader();
+
+   bool open(const QString &fileName);
+   void close();
+
+   /** Returns the documents matching \a query ordered by score, words starting with '+' are
+    *  required and words starting with '-' exclude a document */
+   QVector<Result> search(const QString &query) const;
+
+   QString urlName(int index) const;
+   QString url(int index) const;
+
+   int numTerms() const {
+      return m_numTerms;
+   }
+
+   int numUrls() const {
+      return m_numUrls;
+   }
+
+ private:
+   quint32 readInt(quint32 offset) const;
+   QByteArray termAt(int index) const;
+
+   int lowerBound(const QByteArray &term) const;
+   void addPostings(int termIndex, double weight, QHash<int, double> &scores) const;
+
+   const uchar *m_data;
+   quint32      m_length;
+   bool         m_isMapped;
+
+   QByteArray   m_contents;       // used when the file can not be mapped
+
+   int m_numTerms;
+   int m_numUrls;
+
+   quint32 m_termTable;
+   quint32 m_urlTable;
+   quint32 m_strings;
+   quint32 m_postings;
+};
+
+/** Runs \a query on the index file \a fileName and prints the results, returns the exit code */
+int searchIndexFile(const QString &fileName, const QString &query);
+
+#endif
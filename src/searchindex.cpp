@@ -15,13 +15,19 @@
  *
 *************************************************************************/
 
+#include <QDir>
 #include <QFile>
 #include <QRegExp>
+#include <QScopedPointer>
+#include <QSet>
 #include <QTextStream>
 
 #include <ctype.h>
 #include <assert.h>
 
+#include <algorithm>
+#include <functional>
+
 #include <searchindex.h>
 
 #include <config.h>
@@ -29,35 +35,93 @@
 #include <doxy_build_info.h>
 #include <language.h>
 #include <message.h>
+#include <portable.h>
 #include <resourcemgr.h>
+#include <searchfile.h>
 #include <util.h>
 
-IndexWord::IndexWord(const QString &word) : m_word(word)
-{  
-}
+namespace {
 
-void IndexWord::addUrlIndex(int idx, bool hiPriority)
-{  
-   QSharedPointer<URLInfo> ui = m_urls.value(idx);
+/** Reads one sorted run of postings from the spill file */
+class SpillRunReader
+{
+ public:
+   SpillRunReader(const QString &fileName, qint64 offset, qint64 length)
+      : m_file(fileName), m_remaining(length), m_wordId(-1)
+   {
+      if (m_file.open(QIODevice::ReadOnly)) {
+         m_file.seek(offset);
+      } else {
+         m_remaining = 0;
+      }
+
+      next();
+   }
+
+   // word id of the current record, -1 at the end of the run
+   int wordId() const {
+      return m_wordId;
+   }
 
-   if (! ui) {     
-      ui = QMakeShared<URLInfo>(idx, 0);
-      m_urls.insert(idx, ui);
+   const QVector<quint32> &postings() const {
+      return m_postings;
    }
 
-   ui->freq += 2;
+   void next()
+   {
+      m_wordId = -1;
+      m_postings.clear();
+
+      if (m_remaining < 8) {
+         return;
+      }
+
+      quint32 header[2];
+
+      if (m_file.read((char *)header, sizeof(header)) != sizeof(header)) {
+         m_remaining = 0;
+         return;
+      }
+
+      const qint64 size = qint64(header[1]) * 2 * sizeof(quint32);
+      m_remaining -= qint64(sizeof(header)) + size;
+
+      if (m_remaining < 0) {
+         return;
+      }
+
+      m_postings.resize(header[1] * 2);
 
-   if (hiPriority) {
-      ui->freq |= 1;   // mark as high priority document
+      if (m_file.read((char *)m_postings.data(), size) == size) {
+         m_wordId = header[0];
+      }
    }
+
+ private:
+   QFile  m_file;
+   qint64 m_remaining;
+
+   int m_wordId;
+   QVector<quint32> m_postings;
+};
+
 }
 
-SearchIndex::SearchIndex() : SearchIndex_Base(Internal), m_urlIndex(-1)
-{    
+SearchIndex::SearchIndex()
+   : SearchIndex_Base(Internal), m_numPostings(0), m_urlIndex(-1)
+{
+   // each posting takes two 32 bit values, plus the growth of the vector
+   m_maxPostings = qint64(Config::getInt("search-index-memory")) * 1024 * 1024 / 12;
+
+   m_spillFileName = QString("%1/doxy_search_%2.tmp").arg(Config::getString("output-dir")).arg(portable_pid());
 }
 
 SearchIndex::~SearchIndex()
-{ 
+{
+   if (m_spillFile.isOpen()) {
+      m_spillFile.close();
+      QFile::remove(m_spillFileName);
+   }
 }
 
 void SearchIndex::setCurrentDoc(QSharedPointer<Definition> ctx, const QString &anchor, bool isSourceFile)
@@ -182,32 +246,59 @@ static int charsToIndex(const QString &word)
 
 void SearchIndex::addWord(const QString &word, bool hiPriority, bool recurse)
 {
-   if (word.isEmpty()) {
+   if (word.isEmpty() || m_urlIndex < 0) {
       return;
    }
 
    static QRegExp nextPart("[_a-z:][A-Z]");
 
-   QString wStr = word.toLower();   
-   QSharedPointer<IndexWord> w = m_words.value(wStr);
+   QString wStr = word.toLower();
+   auto iter    = m_wordIds.constFind(wStr);
+
+   int wordId;
 
-   if (! w) {
+   if (iter != m_wordIds.constEnd()) {
+      wordId = iter.value();
+
+   } else {
       int idx = charsToIndex(wStr);
-     
+
       if (idx < 0) {
          return;
       }
 
-      w = QMakeShared<IndexWord>(wStr);     
-      m_words.insert(wStr, w);
+      wordId = m_wordList.size();
+
+      m_wordIds.insert(wStr, wordId);
+      m_wordList.append(wStr);
+      m_postings.append(QVector<quint32>());
    }
 
-   w->addUrlIndex(m_urlIndex, hiPriority);
+   QVector<quint32> &postings = m_postings[wordId];
+   const int count = postings.size();
+
+   if (count > 0 && postings[count - 2] == (quint32)m_urlIndex) {
+      postings[count - 1] += 2;
+
+      if (hiPriority) {
+         postings[count - 1] |= 1;   // mark as high priority document
+      }
+
+   } else {
+      postings.append(m_urlIndex);
+      postings.append(hiPriority ? 3 : 2);
+
+      ++m_numPostings;
+
+      if (m_maxPostings > 0 && m_numPostings > m_maxPostings) {
+         spillPostings();
+      }
+   }
 
    int i;
    bool found = false;
 
-   if (! recurse) { 
+   if (! recurse) {
       // the first time we check if we can strip the prefix
       i = getPrefixIndex(word);
 
@@ -217,11 +308,11 @@ void SearchIndex::addWord(const QString &word, bool hiPriority, bool recurse)
       }
    }
 
-   if (! found) { 
+   if (! found) {
       // no prefix stripped
       i = nextPart.indexIn(word);
 
-      if (i >= 1) {       
+      if (i >= 1) {
          addWord(word.mid(i+1), hiPriority, true);
       }
    }
@@ -247,6 +338,121 @@ static void writeString(QFile &file, const QString &str)
 }
 
 
+// returns the word ids in the order of the words
+static QVector<int> sortedWordIds(const QVector<QString> &wordList)
+{
+   QVector<int> retval;
+   retval.reserve(wordList.size());
+
+   for (int i = 0; i < wordList.size(); i++) {
+      retval.append(i);
+   }
+
+   std::sort(retval.begin(), retval.end(), [&wordList] (int a, int b) {
+      return wordList[a] < wordList[b];
+   } );
+
+   return retval;
+}
+
+// writes the postings in memory to the spill file as one run sorted by word, the words stay
+// in memory so the runs can be merged by word id
+void SearchIndex::spillPostings()
+{
+   if (! m_spillFile.isOpen()) {
+      m_spillFile.setFileName(m_spillFileName);
+
+      if (! m_spillFile.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+         err("Unable to open temporary file %s, search index is kept in memory\n", csPrintable(m_spillFileName));
+         m_maxPostings = 0;
+         return;
+      }
+   }
+
+   const qint64 offset = m_spillFile.size();
+   m_spillFile.seek(offset);
+
+   for (int wordId : sortedWordIds(m_wordList)) {
+      QVector<quint32> &postings = m_postings[wordId];
+
+      if (postings.isEmpty()) {
+         continue;
+      }
+
+      quint32 header[2] = { (quint32)wordId, (quint32)postings.size() / 2 };
+
+      m_spillFile.write((const char *)header, sizeof(header));
+      m_spillFile.write((const char *)postings.constData(), postings.size() * sizeof(quint32));
+
+      postings = QVector<quint32>();
+   }
+
+   m_spillFile.flush();
+   m_spillRuns.append(qMakePair(offset, m_spillFile.size() - offset));
+
+   m_numPostings = 0;
+}
+
+// calls func for each word in sorted order, passing the pairs of url index and frequency
+// from all spilled runs and from memory, sorted by url index
+void SearchIndex::mergePostings(PostingsFunc func)
+{
+   QList<QSharedPointer<SpillRunReader>> runList;
+
+   for (const auto &item : m_spillRuns) {
+      runList.append(QMakeShared<SpillRunReader>(m_spillFileName, item.first, item.second));
+   }
+
+   QVector<quint32> values;
+   QVector<QPair<int, int>> postings;
+
+   for (int wordId : sortedWordIds(m_wordList)) {
+      values.clear();
+
+      for (auto &run : runList) {
+         if (run->wordId() == wordId) {
+            values += run->postings();
+            run->next();
+         }
+      }
+
+      values += m_postings[wordId];
+
+      if (values.isEmpty()) {
+         continue;
+      }
+
+      postings.clear();
+
+      for (int i = 0; i < values.size(); i += 2) {
+         postings.append(qMakePair((int)values[i], (int)values[i + 1]));
+      }
+
+      std::stable_sort(postings.begin(), postings.end(), [] (const QPair<int, int> &a, const QPair<int, int> &b) {
+         return a.first < b.first;
+      } );
+
+      // a url can occur more than once when a document was visited again
+      int last = 0;
+
+      for (int i = 1; i < postings.size(); i++) {
+         if (postings[i].first == postings[last].first) {
+            int freq1 = postings[last].second;
+            int freq2 = postings[i].second;
+
+            postings[last].second = ((freq1 & ~1) + (freq2 & ~1)) | ((freq1 | freq2) & 1);
+
+         } else {
+            postings[++last] = postings[i];
+         }
+      }
+
+      postings.resize(last + 1);
+
+      func(m_wordList[wordId], postings);
+   }
+}
+
 // file format: (all multi-byte values are stored in big endian format)
 //   4 byte header
 //   256*256*4 byte index (4 bytes)
@@ -259,13 +465,35 @@ static void writeString(QFile &file, const QString &str)
 //   for each url: a \0 terminated string
 
 void SearchIndex::write(const QString &fileName)
+{
+   write(fileName, QString());
+}
+
+void SearchIndex::write(const QString &fileName, const QString &mappedFile)
 {
    static const int numIndexEntries = 256 * 256;
-    
-   QMap<QString, int> wordStatOffsets;  
+
+   // one merge of the postings feeds both files
+   QScopedPointer<SearchFileWriter> mappedWriter;
+
+   if (! mappedFile.isEmpty()) {
+      mappedWriter.reset(new SearchFileWriter);
+
+      for (int i = 0; i <= m_urlIndex; i++) {
+         QSharedPointer<URL> item = m_urls.value(i);
+
+         if (item) {
+            mappedWriter->addUrl(item->name, item->url);
+         } else {
+            mappedWriter->addUrl(QString(), QString());
+         }
+      }
+   }
+
+   QVector<QPair<QString, int>> wordStatOffsets;
    QMap<QString, int> urlOffsets;
    QMap<int, int> wordOffsets;
-    
+
    QFile f(fileName);
 
    if (f.open(QIODevice::WriteOnly)) {
@@ -277,7 +505,7 @@ void SearchIndex::write(const QString &fileName)
 
       f.seek((numIndexEntries * 4) + 4);
 
-      // write urls     
+      // write urls
       for (auto item : m_urls) {
 
          // save the offset of this url
@@ -287,48 +515,55 @@ void SearchIndex::write(const QString &fileName)
          writeString(f, item->url);
       }
 
-      // write word statistics                    
-      for (auto item1 : m_words) {            
+      // write word statistics
+      mergePostings([&] (const QString &word, const QVector<QPair<int, int>> &postings) {
 
          // save the offset of this stats entry
-         wordStatOffsets.insert(item1->word(), f.pos() );
-
-         int numUrls = item1->urls().count();
-         writeInt(f, numUrls);
-        
-         for (auto item2 : item1->urls() ) {
-            writeInt(f, urlOffsets.value(m_urls.value(item2->urlIdx)->name));
-            writeInt(f, item2->freq);
+         wordStatOffsets.append(qMakePair(word, (int)f.pos()));
+
+         writeInt(f, postings.count());
+
+         for (const auto &item : postings) {
+            writeInt(f, urlOffsets.value(m_urls.value(item.first)->name));
+            writeInt(f, item.second);
          }
-      }                                   
+
+         if (mappedWriter) {
+            mappedWriter->addTerm(word, postings);
+         }
+      } );
 
       int lastIndex = -1;
 
-      for (auto item : m_words) {
-         int currentIndex = charsToIndex(item->word());
-         
+      for (const auto &item : wordStatOffsets) {
+         int currentIndex = charsToIndex(item.first);
+
          if (lastIndex != currentIndex) {
 
             if (lastIndex != -1) {
-               f.putChar(0); 
+               f.putChar(0);
             }
 
-            lastIndex = currentIndex;   
+            lastIndex = currentIndex;
             wordOffsets.insert(currentIndex, f.pos());
          }
 
-         writeString(f, item->word());
-         writeInt(f, wordStatOffsets[item->word()]);        
+         writeString(f, item.first);
+         writeInt(f, item.second);
       }
-       
-      f.putChar(0);  
-     
+
+      f.putChar(0);
+
       // write index
       f.seek(4);
 
       for (int i = 0; i < numIndexEntries; i++) {
          writeInt(f, wordOffsets.value(i));
-      }  
+      }
+
+      if (mappedWriter) {
+         mappedWriter->write(mappedFile);
+      }
    }
 }
 
@@ -344,14 +579,32 @@ struct SearchDocEntry {
    QString normalText;
 };
 
-SearchIndex_External::SearchIndex_External() : SearchIndex_Base(External)
+SearchIndex_External::SearchIndex_External()
+   : SearchIndex_Base(External), m_currentDeferred(false)
 {
+   m_streaming = Config::getBool("search-data-streaming");
 }
 
 SearchIndex_External::~SearchIndex_External()
 {
 }
 
+QString externalSearchDataFile()
+{
+   QString searchDataFile = Config::getString("search-data-file");
+
+   if (searchDataFile.isEmpty()) {
+      searchDataFile = "searchdata.xml";
+   }
+
+   if (! QDir::isAbsolutePath(searchDataFile)) {
+      QString outputDirectory = Config::getString("output-dir");
+      searchDataFile.prepend(outputDirectory + "/");
+   }
+
+   return searchDataFile;
+}
+
 static QString definitionToName(QSharedPointer<Definition> ctx)
 {
    if (ctx && ctx->definitionType() == Definition::TypeMember) {
@@ -407,6 +660,82 @@ static QString definitionToName(QSharedPointer<Definition> ctx)
    return "unknown";
 }
 
+static QSharedPointer<SearchDocEntry> newSearchDocEntry(QSharedPointer<Definition> ctx, bool isSourceFile,
+                  const QString &extId, const QString &url)
+{
+   QSharedPointer<SearchDocEntry> e(new SearchDocEntry);
+
+   e->type = isSourceFile ? "source" : definitionToName(ctx);
+   e->name = ctx->qualifiedName();
+
+   if (ctx->definitionType() == Definition::TypeMember) {
+      e->args = ctx.dynamicCast<MemberDef>()->argsString();
+   }
+
+   e->extId = extId;
+   e->url   = url;
+
+   return e;
+}
+
+// text of a <doc> record, split after the value of the keywords field and of the text field
+struct SearchDocText {
+   QByteArray head;
+   QByteArray middle;
+   QByteArray tail;
+};
+
+static SearchDocText formatSearchDocEntry(QSharedPointer<SearchDocEntry> doc)
+{
+   QString head = "  <doc>\n";
+   head += "    <field name=\"type\">" + doc->type + "</field>\n";
+   head += "    <field name=\"name\">" + convertToXML(doc->name) + "</field>\n";
+
+   if (! doc->args.isEmpty()) {
+      head += "    <field name=\"args\">" + convertToXML(doc->args) + "</field>\n";
+   }
+   if (! doc->extId.isEmpty()) {
+      head += "    <field name=\"tag\">" + convertToXML(doc->extId) + "</field>\n";
+   }
+   head += "    <field name=\"url\">" + convertToXML(doc->url) + "</field>\n";
+   head += "    <field name=\"keywords\">" + convertToXML(doc->importantText);
+
+   QString middle = "</field>\n    <field name=\"text\">" + convertToXML(doc->normalText);
+
+   SearchDocText retval;
+
+   retval.head   = head.toUtf8();
+   retval.middle = middle.toUtf8();
+   retval.tail   = "</field>\n  </doc>\n";
+
+   return retval;
+}
+
+static void writeSearchDocEntry(QFile &f, QSharedPointer<SearchDocEntry> doc)
+{
+   const SearchDocText text = formatSearchDocEntry(doc);
+
+   f.write(text.head);
+   f.write(text.middle);
+   f.write(text.tail);
+}
+
+// copies size bytes from fileIn to fileOut
+static bool copyFileData(QFile &fileIn, QFile &fileOut, qint64 size)
+{
+   while (size > 0) {
+      const QByteArray block = fileIn.read(qMin(size, qint64(1024 * 1024)));
+
+      if (block.isEmpty() || fileOut.write(block) != block.size()) {
+         return false;
+      }
+
+      size -= block.size();
+   }
+
+   return true;
+}
+
 void SearchIndex_External::setCurrentDoc(QSharedPointer<Definition> ctx, const QString &anchor, bool isSourceFile)
 {
    QString extId = stripPath(Config::getString("external-search-id"));
@@ -420,23 +749,30 @@ void SearchIndex_External::setCurrentDoc(QSharedPointer<Definition> ctx, const Q
 
    QString key = extId + ";" + url;
 
-   m_current = m_docEntries.find(key);
+   if (m_streaming) {
 
-   if (! m_current) {
-      QSharedPointer<SearchDocEntry> e(new SearchDocEntry);
+      if (m_current && key == m_currentKey) {
+         return;
+      }
 
-      e->type = isSourceFile ? "source" : definitionToName(ctx);
-      e->name = ctx->qualifiedName();
+      flushCurrent();
+      m_currentKey = key;
 
-      if (ctx->definitionType() == Definition::TypeMember) {
-         e->args = ctx.dynamicCast<MemberDef>()->argsString();
+      if (! m_writtenDocs.contains(key)) {
+         m_current = newSearchDocEntry(ctx, isSourceFile, extId, url);
+         m_currentDeferred = false;
+         return;
       }
 
-      e->extId = extId;
-      e->url  = url;
+      // already written, the remaining words are kept in memory
+      m_currentDeferred = true;
+   }
+
+   m_current = m_docEntries.find(key);
 
-      m_current = e;
-      m_docEntries.insert(key, e);      
+   if (! m_current) {
+      m_current = newSearchDocEntry(ctx, isSourceFile, extId, url);
+      m_docEntries.insert(key, m_current);
    }
 }
 
@@ -455,37 +791,153 @@ void SearchIndex_External::addWord(const QString &word, bool hiPriority)
    *pText += word; 
 }
 
+bool SearchIndex_External::openStream()
+{
+   if (m_streamFile.isOpen()) {
+      return true;
+   }
+
+   m_streamFile.setFileName(externalSearchDataFile());
+
+   if (! m_streamFile.open(QIODevice::WriteOnly)) {
+      err("Unable to open file for writing %s, error: %d\n", qPrintable(m_streamFile.fileName()), m_streamFile.error());
+      return false;
+   }
+
+   m_streamFile.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+   m_streamFile.write("<add>\n");
+
+   return true;
+}
+
+// appends the current document to the search data file
+void SearchIndex_External::flushCurrent()
+{
+   if (! m_current || m_currentDeferred) {
+      m_current = QSharedPointer<SearchDocEntry>();
+      return;
+   }
+
+   if (openStream()) {
+      const SearchDocText text = formatSearchDocEntry(m_current);
+
+      WrittenDoc pos;
+      pos.keywordsEnd = m_streamFile.pos() + text.head.size();
+      pos.textEnd     = pos.keywordsEnd + text.middle.size();
+      pos.hasKeywords = ! m_current->importantText.isEmpty();
+      pos.hasText     = ! m_current->normalText.isEmpty();
+
+      m_streamFile.write(text.head);
+      m_streamFile.write(text.middle);
+      m_streamFile.write(text.tail);
+
+      m_writtenDocs.insert(m_currentKey, pos);
+
+   } else {
+      // keep everything in memory and report the error in write()
+      m_streaming = false;
+      m_docEntries.insert(m_currentKey, m_current);
+   }
+
+   m_current = QSharedPointer<SearchDocEntry>();
+}
+
+// inserts the words of the documents which were visited again after they were written into
+// their records, at the positions saved by flushCurrent()
+void SearchIndex_External::mergeDeferred()
+{
+   QMap<qint64, QByteArray> inserts;
+
+   for (auto doc : m_docEntries) {
+      auto iter = m_writtenDocs.constFind(doc->extId + ";" + doc->url);
+
+      if (iter == m_writtenDocs.constEnd()) {
+         continue;
+      }
+
+      if (! doc->importantText.isEmpty()) {
+         inserts.insert(iter->keywordsEnd, ((iter->hasKeywords ? " " : "") + convertToXML(doc->importantText)).toUtf8());
+      }
+
+      if (! doc->normalText.isEmpty()) {
+         inserts.insert(iter->textEnd, ((iter->hasText ? " " : "") + convertToXML(doc->normalText)).toUtf8());
+      }
+   }
+
+   if (inserts.isEmpty()) {
+      return;
+   }
+
+   const QString fileName = m_streamFile.fileName();
+   const QString tempName = fileName + ".tmp";
+
+   QFile fileIn(fileName);
+   QFile fileOut(tempName);
+
+   if (! fileIn.open(QIODevice::ReadOnly) || ! fileOut.open(QIODevice::WriteOnly)) {
+      err("Unable to update the search data file %s\n", csPrintable(fileName));
+      return;
+   }
+
+   qint64 pos = 0;
+   bool ok    = true;
+
+   for (auto iter = inserts.constBegin(); ok && iter != inserts.constEnd(); ++iter) {
+      ok  = copyFileData(fileIn, fileOut, iter.key() - pos) && fileOut.write(iter.value()) == iter.value().size();
+      pos = iter.key();
+   }
+
+   ok = ok && copyFileData(fileIn, fileOut, fileIn.size() - pos) && fileOut.flush();
+
+   fileIn.close();
+   fileOut.close();
+
+   if (! ok) {
+      err("Unable to update the search data file %s\n", csPrintable(fileName));
+      QFile::remove(tempName);
+
+      return;
+   }
+
+   QFile::remove(fileName);
+
+   if (! QFile::rename(tempName, fileName)) {
+      err("Unable to update the search data file %s\n", csPrintable(fileName));
+   }
+}
+
 void SearchIndex_External::write(const QString &fileName)
 {
+   if (m_streaming) {
+      flushCurrent();
+
+      if (m_streaming && openStream()) {
+         m_streamFile.write("</add>\n");
+         m_streamFile.close();
+
+         if (! m_docEntries.isEmpty()) {
+            mergeDeferred();
+         }
+
+         return;
+      }
+   }
+
    QFile f(fileName);
 
    if (f.open(QIODevice::WriteOnly)) {
-      QTextStream t(&f);
-      t << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << endl;
-      t << "<add>" << endl;
-      
-      for (auto doc : m_docEntries) {
-
-         t << "  <doc>" << endl;
-         t << "    <field name=\"type\">"     << doc->type << "</field>" << endl;
-         t << "    <field name=\"name\">"     << convertToXML(doc->name) << "</field>" << endl;
+      f.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+      f.write("<add>\n");
 
-         if (! doc->args.isEmpty()) {
-            t << "    <field name=\"args\">"     << convertToXML(doc->args) << "</field>" << endl;
-         }
-         if (!doc->extId.isEmpty()) {
-            t << "    <field name=\"tag\">"      << convertToXML(doc->extId)  << "</field>" << endl;
-         }
-         t << "    <field name=\"url\">"      << convertToXML(doc->url)  << "</field>" << endl;
-         t << "    <field name=\"keywords\">" << convertToXML(doc->importantText)  << "</field>" << endl;
-         t << "    <field name=\"text\">"     << convertToXML(doc->normalText)     << "</field>" << endl;
-         t << "  </doc>" << endl;
+      for (auto doc : m_docEntries) {
+         writeSearchDocEntry(f, doc);
       }
-      t << "</add>" << endl;
+
+      f.write("</add>\n");
 
    } else {
       err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
-     
+
    }
 }
 
@@ -508,8 +960,10 @@ void SearchIndex_External::write(const QString &fileName)
 #define SEARCH_INDEX_PAGES      14
 #define NUM_SEARCH_INDICES      15
 
-static void addMemberToSearchIndex(LetterToIndexMap<SearchIndexMap> symbols[NUM_SEARCH_INDICES],
-                                   int symbolCount[NUM_SEARCH_INDICES], QSharedPointer<MemberDef> md)
+#define SEARCH_INDEX_BIT(index) (1u << (index))
+
+// returns the search indices a member belongs to as a bit mask, zero if the member is not indexed
+static uint memberSearchIndexMask(QSharedPointer<MemberDef> md)
 {
    static bool hideFriendCompounds = Config::getBool("hide-friend-compounds");
    bool isLinkable = md->isLinkable();
@@ -519,92 +973,70 @@ static void addMemberToSearchIndex(LetterToIndexMap<SearchIndexMap> symbols[NUM_
    QSharedPointer<FileDef>      fd;
    QSharedPointer<GroupDef>     gd;
 
+   uint retval = 0;
+
    if (isLinkable &&  (((cd = md->getClassDef()) && cd->isLinkable() && cd->templateMaster() == 0) || 
                        ((gd = md->getGroupDef()) && gd->isLinkable())) ) {
 
-      QString n = md->name();
+      bool isFriendToHide = hideFriendCompounds && (md->typeString() == "friend class" ||
+                             md->typeString() == "friend struct" || md->typeString() == "friend union");
 
-      if (! n.isEmpty()) {
-         uint letter = getUtf8CodeToLower(n, 0);
-         bool isFriendToHide = hideFriendCompounds && (md->typeString() == "friend class" ||
-                                md->typeString() == "friend struct" || md->typeString() == "friend union");
+      if (!(md->isFriend() && isFriendToHide)) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_ALL);
+      }
 
-         if (!(md->isFriend() && isFriendToHide)) {
-            symbols[SEARCH_INDEX_ALL].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_ALL]++;
-         }
+      if (md->isFunction() || md->isSlot() || md->isSignal()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_FUNCTIONS);
 
-         if (md->isFunction() || md->isSlot() || md->isSignal()) {
-            symbols[SEARCH_INDEX_FUNCTIONS].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_FUNCTIONS]++;
+      } else if (md->isVariable()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_VARIABLES);
 
-         } else if (md->isVariable()) {
-            symbols[SEARCH_INDEX_VARIABLES].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_VARIABLES]++;
+      } else if (md->isTypedef()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_TYPEDEFS);
 
-         } else if (md->isTypedef()) {
-            symbols[SEARCH_INDEX_TYPEDEFS].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_TYPEDEFS]++;
+      } else if (md->isEnumerate()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_ENUMS);
 
-         } else if (md->isEnumerate()) {
-            symbols[SEARCH_INDEX_ENUMS].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_ENUMS]++;
+      } else if (md->isEnumValue()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_ENUMVALUES);
 
-         } else if (md->isEnumValue()) {
-            symbols[SEARCH_INDEX_ENUMVALUES].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_ENUMVALUES]++;
-
-         } else if (md->isProperty()) {
-            symbols[SEARCH_INDEX_PROPERTIES].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_PROPERTIES]++;
+      } else if (md->isProperty()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_PROPERTIES);
 
-         } else if (md->isEvent()) {
-            symbols[SEARCH_INDEX_EVENTS].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_EVENTS]++;
+      } else if (md->isEvent()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_EVENTS);
 
-         } else if (md->isRelated() || md->isForeign() || (md->isFriend() && !isFriendToHide)) {
-            symbols[SEARCH_INDEX_RELATED].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_RELATED]++;
-         }
+      } else if (md->isRelated() || md->isForeign() || (md->isFriend() && !isFriendToHide)) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_RELATED);
       }
 
    } else if (isLinkable &&
               (((nd = md->getNamespaceDef()) && nd->isLinkable()) ||
                ((fd = md->getFileDef())      && fd->isLinkable())) ) {
 
-      QString n = md->name();
-
-      if (!n.isEmpty()) {
-         uint letter = getUtf8CodeToLower(n, 0);
-         symbols[SEARCH_INDEX_ALL].insertElement(letter, md);
-         symbolCount[SEARCH_INDEX_ALL]++;
+      retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_ALL);
 
-         if (md->isFunction()) {
-            symbols[SEARCH_INDEX_FUNCTIONS].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_FUNCTIONS]++;
+      if (md->isFunction()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_FUNCTIONS);
 
-         } else if (md->isVariable()) {
-            symbols[SEARCH_INDEX_VARIABLES].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_VARIABLES]++;
+      } else if (md->isVariable()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_VARIABLES);
 
-         } else if (md->isTypedef()) {
-            symbols[SEARCH_INDEX_TYPEDEFS].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_TYPEDEFS]++;
+      } else if (md->isTypedef()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_TYPEDEFS);
 
-         } else if (md->isEnumerate()) {
-            symbols[SEARCH_INDEX_ENUMS].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_ENUMS]++;
+      } else if (md->isEnumerate()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_ENUMS);
 
-         } else if (md->isEnumValue()) {
-            symbols[SEARCH_INDEX_ENUMVALUES].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_ENUMVALUES]++;
+      } else if (md->isEnumValue()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_ENUMVALUES);
 
-         } else if (md->isDefine()) {
-            symbols[SEARCH_INDEX_DEFINES].insertElement(letter, md);
-            symbolCount[SEARCH_INDEX_DEFINES]++;
-         }
+      } else if (md->isDefine()) {
+         retval |= SEARCH_INDEX_BIT(SEARCH_INDEX_DEFINES);
       }
    }
+
+   return retval;
 }
 
 // see also function convertToId() in search.js, which should match in behaviour
@@ -674,11 +1106,12 @@ class SearchIndexCategoryMapping
    QString categoryLabel[NUM_SEARCH_INDICES];
 };
 
-void writeJavascriptSearchIndex()
+using SearchSymbolFunc = std::function<void (uint letter, QSharedPointer<Definition> d, uint indexMask)>;
+
+// passes each symbol of the javascript search index to addSymbol, along with the indices it belongs to
+static void collectSearchSymbols(const SearchSymbolFunc &addSymbol)
 {
-   if (! Config::getBool("generate-html")) {
-      return;
-   }
+   const uint compoundMask = SEARCH_INDEX_BIT(SEARCH_INDEX_ALL);
 
    // index classes
    for (auto cd : Doxy_Globals::classSDict) {
@@ -686,11 +1119,7 @@ void writeJavascriptSearchIndex()
       uint letter = getUtf8CodeToLower(cd->localName(), 0);
 
       if (cd->isLinkable() && isId(letter)) {
-         g_searchIndexSymbols[SEARCH_INDEX_ALL].insertElement(letter, cd);
-         g_searchIndexSymbols[SEARCH_INDEX_CLASSES].insertElement(letter, cd);
-
-         g_searchIndexCount[SEARCH_INDEX_ALL]++;
-         g_searchIndexCount[SEARCH_INDEX_CLASSES]++;
+         addSymbol(letter, cd, compoundMask | SEARCH_INDEX_BIT(SEARCH_INDEX_CLASSES));
       }
    }
 
@@ -699,11 +1128,7 @@ void writeJavascriptSearchIndex()
       uint letter = getUtf8CodeToLower(nd->name(), 0);
 
       if (nd->isLinkable() && isId(letter)) {
-         g_searchIndexSymbols[SEARCH_INDEX_ALL].insertElement(letter, nd);
-         g_searchIndexSymbols[SEARCH_INDEX_NAMESPACES].insertElement(letter, nd);
-
-         g_searchIndexCount[SEARCH_INDEX_ALL]++;
-         g_searchIndexCount[SEARCH_INDEX_NAMESPACES]++;
+         addSymbol(letter, nd, compoundMask | SEARCH_INDEX_BIT(SEARCH_INDEX_NAMESPACES));
       }
    }
 
@@ -714,11 +1139,7 @@ void writeJavascriptSearchIndex()
          uint letter = getUtf8CodeToLower(fd->name(), 0);
 
          if (fd->isLinkable() && isId(letter)) {
-            g_searchIndexSymbols[SEARCH_INDEX_ALL].insertElement(letter, fd);
-            g_searchIndexSymbols[SEARCH_INDEX_FILES].insertElement(letter, fd);
-
-            g_searchIndexCount[SEARCH_INDEX_ALL]++;
-            g_searchIndexCount[SEARCH_INDEX_FILES]++;
+            addSymbol(letter, fd, compoundMask | SEARCH_INDEX_BIT(SEARCH_INDEX_FILES));
          }
       }
    }
@@ -728,17 +1149,24 @@ void writeJavascriptSearchIndex()
      
       // for each member definition
       for (auto md : *mn) {  
-         addMemberToSearchIndex(g_searchIndexSymbols, g_searchIndexCount, md);
+         uint indexMask = memberSearchIndexMask(md);
+
+         if (indexMask != 0 && ! md->name().isEmpty()) {
+            addSymbol(getUtf8CodeToLower(md->name(), 0), md, indexMask);
+         }
       }
    }
 
-
    // index file/namespace members, for each member name          
    for (auto mn : Doxy_Globals::functionNameSDict) {
 
       // for each member definition         
       for (auto md : *mn) { 
-         addMemberToSearchIndex(g_searchIndexSymbols, g_searchIndexCount, md);
+         uint indexMask = memberSearchIndexMask(md);
+
+         if (indexMask != 0 && ! md->name().isEmpty()) {
+            addSymbol(getUtf8CodeToLower(md->name(), 0), md, indexMask);
+         }
       }
    }
 
@@ -755,11 +1183,7 @@ void writeJavascriptSearchIndex()
             uint letter = charCode.toLower().unicode();
 
             if (isId(letter)) {
-               g_searchIndexSymbols[SEARCH_INDEX_ALL].insertElement(letter, gd);
-               g_searchIndexSymbols[SEARCH_INDEX_GROUPS].insertElement(letter, gd);
-
-               g_searchIndexCount[SEARCH_INDEX_ALL]++;
-               g_searchIndexCount[SEARCH_INDEX_GROUPS]++;
+               addSymbol(letter, gd, compoundMask | SEARCH_INDEX_BIT(SEARCH_INDEX_GROUPS));
             }
          }
       }
@@ -776,10 +1200,7 @@ void writeJavascriptSearchIndex()
             uint letter = charCode.toLower().unicode();
 
             if (isId(letter)) {
-               g_searchIndexSymbols[SEARCH_INDEX_ALL].insertElement(letter, pd);
-               g_searchIndexSymbols[SEARCH_INDEX_PAGES].insertElement(letter, pd);
-               g_searchIndexCount[SEARCH_INDEX_ALL]++;
-               g_searchIndexCount[SEARCH_INDEX_PAGES]++;
+               addSymbol(letter, pd, compoundMask | SEARCH_INDEX_BIT(SEARCH_INDEX_PAGES));
             }
          }
       }
@@ -793,16 +1214,330 @@ void writeJavascriptSearchIndex()
          uint letter = charCode.toLower().unicode();
 
          if (isId(letter)) {
-            g_searchIndexSymbols[SEARCH_INDEX_ALL].insertElement(letter, Doxy_Globals::mainPage);
-            g_searchIndexSymbols[SEARCH_INDEX_PAGES].insertElement(letter, Doxy_Globals::mainPage);
-            g_searchIndexCount[SEARCH_INDEX_ALL]++;
-            g_searchIndexCount[SEARCH_INDEX_PAGES]++;
+            addSymbol(letter, Doxy_Globals::mainPage, compoundMask | SEARCH_INDEX_BIT(SEARCH_INDEX_PAGES));
          }
       }
    }
-    
-   // write index files
-   QString searchDirName = Config::getString("html-output") + "/search";
+}
+
+// name of a symbol as shown in the search results
+static QString searchDisplayName(QSharedPointer<Definition> d)
+{
+   if (d->definitionType() == Definition::TypeGroup) {
+      return d.dynamicCast<GroupDef>()->groupTitle();
+
+   } else if (d->definitionType() == Definition::TypePage) {
+      return d.dynamicCast<PageDef>()->title();
+
+   }
+
+   return d->localName();
+}
+
+/** One link of a search result */
+struct SearchResultLink {
+   QString url;               // page of the definition, without the anchor
+   QString anchor;
+   bool    parentTarget;      // open in the parent frame
+   QString text;              // scope or qualified name, converted to XML
+};
+
+// returns the links shown for the symbols with the same name in defList
+static QVector<SearchResultLink> searchResultLinks(const QList<QSharedPointer<Definition>> &defList)
+{
+   static bool extLinksInWindow = Config::getBool("external-links-in-window");
+
+   QVector<SearchResultLink> retval;
+
+   if (defList.count() == 1) { 
+      // item with a unique name
+      QSharedPointer<Definition> d = defList.first();
+      QSharedPointer<MemberDef> md;
+
+      bool isMemberDef = d->definitionType() == Definition::TypeMember;
+      if (isMemberDef) {
+         md = d.dynamicCast<MemberDef>();
+      }
+
+      SearchResultLink link;
+      link.url          = externalRef("../", d->getReference(), true) + d->getOutputFileBase() + Doxy_Globals::htmlFileExtension;
+      link.anchor       = d->anchor();
+      link.parentTarget = ! extLinksInWindow || d->getReference().isEmpty();
+
+      if (d->getOuterScope() != Doxy_Globals::globalScope) {
+         link.text = convertToXML(d->getOuterScope()->name());
+
+      } else if (md) {
+         QSharedPointer<FileDef> fd = md->getBodyDef();
+
+         if (fd == 0) {
+            fd = md->getFileDef();
+         }
+         if (fd) {
+            link.text = convertToXML(fd->localName());
+         }
+      }
+
+      retval.append(link);
+
+   } else { 
+      // multiple items with the same name
+      bool overloadedFunction = false;
+
+      QSharedPointer<Definition> next;
+      QSharedPointer<Definition> prevScope;  
+ 
+      auto nextIter = defList.begin();   
+
+      for (auto d : defList)  {               
+         QSharedPointer<Definition> scope = d->getOuterScope();
+
+         if (nextIter != defList.end()) {  
+            ++nextIter;   
+         }
+
+         if (nextIter == defList.end()) {  
+            next = QSharedPointer<Definition>();
+
+         } else {
+            next = *nextIter;
+
+         }
+      
+         QSharedPointer<Definition> nextScope;
+         QSharedPointer<MemberDef>  md;
+
+         bool isMemberDef = d->definitionType() == Definition::TypeMember;
+
+         if (isMemberDef) {
+            md = d.dynamicCast<MemberDef>();
+         }
+
+         if (next) {
+            nextScope = next->getOuterScope();
+         }
+
+         SearchResultLink link;
+         link.url          = externalRef("../", d->getReference(), true) + d->getOutputFileBase() + Doxy_Globals::htmlFileExtension;
+         link.anchor       = d->anchor();
+         link.parentTarget = ! extLinksInWindow || d->getReference().isEmpty();
+
+         bool found = false;
+         overloadedFunction = ((prevScope != 0 && scope == prevScope) || (scope && scope == nextScope)) 
+                                 && md && (md->isFunction() || md->isSlot());
+
+         QString prefix;
+
+         if (md) {
+            prefix = convertToXML(md->localName());
+         }
+
+         if (overloadedFunction) {
+            // overloaded member function
+            prefix += convertToXML(md->argsString());
+            // show argument list to disambiguate overloaded functions
+
+         } else if (md) {
+            // unique member function
+            prefix += "()"; // only to show it is a function
+         }
+
+         QString name;
+         if (d->definitionType() == Definition::TypeClass) {
+
+            name  = convertToXML(d.dynamicCast<ClassDef>()->displayName());
+            found = true;
+
+         } else if (d->definitionType() == Definition::TypeNamespace) {
+
+            name  = convertToXML(d.dynamicCast<NamespaceDef>()->displayName());
+            found = true;
+
+         } else if (scope == 0 || scope == Doxy_Globals::globalScope) { 
+            // in global scope
+
+            if (md) {
+               QSharedPointer<FileDef> fd = md->getBodyDef();
+
+               if (fd == 0) {
+                  fd = md->getFileDef();
+               }
+
+               if (fd) {
+                  if (! prefix.isEmpty()) {
+                     prefix += ":&#160;";
+                  }
+                  name = prefix + convertToXML(fd->localName());
+                  found = true;
+               }
+            }
+
+         } else if (md && (md->getClassDef() || md->getNamespaceDef())) {
+            // member in class or namespace scope
+         
+            SrcLangExt lang = md->getLanguage();
+            name = convertToXML(d->getOuterScope()->qualifiedName())
+                   + getLanguageSpecificSeparator(lang) + prefix;
+
+            found = true;
+
+         } else if (scope) {
+            // some thing else? -> show scope
+
+            name = prefix + convertToXML(scope->name());
+            found = true;
+         }
+
+         if (! found) { 
+            // fallback
+            name = prefix + "(" + theTranslator->trGlobalNamespace() + ")";
+         }
+
+         link.text = name;
+         retval.append(link);
+
+         prevScope = scope;
+      }
+   }
+
+   return retval;
+}
+
+// writes searchdata.js, sectionLetters holds the first letters of the symbols in each index
+static void writeSearchData(const QString &searchDirName, const QString sectionLetters[NUM_SEARCH_INDICES],
+                  const QStringList sectionShards[NUM_SEARCH_INDICES])
+{
+   QFile f(searchDirName + "/searchdata.js");
+
+   if (f.open(QIODevice::WriteOnly)) {
+      QTextStream t(&f);
+
+      t << "var indexSectionsWithContent =" << endl;
+      t << "{" << endl;
+      bool first = true;
+      int j = 0;
+
+      for (int i = 0; i < NUM_SEARCH_INDICES; i++) {
+
+         if (! sectionLetters[i].isEmpty()) {
+
+            if (!first) {
+               t << "," << endl;
+            }
+            t << "  " << j << ": \"" << sectionLetters[i] << "\"";
+
+            first = false;
+            j++;
+         }
+      }
+
+      if (!first) {
+         t << "\n";
+      }
+
+      t << "};" << endl << endl;
+      t << "var indexSectionNames =" << endl;
+      t << "{" << endl;
+
+      first = true;
+      j = 0;
+
+      for (int i = 0; i < NUM_SEARCH_INDICES; i++) {
+         if (! sectionLetters[i].isEmpty()) {
+            if (!first) {
+               t << "," << endl;
+            }
+
+            t << "  " << j << ": \"" << g_searchIndexName[i] << "\"";
+            first = false;
+            j++;
+         }
+      }
+
+      if (! first) {
+         t << "\n";
+      }
+
+      t << "};" << endl << endl;
+      t << "var indexSectionLabels =" << endl;
+      t << "{" << endl;
+
+      first = true;
+      static SearchIndexCategoryMapping map;
+      j = 0;
+
+      for (int i = 0; i < NUM_SEARCH_INDICES; i++) {
+         if (! sectionLetters[i].isEmpty()) {
+
+            if (!first) {
+               t << "," << endl;
+            }
+
+            t << "  " << j << ": \"" << convertToXML(map.categoryLabel[i]) << "\"";
+            first = false;
+            j++;
+         }
+      }
+
+      if (!first) {
+         t << "\n";
+      }
+
+      t << "};" << endl << endl;
+
+      if (sectionShards != nullptr) {
+         // first search id of each shard of the compact index
+         t << "var indexSectionShards =" << endl;
+         t << "{" << endl;
+
+         first = true;
+         j = 0;
+
+         for (int i = 0; i < NUM_SEARCH_INDICES; i++) {
+            if (! sectionLetters[i].isEmpty()) {
+
+               if (!first) {
+                  t << "," << endl;
+               }
+
+               t << "  " << j << ": [";
+
+               for (int k = 0; k < sectionShards[i].count(); k++) {
+                  if (k > 0) {
+                     t << ",";
+                  }
+
+                  t << "\"" << sectionShards[i].at(k) << "\"";
+               }
+
+               t << "]";
+               first = false;
+               j++;
+            }
+         }
+
+         if (!first) {
+            t << "\n";
+         }
+
+         t << "};" << endl << endl;
+      }
+   }
+
+   ResourceMgr::instance().copyResourceAs("html/search.js", searchDirName, "search.js");
+}
+
+// one .html and one .js file for each letter of each index
+static void writeLetterSearchIndex(const QString &searchDirName)
+{
+   collectSearchSymbols([] (uint letter, QSharedPointer<Definition> d, uint indexMask) {
+      for (int i = 0; i < NUM_SEARCH_INDICES; i++) {
+         if (indexMask & SEARCH_INDEX_BIT(i)) {
+            g_searchIndexSymbols[i].insertElement(letter, d);
+            g_searchIndexCount[i]++;
+         }
+      }
+   } );
 
    for (int i = 0; i < NUM_SEARCH_INDICES; i++) { 
       // for each index    
@@ -872,7 +1607,6 @@ void writeJavascriptSearchIndex()
             ti << "[" << endl;
 
             bool firstEntry = true;           
-            int itemCount   = 0;
          
             for (auto dl : *sl) { 
                QSharedPointer<Definition> d = dl->first();
@@ -882,307 +1616,400 @@ void writeJavascriptSearchIndex()
                }
                firstEntry = false;
 
-               QString dispName = d->localName();
-
-               if (d->definitionType() == Definition::TypeGroup) {
-                  dispName = d.dynamicCast<GroupDef>()->groupTitle();
-
-               } else if (d->definitionType() == Definition::TypePage) {
-                  dispName = d.dynamicCast<PageDef>()->title();
-
-               }
+               QString dispName = searchDisplayName(d);
 
                ti << "  ['" << searchId(dispName) << "',['"
                   << convertToXML(dispName) << "',[";
 
-               if (dl->count() == 1) { 
-                  // item with a unique name
-                  QSharedPointer<MemberDef> md;
+               int childCount = 0;
 
-                  bool isMemberDef = d->definitionType() == Definition::TypeMember;
-                  if (isMemberDef) {
-                     md = d.dynamicCast<MemberDef>();
+               for (const auto &link : searchResultLinks(*dl)) {
+                  if (childCount > 0) {
+                     ti << "],[";
                   }
 
-                  QString anchor = d->anchor();
+                  ti << "'" << link.url;
 
-                  ti << "'" << externalRef("../", d->getReference(), true)
-                     << d->getOutputFileBase() << Doxy_Globals::htmlFileExtension;
-                  if (!anchor.isEmpty()) {
-                     ti << "#" << anchor;
+                  if (! link.anchor.isEmpty()) {
+                     ti << "#" << link.anchor;
                   }
-                  ti << "',";
 
-                  static bool extLinksInWindow = Config::getBool("external-links-in-window");
-                  if (!extLinksInWindow || d->getReference().isEmpty()) {
-                     ti << "1,";
-                  } else {
-                     ti << "0,";
-                  }
+                  ti << "'," << (link.parentTarget ? "1," : "0,");
+                  ti << "'" << link.text << "'";
 
-                  if (d->getOuterScope() != Doxy_Globals::globalScope) {
-                     ti << "'" << convertToXML(d->getOuterScope()->name()) << "'";
+                  childCount++;
+               }
 
-                  } else if (md) {
-                     QSharedPointer<FileDef> fd = md->getBodyDef();
+               ti << "]]";
+               ti << "]";
+            }
 
-                     if (fd == 0) {
-                        fd = md->getFileDef();
-                     }
-                     if (fd) {
-                        ti << "'" << convertToXML(fd->localName()) << "'";
-                     }
+            if (! firstEntry) {
+               ti << endl;
+            }
 
-                  } else {
-                     ti << "''";
-                  }
+            ti << "];" << endl;
 
-                  ti << "]]";
+         } else {
+            err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), outFile.error());
+          
+         }
 
-               } else { 
-                  // multiple items with the same name
-                  bool overloadedFunction = false;
-                  int childCount = 0;
+         ++p;
+      }
+   }
 
-                  QSharedPointer<Definition> next;
-                  QSharedPointer<Definition> prevScope;  
- 
-                  auto nextIter = dl->begin();   
+   QString sectionLetters[NUM_SEARCH_INDICES];
 
-                  for (auto d : *dl)  {               
-                     QSharedPointer<Definition> scope = d->getOuterScope();
+   for (int i = 0; i < NUM_SEARCH_INDICES; i++) {
 
-                     if (nextIter != dl->end()) {  
-                        ++nextIter;   
-                     }
+      if (g_searchIndexCount[i] > 0) {
+         for (auto sl : g_searchIndexSymbols[i]) {
+            // for each letter
+            sectionLetters[i] += QString( QChar( sl->letter() ) );
+         }
+      }
+   }
 
-                     if (nextIter == dl->end()) {  
-                        next = QSharedPointer<Definition>();
+   writeSearchData(searchDirName, sectionLetters, nullptr);
+}
 
-                     } else {
-                        next = *nextIter;
+// quotes a string for a javascript source file
+static QString jsQuote(const QString &str)
+{
+   QString retval = "\"";
 
-                     }
-                  
-                     QSharedPointer<Definition> nextScope;
-                     QSharedPointer<MemberDef>  md;
+   for (auto c : str) {
 
-                     bool isMemberDef = d->definitionType() == Definition::TypeMember;
+      switch (c.unicode()) {
+         case '\\':
+            retval += "\\\\";
+            break;
 
-                     if (isMemberDef) {
-                        md = d.dynamicCast<MemberDef>();
-                     }
+         case '"':
+            retval += "\\\"";
+            break;
 
-                     if (next) {
-                        nextScope = next->getOuterScope();
-                     }
+         case '\n':
+            retval += "\\n";
+            break;
 
-                     QString anchor = d->anchor();
+         case '\r':
+            retval += "\\r";
+            break;
 
-                     if (childCount > 0) {
-                        ti << "],[";
-                     }
-                     ti << "'" << externalRef("../", d->getReference(), true)
-                        << d->getOutputFileBase() << Doxy_Globals::htmlFileExtension;
+         case '/':
+            // avoid "</script>"
+            retval += "\\/";
+            break;
 
-                     if (!anchor.isEmpty()) {
-                        ti << "#" << anchor;
-                     }
-                     ti << "',";
+         default:
+            retval += c;
+      }
+   }
 
-                     static bool extLinksInWindow = Config::getBool("external-links-in-window");
-                     if (! extLinksInWindow || d->getReference().isEmpty()) {
-                        ti << "1,";
-                     } else {
-                        ti << "0,";
-                     }
+   retval += '"';
 
-                     bool found = false;
-                     overloadedFunction = ((prevScope != 0 && scope == prevScope) || (scope && scope == nextScope)) 
-                                             && md && (md->isFunction() || md->isSlot());
+   return retval;
+}
 
-                     QString prefix;
+/** @brief Writes one index of the compact javascript search index
+ *
+ *  Entries are added in the order of their search id and are written to shards of about
+ *  'search-shard-size' KB. Each shard has a table of the pages and a table of the scope texts
+ *  used by its entries, so repeated strings are only written once per shard. Only the shard
+ *  being filled is held in memory.
+ */
+class SearchShardWriter
+{
+ public:
+   SearchShardWriter(const QString &dirName, const QString &indexName)
+      : m_dirName(dirName), m_indexName(indexName), m_size(0)
+   {}
 
-                     if (md) {
-                        prefix = convertToXML(md->localName());
-                     }
+   void addEntry(const QString &id, const QString &name, const QVector<SearchResultLink> &links);
+   void finish();
 
-                     if (overloadedFunction) {
-                        // overloaded member function
-                        prefix += convertToXML(md->argsString());
-                        // show argument list to disambiguate overloaded functions
+   // the search id of the first entry in each shard
+   const QStringList &firstIds() const {
+      return m_firstIds;
+   }
 
-                     } else if (md) {
-                        // unique member function
-                        prefix += "()"; // only to show it is a function
-                     }
+ private:
+   static int tableIndex(const QString &str, QStringList &table, QHash<QString, int> &lookup);
+   void flush();
 
-                     QString name;
-                     if (d->definitionType() == Definition::TypeClass) {
+   QString m_dirName;
+   QString m_indexName;
 
-                        name  = convertToXML(d.dynamicCast<ClassDef>()->displayName());
-                        found = true;
+   QStringList         m_urls;
+   QHash<QString, int> m_urlLookup;
+   QStringList         m_texts;
+   QHash<QString, int> m_textLookup;
 
-                     } else if (d->definitionType() == Definition::TypeNamespace) {
+   QString     m_entries;
+   int         m_size;
 
-                        name  = convertToXML(d.dynamicCast<NamespaceDef>()->displayName());
-                        found = true;
+   QStringList m_firstIds;
+};
 
-                     } else if (scope == 0 || scope == Doxy_Globals::globalScope) { 
-                        // in global scope
+int SearchShardWriter::tableIndex(const QString &str, QStringList &table, QHash<QString, int> &lookup)
+{
+   auto iter = lookup.constFind(str);
 
-                        if (md) {
-                           QSharedPointer<FileDef> fd = md->getBodyDef();
+   if (iter != lookup.constEnd()) {
+      return iter.value();
+   }
 
-                           if (fd == 0) {
-                              fd = md->getFileDef();
-                           }
+   int retval = table.count();
 
-                           if (fd) {
-                              if (! prefix.isEmpty()) {
-                                 prefix += ":&#160;";
-                              }
-                              name = prefix + convertToXML(fd->localName());
-                              found = true;
-                           }
-                        }
+   table.append(str);
+   lookup.insert(str, retval);
 
-                     } else if (md && (md->getClassDef() || md->getNamespaceDef())) {
-                        // member in class or namespace scope
-                     
-                        SrcLangExt lang = md->getLanguage();
-                        name = convertToXML(d->getOuterScope()->qualifiedName())
-                               + getLanguageSpecificSeparator(lang) + prefix;
+   return retval;
+}
 
-                        found = true;
+void SearchShardWriter::addEntry(const QString &id, const QString &name, const QVector<SearchResultLink> &links)
+{
+   static const int maxShardSize = qMax(1, Config::getInt("search-shard-size")) * 1024;
 
-                     } else if (scope) {
-                        // some thing else? -> show scope
+   if (m_entries.isEmpty()) {
+      m_firstIds.append(id);
 
-                        name = prefix + convertToXML(scope->name());
-                        found = true;
-                     }
+   } else {
+      m_entries += ",\n";
+   }
 
-                     if (! found) { 
-                        // fallback
-                        name = prefix + "(" + theTranslator->trGlobalNamespace() + ")";
-                     }
+   // entry format: [id, name, [[url index, anchor, target, text index], ..]]
+   QString entry = "[" + jsQuote(id) + "," + jsQuote(name) + ",[";
+   bool first = true;
 
-                     ti << "'" << name << "'";
+   for (const auto &link : links) {
+      int urlIndex  = tableIndex(link.url, m_urls, m_urlLookup);
+      int textIndex = tableIndex(link.text, m_texts, m_textLookup);
 
-                     prevScope = scope;
-                     childCount++;
+      if (! first) {
+         entry += ",";
+      }
 
-                  }
+      entry += QString("[%1,%2,%3,%4]").arg(urlIndex).arg(jsQuote(link.anchor))
+                  .arg(link.parentTarget ? 1 : 0).arg(textIndex);
 
-                  ti << "]]";
-               }
+      if (urlIndex == m_urls.count() - 1) {
+         m_size += link.url.length();
+      }
 
-               ti << "]";
-               itemCount++;
-            }
+      if (textIndex == m_texts.count() - 1) {
+         m_size += link.text.length();
+      }
 
-            if (! firstEntry) {
-               ti << endl;
-            }
+      first = false;
+   }
 
-            ti << "];" << endl;
+   entry += "]]";
 
-         } else {
-            err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), outFile.error());
-          
-         }
+   m_entries += entry;
+   m_size    += entry.length();
 
-         ++p;
+   if (m_size >= maxShardSize) {
+      flush();
+   }
+}
+
+void SearchShardWriter::flush()
+{
+   if (m_entries.isEmpty()) {
+      return;
+   }
+
+   int shard = m_firstIds.count() - 1;
+   QString fileName = QString("%1/%2_s%3.js").arg(m_dirName).arg(m_indexName).arg(shard);
+
+   QFile f(fileName);
+
+   if (f.open(QIODevice::WriteOnly)) {
+      QTextStream t(&f);
+
+      t << "searchShardLoaded(" << jsQuote(m_indexName) << "," << shard << ",{" << endl;
+      t << "u:[";
+
+      for (int i = 0; i < m_urls.count(); i++) {
+         t << (i > 0 ? "," : "") << jsQuote(m_urls.at(i));
       }
+
+      t << "]," << endl;
+      t << "s:[";
+
+      for (int i = 0; i < m_texts.count(); i++) {
+         t << (i > 0 ? "," : "") << jsQuote(m_texts.at(i));
+      }
+
+      t << "]," << endl;
+      t << "d:[" << endl;
+      t << m_entries << endl;
+      t << "]});" << endl;
+
+   } else {
+      err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
+
    }
 
-   {
-      QFile f(searchDirName + "/searchdata.js");
+   m_urls.clear();
+   m_urlLookup.clear();
+   m_texts.clear();
+   m_textLookup.clear();
 
-      if (f.open(QIODevice::WriteOnly)) {
-         QTextStream t(&f);
+   m_entries.clear();
+   m_size = 0;
+}
 
-         t << "var indexSectionsWithContent =" << endl;
-         t << "{" << endl;
-         bool first = true;
-         int j = 0;
+void SearchShardWriter::finish()
+{
+   flush();
+}
 
-         for (int i = 0; i < NUM_SEARCH_INDICES; i++) {
+/** A symbol of the compact javascript search index */
+struct CompactSearchSymbol {
+   QString id;                         // search id of the display name, the sort key
+   QString name;                       // local name in lower case, symbols with the same name share an entry
+   QString dispName;
+   QSharedPointer<Definition> def;
+   uint    indexMask;
+};
 
-            if (g_searchIndexCount[i] > 0) {
+// sharded index which is loaded by search.js as needed, selected by 'search-compact-index'
+static void writeCompactSearchIndex(const QString &searchDirName)
+{
+   QVector<CompactSearchSymbol> symbolList;
+   QSet<uint> letterSet[NUM_SEARCH_INDICES];
 
-               if (!first) {
-                  t << "," << endl;
-               }
-               t << "  " << j << ": \"";
+   collectSearchSymbols([&symbolList, &letterSet] (uint letter, QSharedPointer<Definition> d, uint indexMask) {
+      QString dispName = searchDisplayName(d);
+      symbolList.append(CompactSearchSymbol{searchId(dispName), d->localName().toLower(), dispName, d, indexMask});
 
-               for (auto sl : g_searchIndexSymbols[i]) {
-                  // for each letter
-                  t << QString( QChar( sl->letter() ) );
-               }
-               t << "\"";
-               first = false;
-               j++;
-            }
+      for (int i = 0; i < NUM_SEARCH_INDICES; i++) {
+         if (indexMask & SEARCH_INDEX_BIT(i)) {
+            letterSet[i].insert(letter);
          }
+      }
+   } );
 
-         if (!first) {
-            t << "\n";
-         }
+   // search.js compares the ids in the same order to find the shards for a search
+   std::stable_sort(symbolList.begin(), symbolList.end(), [] (const CompactSearchSymbol &a, const CompactSearchSymbol &b) {
+      if (a.id != b.id) {
+         return a.id < b.id;
+      }
 
-         t << "};" << endl << endl;
-         t << "var indexSectionNames =" << endl;
-         t << "{" << endl;
+      return a.name < b.name;
+   } );
 
-         first = true;
-         j = 0;
+   QString sectionLetters[NUM_SEARCH_INDICES];
+   QStringList sectionShards[NUM_SEARCH_INDICES];
 
-         for (int i = 0; i < NUM_SEARCH_INDICES; i++) {
-            if (g_searchIndexCount[i] > 0) {
-               if (!first) {
-                  t << "," << endl;
-               }
+   for (int i = 0; i < NUM_SEARCH_INDICES; i++) {
 
-               t << "  " << j << ": \"" << g_searchIndexName[i] << "\"";
-               first = false;
-               j++;
-            }
-         }
+      if (letterSet[i].isEmpty()) {
+         continue;
+      }
 
-         if (! first) {
-            t << "\n";
-         }
+      QList<uint> letterList = letterSet[i].toList();
+      std::sort(letterList.begin(), letterList.end());
 
-         t << "};" << endl << endl;
-         t << "var indexSectionLabels =" << endl;
-         t << "{" << endl;
+      for (auto letter : letterList) {
+         sectionLetters[i] += QString( QChar( letter ) );
+      }
 
-         first = true;
-         static SearchIndexCategoryMapping map;
-         j = 0;
+      SearchShardWriter writer(searchDirName, g_searchIndexName[i]);
 
-         for (int i = 0; i < NUM_SEARCH_INDICES; i++) {
-            if (g_searchIndexCount[i] > 0) {
+      const uint mask = SEARCH_INDEX_BIT(i);
+      int k = 0;
 
-               if (!first) {
-                  t << "," << endl;
-               }
+      while (k < symbolList.count()) {
+         const CompactSearchSymbol &symbol = symbolList.at(k);
 
-               t << "  " << j << ": \"" << convertToXML(map.categoryLabel[i]) << "\"";
-               first = false;
-               j++;
-            }
+         if (! (symbol.indexMask & mask)) {
+            k++;
+            continue;
          }
 
-         if (!first) {
-            t << "\n";
+         // symbols with the same name are shown as one entry
+         QList<QSharedPointer<Definition>> defList;
+
+         while (k < symbolList.count() && symbolList.at(k).id == symbol.id && symbolList.at(k).name == symbol.name) {
+            if (symbolList.at(k).indexMask & mask) {
+               defList.append(symbolList.at(k).def);
+            }
+
+            k++;
          }
 
-         t << "};" << endl << endl;
+         writer.addEntry(symbol.id, convertToXML(symbol.dispName), searchResultLinks(defList));
       }
 
-      ResourceMgr::instance().copyResourceAs("html/search.js", searchDirName, "search.js");
+      writer.finish();
+      sectionShards[i] = writer.firstIds();
+   }
+
+   writeSearchData(searchDirName, sectionLetters, sectionShards);
+
+   // a single results page, the shards are selected from the search text
+   QFile f(searchDirName + "/results.html");
+
+   if (f.open(QIODevice::WriteOnly)) {
+      QTextStream t(&f);
+
+      t << "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Transitional//EN\""
+        " \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-transitional.dtd\">" << endl;
+      t << "<html><head><title></title>" << endl;
+      t << "<meta http-equiv=\"Content-Type\" content=\"text/xhtml;charset=UTF-8\"/>" << endl;
+      t << "<meta name=\"generator\" content=\"DoxyPress " << versionString << "\"/>" << endl;
+      t << "<link rel=\"stylesheet\" type=\"text/css\" href=\"search.css\"/>" << endl;
+      t << "<script type=\"text/javascript\" src=\"searchdata.js\"></script>" << endl;
+      t << "<script type=\"text/javascript\" src=\"search.js\"></script>" << endl;
+      t << "</head>" << endl;
+      t << "<body class=\"SRPage\">" << endl;
+      t << "<div id=\"SRIndex\">" << endl;
+      t << "<div class=\"SRStatus\" id=\"Loading\">" << theTranslator->trLoading() << "</div>" << endl;
+      t << "<div id=\"SRResults\"></div>" << endl;
+
+      t << "<div class=\"SRStatus\" id=\"Searching\">"
+        << theTranslator->trSearching() << "</div>" << endl;
+
+      t << "<div class=\"SRStatus\" id=\"NoMatches\">"
+        << theTranslator->trNoMatches() << "</div>" << endl;
+
+      t << "<script type=\"text/javascript\"><!--" << endl;
+      t << "document.getElementById(\"NoMatches\").style.display=\"none\";" << endl;
+      t << "var searchResults = new SearchResults(\"searchResults\");" << endl;
+      t << "loadSearchShards();" << endl;   // calls createResults() once the shards are loaded
+      t << "--></script>" << endl;
+      t << "</div>" << endl; // SRIndex
+      t << "</body>" << endl;
+      t << "</html>" << endl;
+
+   } else {
+      err("Unable to open file for writing %s, error: %d\n", qPrintable(f.fileName()), f.error());
+
+   }
+}
+
+void writeJavascriptSearchIndex()
+{
+   if (! Config::getBool("generate-html")) {
+      return;
+   }
+
+   static const bool compactIndex = Config::getBool("search-compact-index");
+
+   // write index files
+   QString searchDirName = Config::getString("html-output") + "/search";
+
+   if (compactIndex) {
+      writeCompactSearchIndex(searchDirName);
+
+   } else {
+      writeLetterSearchIndex(searchDirName);
+
    }
 
    {
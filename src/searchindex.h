@@ -18,10 +18,14 @@
 #ifndef SEARCHINDEX_H
 #define SEARCHINDEX_H
 
+#include <QFile>
 #include <QHash>
 #include <QList>
+#include <QPair>
 #include <QVector>
 
+#include <functional>
+
 #include <stringmap.h>
 
 class Definition;
@@ -38,12 +42,6 @@ struct URL {
    QString url;
 };
 
-struct URLInfo {
-   URLInfo(int idx, int f) : urlIdx(idx), freq(f) {}
-   int urlIdx;
-   int freq;
-};
-
 class SearchDefinitionList : public QList<QSharedPointer<Definition>>
 {
    public:
@@ -58,25 +56,6 @@ class SearchDefinitionList : public QList<QSharedPointer<Definition>>
       uint m_letter;
 };
 
-class IndexWord
-{
- public:
-   IndexWord(const QString &word);
-   void addUrlIndex(int, bool);
-
-   const QHash<long, QSharedPointer<URLInfo>> &urls() const {
-      return m_urls;
-   }
-
-   QString word() const {
-      return m_word;
-   }
-
- private:
-   QString m_word;
-   QHash<long, QSharedPointer<URLInfo>> m_urls;
-};
-
 class SearchIndex_Base
 {
  public:
@@ -108,10 +87,33 @@ class SearchIndex : public SearchIndex_Base
    void addWord(const QString &word, bool hiPriority) override;
    void write(const QString &file) override;
 
+   // writes search.idx and, when mappedFile is not empty, the same postings in the search.dxi
+   // format, see searchfile.h
+   void write(const QString &file, const QString &mappedFile);
+
  private:
+   using PostingsFunc = std::function<void (const QString &, const QVector<QPair<int, int>> &)>;
+
    void addWord(const QString &word, bool hiPrio, bool recurse);
 
-   QMap<QString, QSharedPointer<IndexWord>> m_words;
+   void spillPostings();
+   void mergePostings(PostingsFunc func);
+
+   // interned words, the id of a word is its position in m_wordList
+   QHash<QString, int> m_wordIds;
+   QVector<QString>    m_wordList;
+
+   // for each word id pairs of url index and frequency, the frequency is twice the number of hits
+   // and bit 0 marks a high priority document
+   QVector<QVector<quint32>> m_postings;
+
+   qint64 m_numPostings;
+   qint64 m_maxPostings;
+
+   // sorted runs of postings moved out of memory when search-index-memory is exceeded
+   QString m_spillFileName;
+   QFile   m_spillFile;
+   QVector<QPair<qint64, qint64>> m_spillRuns;
 
    QHash<QString,int> m_url2IdMap;
    QHash<long, QSharedPointer<URL>> m_urls;
@@ -129,12 +131,36 @@ class SearchIndex_External : public SearchIndex_Base
    void addWord(const QString &word, bool hiPriority) override;
    void write(const QString &file) override;
 
- private:   
+ private:
+   bool openStream();
+   void flushCurrent();
+   void mergeDeferred();
+
    StringMap<QSharedPointer<SearchDocEntry>> m_docEntries;
    QSharedPointer<SearchDocEntry> m_current;
-
+   QString m_currentKey;
+
+   // position of the end of the keywords and the text value of a document in the search data file
+   struct WrittenDoc {
+      qint64 keywordsEnd;
+      qint64 textEnd;
+      bool   hasKeywords;
+      bool   hasText;
+   };
+
+   // with search-data-streaming each document is appended to the search data file when the
+   // next one starts, the words of a document visited again after it was written are kept
+   // until write() and then inserted at the saved positions
+   bool  m_streaming;
+   bool  m_currentDeferred;
+   QFile m_streamFile;
+
+   QHash<QString, WrittenDoc> m_writtenDocs;
 };
 
+// full path of the data file written for an external search engine
+QString externalSearchDataFile();
+
 void writeJavascriptSearchIndex();
 
 #endif
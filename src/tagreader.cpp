@@ -15,9 +15,13 @@
  *
 *************************************************************************/
 
-#include <QHash>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QList>
+#include <QSet>
 #include <QStack>
 #include <QString>
 #include <QStringList>
@@ -29,15 +33,19 @@
 #include <QXmlParseException>
 #include <QXmlSimpleReader>
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include <tagreader.h>
 
 #include <arguments.h>
+#include <config.h>
 #include <default_args.h>
 #include <doxy_globals.h>
 #include <entry.h>
+#include <marshal.h>
 #include <message.h>
 #include <util.h>
 
@@ -104,24 +112,17 @@ class TagClassInfo
    enum Kind { Class, Struct, Union, Interface, Exception, Protocol, Category, Enum, Service, Singleton };
 
    TagClassInfo() {
-      bases = 0;
-      templateArguments = 0;
       isObjC = false;
    }
 
-   ~TagClassInfo() {
-      delete bases;
-      delete templateArguments;
-   }
-
    QString name;
    QString filename;
    QString clangId;
 
    TagAnchorInfoList      docAnchors;
-   QVector<BaseInfo>     *bases;
+   QVector<BaseInfo>      bases;
    QList<TagMemberInfo>   members;
-   QList<QString>        *templateArguments;
+   QStringList            templateArguments;
 
    QStringList classList;
    Kind kind;
@@ -730,11 +731,7 @@ class TagFileParser : public QXmlDefaultHandler
             virt = Virtual;
          }
 
-         if (m_curClass->bases == 0) {
-            m_curClass->bases = new QVector<BaseInfo>;
-         }
-
-         m_curClass->bases->append(BaseInfo(m_curString, prot, virt));
+         m_curClass->bases.append(BaseInfo(m_curString, prot, virt));
 
       } else {
          warn("Unexpected tag `base' found\n");
@@ -743,7 +740,7 @@ class TagFileParser : public QXmlDefaultHandler
 
    void endBase() {
       if (m_state == InClass && m_curClass) {
-         m_curClass->bases->last().name = m_curString;
+         m_curClass->bases.last().name = m_curString;
 
       } else {
          warn("Unexpected tag `base' found\n");
@@ -774,11 +771,7 @@ class TagFileParser : public QXmlDefaultHandler
 
    void endTemplateArg() {
       if (m_state == InClass && m_curClass) {
-         if (m_curClass->templateArguments == 0) {
-            m_curClass->templateArguments = new QList<QString>;
-         }
-
-         m_curClass->templateArguments->append(m_curString);
+         m_curClass->templateArguments.append(m_curString);
 
       } else {
          warn("Unexpected tag templarg found\n");
@@ -998,8 +991,14 @@ class TagFileParser : public QXmlDefaultHandler
    void buildLists(QSharedPointer<Entry> root);
    void addIncludes();
 
+   void selectReferenced();
+   bool addReferencedBases();
+
+   bool readCache(const QString &cacheName, const QByteArray &hash);
+   void writeCache(const QString &cacheName, const QByteArray &hash);
+
  private:
-   void buildMemberList(QSharedPointer<Entry> ce, QList<TagMemberInfo> &members);
+   void buildMemberList(QSharedPointer<Entry> ce, QList<TagMemberInfo> &members, bool onlyReferenced = false);
    void addDocAnchors(QSharedPointer<Entry> e, const TagAnchorInfoList &l);
 
    QList<TagClassInfo>        m_tagFileClasses;
@@ -1010,6 +1009,10 @@ class TagFileParser : public QXmlDefaultHandler
    QList<TagPackageInfo>      m_tagFilePackages;
    QList<TagDirInfo>          m_tagFileDirs;
 
+   // with tag-files-lazy the classes and namespaces which are added, set by selectReferenced()
+   QVector<bool>              m_useClass;
+   QVector<bool>              m_useNamespace;
+
    QHash<QString, StartElementHandler>  m_startElementHandlers;
    QHash<QString, EndElementHandler>    m_endElementHandlers;
 
@@ -1043,6 +1046,10 @@ class TagFileParser : public QXmlDefaultHandler
 class TagFileErrorHandler : public QXmlErrorHandler
 {
  public:
+   TagFileErrorHandler()
+      : m_hasError(false)
+   {}
+
    virtual ~TagFileErrorHandler() {}
 
    bool warning( const QXmlParseException &) override {
@@ -1050,12 +1057,15 @@ class TagFileErrorHandler : public QXmlErrorHandler
    }
 
    bool error( const QXmlParseException &) override {
+      m_hasError = true;
       return false;
    }
 
    bool fatalError( const QXmlParseException &exception ) override {
       err("Error at line %d column %d: %s\n",
           exception.lineNumber(), exception.columnNumber(), csPrintable(exception.message()) );
+
+      m_hasError = true;
       return false;
    }
 
@@ -1063,10 +1073,638 @@ class TagFileErrorHandler : public QXmlErrorHandler
       return "";
    }
 
+   bool hasError() const {
+      return m_hasError;
+   }
+
  private:
    QString errorMsg;
+   bool m_hasError;
 };
 
+// ** referenced words
+
+// identifiers which occur in the input files, with tag-files-lazy tag file symbols which are not
+// in this set are not added to the Entry tree
+static QSet<QString> s_referencedWords;
+static bool s_hasReferencedWords = false;
+
+// with tag-files-lazy the parsed tag files, added to the Entry tree by buildReferencedTagFiles()
+static QList<QSharedPointer<TagFileParser>> s_lazyTagFiles;
+
+static void addReferencedWords(const QByteArray &data)
+{
+   const char *p   = data.constData();
+   const char *end = p + data.size();
+
+   while (p < end) {
+      const uchar c = *p;
+
+      if (isalpha(c) || c == '_' || c >= 0x80) {
+         const char *start = p;
+
+         while (p < end && (isalnum((uchar)*p) || *p == '_' || (uchar)*p >= 0x80)) {
+            ++p;
+         }
+
+         s_referencedWords.insert(QString::fromUtf8(start, p - start));
+
+      } else if (isdigit(c)) {
+         // skip numbers so 0x1f does not add x1f
+         while (p < end && (isalnum((uchar)*p) || *p == '_')) {
+            ++p;
+         }
+
+      } else {
+         ++p;
+      }
+   }
+}
+
+void collectTagReferences(const QStringList &fileList)
+{
+   s_referencedWords.clear();
+
+   for (const auto &fileName : fileList) {
+      QString contents;
+
+      // read through the input filter, the output is cached for the parser
+      if (readInputFile(fileName, contents)) {
+         addReferencedWords(contents.toUtf8());
+      }
+   }
+
+   s_hasReferencedWords = true;
+}
+
+void releaseTagReferences()
+{
+   // assignment releases the memory, clear() keeps the bucket array
+   s_referencedWords    = QSet<QString>();
+   s_hasReferencedWords = false;
+}
+
+// ** tag file cache
+
+// the cache holds the structures of the tag file parser, written with the functions of marshal.h
+//   magic, version, MD5 hash of the tag file, then the list of classes, files, namespaces,
+//   packages, groups, pages and directories
+
+static const uint s_tagCacheMagic   = 0x44544743;      // DTGC
+static const uint s_tagCacheVersion = 1;
+
+/** Storage for the tag file cache, reads from a mapped cache file or writes to a buffer */
+class TagCacheStorage : public StorageIntf
+{
+ public:
+   TagCacheStorage()
+      : m_data(nullptr), m_size(0), m_pos(0), m_error(false)
+   {}
+
+   TagCacheStorage(const uchar *data, qint64 size)
+      : m_data(data), m_size(size), m_pos(0), m_error(false)
+   {}
+
+   int read(char *buf, uint size) override {
+      if (m_error || m_pos + size > m_size) {
+         // values read after the end are zero, the loops of readCache() stop at the first error
+         memset(buf, 0, size);
+         m_error = true;
+
+         return -1;
+      }
+
+      memcpy(buf, m_data + m_pos, size);
+      m_pos += size;
+
+      return size;
+   }
+
+   int write(const char *buf, uint size) override {
+      m_buffer.append(buf, size);
+      return size;
+   }
+
+   const QByteArray &buffer() const {
+      return m_buffer;
+   }
+
+   bool hasError() const {
+      return m_error;
+   }
+
+   void setError() {
+      m_error = true;
+   }
+
+   // number of bytes which are left to read
+   qint64 remaining() const {
+      return m_size - m_pos;
+   }
+
+ private:
+   const uchar *m_data;
+   qint64       m_size;
+   qint64       m_pos;
+   bool         m_error;
+
+   QByteArray   m_buffer;
+};
+
+// reads the number of items in a list, every item takes at least four bytes so a count larger
+// than the rest of the file can hold means the cache is corrupt
+static uint unmarshalCount(TagCacheStorage *s)
+{
+   uint count = unmarshalUInt(s);
+
+   if (count > s->remaining() / 4) {
+      s->setError();
+      return 0;
+   }
+
+   return count;
+}
+
+static QByteArray unmarshalCacheBytes(TagCacheStorage *s)
+{
+   uint len = unmarshalUInt(s);
+
+   if (len > s->remaining()) {
+      s->setError();
+      return QByteArray();
+   }
+
+   QByteArray retval;
+   retval.resize(len);
+
+   if (len > 0) {
+      s->read(retval.data(), len);
+   }
+
+   return retval;
+}
+
+static QString unmarshalCacheString(TagCacheStorage *s)
+{
+   return QString::fromUtf8(unmarshalCacheBytes(s));
+}
+
+static QVector<BaseInfo> unmarshalBases(TagCacheStorage *s)
+{
+   QVector<BaseInfo> retval;
+   uint count = unmarshalUInt(s);
+
+   if (count == NULL_LIST) {
+      return retval;
+   }
+
+   if (count > s->remaining() / 4) {
+      s->setError();
+      return retval;
+   }
+
+   for (uint i = 0; i < count && ! s->hasError(); i++) {
+      QString name    = unmarshalCacheString(s);
+      Protection prot = static_cast<Protection>(unmarshalInt(s));
+      Specifier virt  = static_cast<Specifier>(unmarshalInt(s));
+
+      retval.append(BaseInfo(name, prot, virt));
+   }
+
+   return retval;
+}
+
+static void marshalStringList(StorageIntf *s, const QStringList &list)
+{
+   marshalUInt(s, list.count());
+
+   for (const auto &item : list) {
+      marshalQString(s, item);
+   }
+}
+
+static QStringList unmarshalStringList(TagCacheStorage *s)
+{
+   QStringList retval;
+   uint count = unmarshalCount(s);
+
+   for (uint i = 0; i < count && ! s->hasError(); i++) {
+      retval.append(unmarshalCacheString(s));
+   }
+
+   return retval;
+}
+
+static void marshalAnchors(StorageIntf *s, const TagAnchorInfoList &list)
+{
+   marshalUInt(s, list.count());
+
+   for (const auto &item : list) {
+      marshalQString(s, item.label);
+      marshalQString(s, item.fileName);
+      marshalQString(s, item.title);
+   }
+}
+
+static TagAnchorInfoList unmarshalAnchors(TagCacheStorage *s)
+{
+   TagAnchorInfoList retval;
+   uint count = unmarshalCount(s);
+
+   for (uint i = 0; i < count && ! s->hasError(); i++) {
+      QString label    = unmarshalCacheString(s);
+      QString fileName = unmarshalCacheString(s);
+      QString title    = unmarshalCacheString(s);
+
+      retval.append(TagAnchorInfo(fileName, label, title));
+   }
+
+   return retval;
+}
+
+static void marshalMembers(StorageIntf *s, const QList<TagMemberInfo> &list)
+{
+   marshalUInt(s, list.count());
+
+   for (const auto &item : list) {
+      marshalQString(s, item.type);
+      marshalQString(s, item.name);
+      marshalQString(s, item.anchorFile);
+      marshalQString(s, item.anchor);
+      marshalQString(s, item.arglist);
+      marshalQString(s, item.kind);
+      marshalQString(s, item.clangId);
+
+      marshalAnchors(s, item.docAnchors);
+
+      marshalInt(s, item.prot);
+      marshalInt(s, item.virt);
+      marshalBool(s, item.isStatic);
+
+      marshalUInt(s, item.enumValues.count());
+
+      for (const auto &value : item.enumValues) {
+         marshalQString(s, value.name);
+         marshalQString(s, value.file);
+         marshalQString(s, value.anchor);
+         marshalQString(s, value.clangid);
+      }
+   }
+}
+
+static QList<TagMemberInfo> unmarshalMembers(TagCacheStorage *s)
+{
+   QList<TagMemberInfo> retval;
+   uint count = unmarshalCount(s);
+
+   for (uint i = 0; i < count && ! s->hasError(); i++) {
+      TagMemberInfo item;
+
+      item.type       = unmarshalCacheString(s);
+      item.name       = unmarshalCacheString(s);
+      item.anchorFile = unmarshalCacheString(s);
+      item.anchor     = unmarshalCacheString(s);
+      item.arglist    = unmarshalCacheString(s);
+      item.kind       = unmarshalCacheString(s);
+      item.clangId    = unmarshalCacheString(s);
+
+      item.docAnchors = unmarshalAnchors(s);
+
+      item.prot       = static_cast<Protection>(unmarshalInt(s));
+      item.virt       = static_cast<Specifier>(unmarshalInt(s));
+      item.isStatic   = unmarshalBool(s);
+
+      uint valueCount = unmarshalCount(s);
+
+      for (uint k = 0; k < valueCount && ! s->hasError(); k++) {
+         TagEnumValueInfo value;
+
+         value.name    = unmarshalCacheString(s);
+         value.file    = unmarshalCacheString(s);
+         value.anchor  = unmarshalCacheString(s);
+         value.clangid = unmarshalCacheString(s);
+
+         item.enumValues.append(value);
+      }
+
+      retval.append(item);
+   }
+
+   return retval;
+}
+
+bool TagFileParser::readCache(const QString &cacheName, const QByteArray &hash)
+{
+   QFile f(cacheName);
+
+   if (! f.open(QIODevice::ReadOnly)) {
+      return false;
+   }
+
+   const qint64 size = f.size();
+   uchar *data = f.map(0, size);
+
+   if (data == nullptr) {
+      return false;
+   }
+
+   TagCacheStorage s(data, size);
+
+   if (unmarshalUInt(&s) != s_tagCacheMagic || unmarshalUInt(&s) != s_tagCacheVersion ||
+         unmarshalCacheBytes(&s) != hash) {
+
+      f.unmap(data);
+      return false;
+   }
+
+   uint count = unmarshalCount(&s);
+
+   for (uint i = 0; i < count && ! s.hasError(); i++) {
+      TagClassInfo item;
+
+      item.name              = unmarshalCacheString(&s);
+      item.filename          = unmarshalCacheString(&s);
+      item.clangId           = unmarshalCacheString(&s);
+      item.docAnchors        = unmarshalAnchors(&s);
+      item.bases             = unmarshalBases(&s);
+      item.members           = unmarshalMembers(&s);
+      item.templateArguments = unmarshalStringList(&s);
+      item.classList         = unmarshalStringList(&s);
+      item.kind              = static_cast<TagClassInfo::Kind>(unmarshalInt(&s));
+      item.isObjC            = unmarshalBool(&s);
+
+      m_tagFileClasses.append(item);
+   }
+
+   count = unmarshalCount(&s);
+
+   for (uint i = 0; i < count && ! s.hasError(); i++) {
+      TagFileInfo item;
+
+      item.name          = unmarshalCacheString(&s);
+      item.path          = unmarshalCacheString(&s);
+      item.filename      = unmarshalCacheString(&s);
+      item.docAnchors    = unmarshalAnchors(&s);
+      item.members       = unmarshalMembers(&s);
+      item.classList     = unmarshalStringList(&s);
+      item.namespaceList = unmarshalStringList(&s);
+
+      uint includeCount = unmarshalCount(&s);
+
+      for (uint k = 0; k < includeCount && ! s.hasError(); k++) {
+         TagIncludeInfo include;
+
+         include.id         = unmarshalCacheString(&s);
+         include.name       = unmarshalCacheString(&s);
+         include.text       = unmarshalCacheString(&s);
+         include.isLocal    = unmarshalBool(&s);
+         include.isImported = unmarshalBool(&s);
+
+         item.includes.append(include);
+      }
+
+      m_tagFileFiles.append(item);
+   }
+
+   count = unmarshalCount(&s);
+
+   for (uint i = 0; i < count && ! s.hasError(); i++) {
+      TagNamespaceInfo item;
+
+      item.name          = unmarshalCacheString(&s);
+      item.filename      = unmarshalCacheString(&s);
+      item.clangId       = unmarshalCacheString(&s);
+      item.classList     = unmarshalStringList(&s);
+      item.namespaceList = unmarshalStringList(&s);
+      item.docAnchors    = unmarshalAnchors(&s);
+      item.members       = unmarshalMembers(&s);
+
+      m_tagFileNamespaces.append(item);
+   }
+
+   count = unmarshalCount(&s);
+
+   for (uint i = 0; i < count && ! s.hasError(); i++) {
+      TagPackageInfo item;
+
+      item.name       = unmarshalCacheString(&s);
+      item.filename   = unmarshalCacheString(&s);
+      item.docAnchors = unmarshalAnchors(&s);
+      item.members    = unmarshalMembers(&s);
+      item.classList  = unmarshalStringList(&s);
+
+      m_tagFilePackages.append(item);
+   }
+
+   count = unmarshalCount(&s);
+
+   for (uint i = 0; i < count && ! s.hasError(); i++) {
+      TagGroupInfo item;
+
+      item.name          = unmarshalCacheString(&s);
+      item.title         = unmarshalCacheString(&s);
+      item.filename      = unmarshalCacheString(&s);
+      item.docAnchors    = unmarshalAnchors(&s);
+      item.members       = unmarshalMembers(&s);
+      item.subgroupList  = unmarshalStringList(&s);
+      item.classList     = unmarshalStringList(&s);
+      item.namespaceList = unmarshalStringList(&s);
+      item.fileList      = unmarshalStringList(&s);
+      item.pageList      = unmarshalStringList(&s);
+      item.dirList       = unmarshalStringList(&s);
+
+      m_tagFileGroups.append(item);
+   }
+
+   count = unmarshalCount(&s);
+
+   for (uint i = 0; i < count && ! s.hasError(); i++) {
+      TagPageInfo item;
+
+      item.name       = unmarshalCacheString(&s);
+      item.title      = unmarshalCacheString(&s);
+      item.filename   = unmarshalCacheString(&s);
+      item.docAnchors = unmarshalAnchors(&s);
+
+      m_tagFilePages.append(item);
+   }
+
+   count = unmarshalCount(&s);
+
+   for (uint i = 0; i < count && ! s.hasError(); i++) {
+      TagDirInfo item;
+
+      item.name       = unmarshalCacheString(&s);
+      item.filename   = unmarshalCacheString(&s);
+      item.path       = unmarshalCacheString(&s);
+      item.subdirList = unmarshalStringList(&s);
+      item.fileList   = unmarshalStringList(&s);
+      item.docAnchors = unmarshalAnchors(&s);
+
+      m_tagFileDirs.append(item);
+   }
+
+   f.unmap(data);
+
+   if (s.hasError()) {
+      // truncated cache file, parse the tag file again
+      m_tagFileClasses.clear();
+      m_tagFileFiles.clear();
+      m_tagFileNamespaces.clear();
+      m_tagFilePackages.clear();
+      m_tagFileGroups.clear();
+      m_tagFilePages.clear();
+      m_tagFileDirs.clear();
+
+      return false;
+   }
+
+   return true;
+}
+
+void TagFileParser::writeCache(const QString &cacheName, const QByteArray &hash)
+{
+   TagCacheStorage s;
+
+   marshalUInt(&s, s_tagCacheMagic);
+   marshalUInt(&s, s_tagCacheVersion);
+   marshalQByteArray(&s, hash);
+
+   marshalUInt(&s, m_tagFileClasses.count());
+
+   for (auto &item : m_tagFileClasses) {
+      marshalQString(&s, item.name);
+      marshalQString(&s, item.filename);
+      marshalQString(&s, item.clangId);
+      marshalAnchors(&s, item.docAnchors);
+      marshalBaseInfoList(&s, &item.bases);
+      marshalMembers(&s, item.members);
+      marshalStringList(&s, item.templateArguments);
+      marshalStringList(&s, item.classList);
+      marshalInt(&s, item.kind);
+      marshalBool(&s, item.isObjC);
+   }
+
+   marshalUInt(&s, m_tagFileFiles.count());
+
+   for (const auto &item : m_tagFileFiles) {
+      marshalQString(&s, item.name);
+      marshalQString(&s, item.path);
+      marshalQString(&s, item.filename);
+      marshalAnchors(&s, item.docAnchors);
+      marshalMembers(&s, item.members);
+      marshalStringList(&s, item.classList);
+      marshalStringList(&s, item.namespaceList);
+
+      marshalUInt(&s, item.includes.count());
+
+      for (const auto &include : item.includes) {
+         marshalQString(&s, include.id);
+         marshalQString(&s, include.name);
+         marshalQString(&s, include.text);
+         marshalBool(&s, include.isLocal);
+         marshalBool(&s, include.isImported);
+      }
+   }
+
+   marshalUInt(&s, m_tagFileNamespaces.count());
+
+   for (const auto &item : m_tagFileNamespaces) {
+      marshalQString(&s, item.name);
+      marshalQString(&s, item.filename);
+      marshalQString(&s, item.clangId);
+      marshalStringList(&s, item.classList);
+      marshalStringList(&s, item.namespaceList);
+      marshalAnchors(&s, item.docAnchors);
+      marshalMembers(&s, item.members);
+   }
+
+   marshalUInt(&s, m_tagFilePackages.count());
+
+   for (const auto &item : m_tagFilePackages) {
+      marshalQString(&s, item.name);
+      marshalQString(&s, item.filename);
+      marshalAnchors(&s, item.docAnchors);
+      marshalMembers(&s, item.members);
+      marshalStringList(&s, item.classList);
+   }
+
+   marshalUInt(&s, m_tagFileGroups.count());
+
+   for (const auto &item : m_tagFileGroups) {
+      marshalQString(&s, item.name);
+      marshalQString(&s, item.title);
+      marshalQString(&s, item.filename);
+      marshalAnchors(&s, item.docAnchors);
+      marshalMembers(&s, item.members);
+      marshalStringList(&s, item.subgroupList);
+      marshalStringList(&s, item.classList);
+      marshalStringList(&s, item.namespaceList);
+      marshalStringList(&s, item.fileList);
+      marshalStringList(&s, item.pageList);
+      marshalStringList(&s, item.dirList);
+   }
+
+   marshalUInt(&s, m_tagFilePages.count());
+
+   for (const auto &item : m_tagFilePages) {
+      marshalQString(&s, item.name);
+      marshalQString(&s, item.title);
+      marshalQString(&s, item.filename);
+      marshalAnchors(&s, item.docAnchors);
+   }
+
+   marshalUInt(&s, m_tagFileDirs.count());
+
+   for (const auto &item : m_tagFileDirs) {
+      marshalQString(&s, item.name);
+      marshalQString(&s, item.filename);
+      marshalQString(&s, item.path);
+      marshalStringList(&s, item.subdirList);
+      marshalStringList(&s, item.fileList);
+      marshalAnchors(&s, item.docAnchors);
+   }
+
+   QFileInfo fi(cacheName);
+   QDir().mkpath(fi.absolutePath());
+
+   // a partly written cache file is never used, it is renamed when complete
+   QString tempName = cacheName + ".tmp";
+   QFile f(tempName);
+
+   if (! f.open(QIODevice::WriteOnly)) {
+      return;
+   }
+
+   bool ok = (f.write(s.buffer()) == s.buffer().size());
+   f.close();
+
+   QFile::remove(cacheName);
+
+   if (! ok || ! QFile::rename(tempName, cacheName)) {
+      QFile::remove(tempName);
+   }
+}
+
+// name of the cache file for the tag file fullName, empty when tag-cache-dir is not set
+static QString tagCacheFileName(const QString &fullName)
+{
+   QString cacheDir = Config::getString("tag-cache-dir");
+
+   if (cacheDir.isEmpty()) {
+      return QString();
+   }
+
+   if (! QDir::isAbsolutePath(cacheDir)) {
+      cacheDir.prepend(Config::getString("output-dir") + "/");
+   }
+
+   // tag files with the same name in different directories each have their own cache
+   QString pathHash = QCryptographicHash::hash(fullName.toUtf8(), QCryptographicHash::Md5).toHex().left(8);
+
+   return cacheDir + "/" + QFileInfo(fullName).completeBaseName() + "_" + pathHash + ".tagc";
+}
+
 /*! Dumps the internal structures. For debugging only */
 void TagFileParser::dump()
 {
@@ -1077,10 +1715,8 @@ void TagFileParser::dump()
       msg("class `%s'\n",      csPrintable(cd.name));
       msg("  filename `%s'\n", csPrintable(cd.filename));
 
-      if (cd.bases) {
-         for (auto bi : *cd.bases) {
-            msg( "  base: %s \n", csPrintable(bi.name) );
-         }
+      for (auto bi : cd.bases) {
+         msg( "  base: %s \n", csPrintable(bi.name) );
       }
 
       for (auto md : cd.members) {
@@ -1212,9 +1848,14 @@ void TagFileParser::addDocAnchors(QSharedPointer<Entry> e, const TagAnchorInfoLi
    }
 }
 
-void TagFileParser::buildMemberList(QSharedPointer<Entry> ce, QList<TagMemberInfo> &members)
+void TagFileParser::buildMemberList(QSharedPointer<Entry> ce, QList<TagMemberInfo> &members, bool onlyReferenced)
 {
    for (auto tmi : members) {
+
+      if (onlyReferenced && ! s_referencedWords.contains(tmi.name)) {
+         continue;
+      }
+
       QSharedPointer<Entry> me = QMakeShared<Entry>();
 
       me->type  = tmi.type;
@@ -1337,15 +1978,175 @@ static QString stripPath_tag(const QString &s)
    }
 }
 
+// name without scope and template arguments, used to match the words of the input files
+static QString tagSimpleName(const QString &name)
+{
+   QString retval = name;
+
+   int i = retval.indexOf('<');
+
+   if (i != -1) {
+      retval.truncate(i);
+   }
+
+   i = retval.lastIndexOf("::");
+
+   if (i != -1) {
+      retval = retval.mid(i + 2);
+   }
+
+   return retval.trimmed();
+}
+
+// selects the classes and namespaces named in the input files, together with their enclosing
+// scopes and their base classes
+void TagFileParser::selectReferenced()
+{
+   m_useClass.fill(false, m_tagFileClasses.count());
+   m_useNamespace.fill(false, m_tagFileNamespaces.count());
+
+   QHash<QString, QList<int>> classByName;
+   QHash<QString, int> namespaceByName;
+
+   for (int i = 0; i < m_tagFileClasses.count(); i++) {
+      const TagClassInfo &tci = m_tagFileClasses[i];
+
+      classByName[tci.name].append(i);
+      classByName[tagSimpleName(tci.name)].append(i);
+   }
+
+   for (int i = 0; i < m_tagFileNamespaces.count(); i++) {
+      namespaceByName.insert(m_tagFileNamespaces[i].name, i);
+   }
+
+   QList<int> pending;
+
+   auto useScope = [&] (const QString &name) {
+      // enclosing namespaces and classes of name
+      int i = name.indexOf("::");
+
+      while (i != -1) {
+         const QString scope = name.left(i);
+         const int ni = namespaceByName.value(scope, -1);
+
+         if (ni != -1) {
+            m_useNamespace[ni] = true;
+         }
+
+         for (int ci : classByName.value(scope)) {
+            if (! m_useClass[ci]) {
+               m_useClass[ci] = true;
+               pending.append(ci);
+            }
+         }
+
+         i = name.indexOf("::", i + 2);
+      }
+   };
+
+   for (int i = 0; i < m_tagFileClasses.count(); i++) {
+      const TagClassInfo &tci = m_tagFileClasses[i];
+
+      if (s_referencedWords.contains(tagSimpleName(tci.name))) {
+         m_useClass[i] = true;
+         pending.append(i);
+      }
+   }
+
+   for (int i = 0; i < m_tagFileNamespaces.count(); i++) {
+      const QString &name = m_tagFileNamespaces[i].name;
+
+      if (s_referencedWords.contains(tagSimpleName(name))) {
+         m_useNamespace[i] = true;
+         useScope(name);
+      }
+   }
+
+   while (! pending.isEmpty()) {
+      const TagClassInfo &tci = m_tagFileClasses[pending.takeLast()];
+
+      useScope(tci.name);
+
+      for (const auto &bi : tci.bases) {
+         QString baseName = bi.name;
+         int i = baseName.indexOf('<');
+
+         if (i != -1) {
+            baseName = baseName.left(i).trimmed();
+         }
+
+         QList<int> list = classByName.value(baseName);
+
+         if (list.isEmpty()) {
+            list = classByName.value(tagSimpleName(baseName));
+         }
+
+         for (int ci : list) {
+            if (! m_useClass[ci]) {
+               m_useClass[ci] = true;
+               pending.append(ci);
+            }
+         }
+      }
+   }
+}
+
+// adds the names of the base classes of the selected classes to the referenced words, the base
+// class can be in another tag file, returns true if a name was added
+bool TagFileParser::addReferencedBases()
+{
+   bool retval = false;
+
+   for (int i = 0; i < m_tagFileClasses.count(); i++) {
+
+      if (! m_useClass[i]) {
+         continue;
+      }
+
+      for (const auto &bi : m_tagFileClasses[i].bases) {
+         QString baseName = bi.name;
+         int k = baseName.indexOf('<');
+
+         if (k != -1) {
+            baseName = baseName.left(k).trimmed();
+         }
+
+         baseName = tagSimpleName(baseName);
+
+         if (! s_referencedWords.contains(baseName)) {
+            s_referencedWords.insert(baseName);
+            retval = true;
+         }
+      }
+   }
+
+   return retval;
+}
+
 /*! Injects the info gathered by the XML parser into the Entry tree.
  *  This tree contains the information extracted from the input in a
  *  "unrelated" form.
  */
 void TagFileParser::buildLists(QSharedPointer<Entry> root)
 {
+   static const bool lazyTagFiles = Config::getBool("tag-files-lazy");
+
+   // with tag-files-lazy only the symbols named in the input files are added
+   const bool onlyReferenced = lazyTagFiles && s_hasReferencedWords;
+
+   if (onlyReferenced) {
+      msg("Tag file `%s', using %d of %d classes and %d of %d namespaces\n", csPrintable(m_tagName),
+            m_useClass.count(true), m_useClass.count(), m_useNamespace.count(true), m_useNamespace.count());
+   }
+
    // build class list
-   for (auto tci : m_tagFileClasses) {
+   for (int index = 0; index < m_tagFileClasses.count(); index++) {
+
+      if (onlyReferenced && ! m_useClass[index]) {
+         continue;
+      }
 
+      TagClassInfo &tci = m_tagFileClasses[index];
       QSharedPointer<Entry> ce = QMakeShared<Entry>();
       ce->section = Entry::CLASS_SEC;
 
@@ -1416,18 +2217,15 @@ void TagFileParser::buildLists(QSharedPointer<Entry> root)
       ce->lang           = tci.isObjC ? SrcLangExt_ObjC : SrcLangExt_Unknown;
 
       // transfer base class list
-      if (tci.bases) {
-         ce->extends = *tci.bases;
-
-         delete tci.bases;
-         tci.bases = 0;
+      if (! tci.bases.isEmpty()) {
+         ce->extends = tci.bases;
       }
 
-      if (tci.templateArguments) {
+      if (! tci.templateArguments.isEmpty()) {
          ArgumentList al;
          ce->m_templateArgLists.append(al);
 
-         for (auto argName : *tci.templateArguments) {
+         for (auto argName : tci.templateArguments) {
             Argument arg;
 
             arg.type = "class";
@@ -1473,12 +2271,18 @@ void TagFileParser::buildLists(QSharedPointer<Entry> root)
          Doxy_Globals::inputNameDict.insert(tfi.name, mn);
       }
 
-      buildMemberList(fe, tfi.members);
+      buildMemberList(fe, tfi.members, onlyReferenced);
       root->addSubEntry(fe, root);
    }
 
    // build namespace list
-   for (auto tni : m_tagFileNamespaces) {
+   for (int index = 0; index < m_tagFileNamespaces.count(); index++) {
+
+      if (onlyReferenced && ! m_useNamespace[index]) {
+         continue;
+      }
+
+      TagNamespaceInfo &tni = m_tagFileNamespaces[index];
       QSharedPointer<Entry> ne = QMakeShared<Entry>();
 
       ne->section  = Entry::NAMESPACE_SEC;
@@ -1492,7 +2296,7 @@ void TagFileParser::buildLists(QSharedPointer<Entry> root)
       ne->id              = tni.clangId;
       ne->m_tagInfoEntry  = ti;
 
-      buildMemberList(ne, tni.members);
+      buildMemberList(ne, tni.members, onlyReferenced);
       root->addSubEntry(ne, root);
    }
 
@@ -1510,7 +2314,7 @@ void TagFileParser::buildLists(QSharedPointer<Entry> root)
 
       pe->m_tagInfoEntry  = ti;
 
-      buildMemberList(pe, tpgi.members);
+      buildMemberList(pe, tpgi.members, onlyReferenced);
       root->addSubEntry(pe, root);
    }
 
@@ -1530,7 +2334,7 @@ void TagFileParser::buildLists(QSharedPointer<Entry> root)
 
       ge->m_tagInfoEntry  = ti;
 
-      buildMemberList(ge, tgi.members);
+      buildMemberList(ge, tgi.members, onlyReferenced);
       root->addSubEntry(ge, root);
    }
 
@@ -1598,24 +2402,79 @@ void parseTagFile(QSharedPointer<Entry> root, const QString &fullName)
       return;
    }
 
-   TagFileErrorHandler errorHandler;
-
    // tagName
-   TagFileParser handler(fullName);
-   handler.setFileName(fullName);
+   QSharedPointer<TagFileParser> handler = QMakeShared<TagFileParser>(fullName);
+   handler->setFileName(fullName);
 
-   //
    QFile xmlFile(fullName);
+
+   if (! xmlFile.open(QIODevice::ReadOnly)) {
+      err("Unable to open tag file %s, error: %d\n", csPrintable(fullName), xmlFile.error());
+      return;
+   }
+
    QByteArray data = xmlFile.readAll();
+   xmlFile.close();
+
+   const QString cacheName = tagCacheFileName(fullName);
+   QByteArray hash;
+
+   bool isCached = false;
 
-   QXmlInputSource source;
-   source.setData(data);
+   if (! cacheName.isEmpty()) {
+      hash     = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+      isCached = handler->readCache(cacheName, hash);
+   }
+
+   if (! isCached) {
+      TagFileErrorHandler errorHandler;
+
+      QXmlInputSource source;
+      source.setData(data);
+
+      QXmlSimpleReader reader;
+      reader.setContentHandler(handler.data());
+      reader.setErrorHandler(&errorHandler);
+
+      bool ok = reader.parse(source);
+
+      // a tag file with errors is parsed again next time so the errors are reported
+      if (ok && ! errorHandler.hasError() && ! cacheName.isEmpty()) {
+         handler->writeCache(cacheName, hash);
+      }
+   }
+
+   if (s_hasReferencedWords) {
+      // with tag-files-lazy the symbols are added once every tag file is read
+      s_lazyTagFiles.append(handler);
+      return;
+   }
 
-   QXmlSimpleReader reader;
-   reader.setContentHandler(&handler);
-   reader.setErrorHandler(&errorHandler);
-   reader.parse(source);
+   handler->buildLists(root);
+   handler->addIncludes();
+}
+
+void buildReferencedTagFiles(QSharedPointer<Entry> root)
+{
+   // select again until no tag file adds the name of a base class
+   bool changed = true;
+
+   while (changed) {
+      changed = false;
+
+      for (auto &handler : s_lazyTagFiles) {
+         handler->selectReferenced();
+
+         if (handler->addReferencedBases()) {
+            changed = true;
+         }
+      }
+   }
+
+   for (auto &handler : s_lazyTagFiles) {
+      handler->buildLists(root);
+      handler->addIncludes();
+   }
 
-   handler.buildLists(root);
-   handler.addIncludes();
+   s_lazyTagFiles.clear();
 }
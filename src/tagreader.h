@@ -20,9 +20,20 @@
 
 #include <QSharedPointer>
 #include <QString>
+#include <QStringList>
 
 class Entry;
 
 void parseTagFile(QSharedPointer<Entry> root, const QString &fullPathName);
 
+/** Collects the identifiers of the input files, used by parseTagFile() when tag-files-lazy is set */
+void collectTagReferences(const QStringList &fileList);
+
+/** Adds the symbols of the tag files read with tag-files-lazy which are named in the input files,
+ *  their scopes and their base classes from any tag file */
+void buildReferencedTagFiles(QSharedPointer<Entry> root);
+
+/** Releases the identifiers collected by collectTagReferences(), called once every tag file is read */
+void releaseTagReferences();
+
 #endif
@@ -29,12 +29,16 @@
 
 #include <util.h>
 
+#include <benchrecorder.h>
+#include <cachestats.h>
 #include <config.h>
 #include <default_args.h>
 #include <doxy_globals.h>
 #include <doxy_build_info.h>
 #include <entry.h>
 #include <example.h>
+#include <filepatterns.h>
+#include <filtercache.h>
 #include <htmlentity.h>
 #include <image.h>
 #include <language.h>
@@ -1329,6 +1333,19 @@ static void getResolvedSymbol(QSharedPointer<Definition> scope, QSharedPointer<F
    }
 }
 
+static void insertLookupInfo(const QString &key, LookupInfo *info)
+{
+   int oldCount = Doxy_Globals::lookupCache.count();
+   Doxy_Globals::lookupCache.insert(key, info);
+
+   if (CacheStats::isEnabled()) {
+      // QCache removes the least recently used entries when the maximum cost is exceeded
+      for (int i = Doxy_Globals::lookupCache.count(); i <= oldCount; i++) {
+         CacheStats::record("lookup-cache", CacheStats::Eviction);
+      }
+   }
+}
+
 /* Find the fully qualified class name referred to by the input class or typedef name in the input scope
  * Loops through scope and each of its parent scopes looking for a match with the input name
  * Can recursively call itself when resolving typedefs
@@ -1407,6 +1424,9 @@ static QSharedPointer<ClassDef> getResolvedClassRec(QSharedPointer<Definition> s
    LookupInfo *pval = Doxy_Globals::lookupCache.object(key);
 
    if (pval) {
+      if (CacheStats::isEnabled()) {
+         CacheStats::record("lookup-cache", CacheStats::Hit);
+      }
 
       if (pTemplSpec) {
          *pTemplSpec = pval->templSpec;
@@ -1424,7 +1444,11 @@ static QSharedPointer<ClassDef> getResolvedClassRec(QSharedPointer<Definition> s
 
    } else {
       // not found, add a null object to avoid endless recursion
-      Doxy_Globals::lookupCache.insert(key, new LookupInfo);
+      if (CacheStats::isEnabled()) {
+         CacheStats::record("lookup-cache", CacheStats::Miss, key.size() * sizeof(QChar) + sizeof(LookupInfo));
+      }
+
+      insertLookupInfo(key, new LookupInfo);
 
    }
 
@@ -1471,7 +1495,7 @@ static QSharedPointer<ClassDef> getResolvedClassRec(QSharedPointer<Definition> s
 
    } else {
       // not likely to get to this code, only way is if the cache expired an entry
-      Doxy_Globals::lookupCache.insert(key, new LookupInfo(bestMatch, bestTypedef, bestTemplSpec, bestResolvedType));
+      insertLookupInfo(key, new LookupInfo(bestMatch, bestTypedef, bestTemplSpec, bestResolvedType));
 
    }
 
@@ -1485,6 +1509,11 @@ QSharedPointer<ClassDef> getResolvedClass(QSharedPointer<Definition> scope, QSha
                   const QString &key, QSharedPointer<MemberDef> *pTypeDef, QString *pTemplSpec, bool mayBeUnlinkable,
                   bool mayBeHidden, QString *pResolvedType)
 {
+   if (BenchRecorder::isEnabled()) {
+      BenchRecorder::record("getResolvedClass", {BenchRecorder::scopeName(scope), BenchRecorder::fileName(fileScope),
+                  key, QString::number(mayBeUnlinkable), QString::number(mayBeHidden)});
+   }
+
    s_resolvedTypedefs.clear();
 
    if (scope == nullptr || (scope->definitionType() != Definition::TypeClass &&
@@ -1567,6 +1596,10 @@ static const char virtualScope[] = { 'v', 'i', 'r', 't', 'u', 'a', 'l', ':' };
 // note: this function is not reentrant due to the use of a static buffer
 QString removeRedundantWhiteSpace(const QString &str, bool makePretty)
 {
+   if (BenchRecorder::isEnabled()) {
+      BenchRecorder::record("removeRedundantWhiteSpace", {str, QString::number(makePretty)});
+   }
+
    if (str.isEmpty()) {
       return str;
    }
@@ -1850,6 +1883,12 @@ void linkifyText(const TextGeneratorIntf &out, QSharedPointer<Definition> scope,
                   QSharedPointer<Definition> def, const QString &text, bool autoBreak, bool external,
                   bool keepSpaces, int indentLevel)
 {
+   if (BenchRecorder::isEnabled()) {
+      BenchRecorder::record("linkifyText", {BenchRecorder::scopeName(scope), BenchRecorder::fileName(fileScope),
+                  text, QString::number(autoBreak), QString::number(external), QString::number(keepSpaces),
+                  QString::number(indentLevel)});
+   }
+
    int strLen = text.length();
 
    if (strLen == 0) {
@@ -2243,34 +2282,38 @@ QString filterCRLF(const QString &buffer)
    return retval;
 }
 
-static QString getFilterFromList(const QString &name, const QStringList &filterList, bool &found)
+static FilePatternSet buildFilterPatterns(const QStringList &filterList)
 {
-   found = false;
-
-   // compare the file name to the filter pattern list
-   for (auto filterStr : filterList) {
-      QString fs = filterStr;
+   QStringList patList;
 
-      int i_equals = fs.indexOf('=');
+   // only entries of the form pattern=filter are used
+   for (const auto &item : filterList) {
+      if (item.indexOf('=') != -1) {
+         patList.append(item);
+      }
+   }
 
-      if (i_equals != -1) {
-         QString filterPattern = fs.left(i_equals);
+   return FilePatternSet(patList, portable_fileSystemIsCaseSensitive());
+}
 
-         QRegExp fpat(filterPattern, portable_fileSystemIsCaseSensitive(), QRegExp::Wildcard);
+static QString getFilterFromList(const QString &name, const FilePatternSet &filterSet, bool &found)
+{
+   found = false;
 
-         if (fpat.indexIn(name) != -1) {
-            // found a match
-            QString filterName = fs.mid(i_equals + 1);
+   // compare the file name to the filter pattern list
+   int index = filterSet.indexIn(name);
 
-            if (filterName.indexOf(' ') != -1) {
-               // add quotes if the name has spaces
-               filterName = "\"" + filterName + "\"";
-            }
+   if (index != -1) {
+      // found a match
+      QString filterName = filterSet.value(index);
 
-            found = true;
-            return filterName;
-         }
+      if (filterName.indexOf(' ') != -1) {
+         // add quotes if the name has spaces
+         filterName = "\"" + filterName + "\"";
       }
+
+      found = true;
+      return filterName;
    }
 
    // no match
@@ -2288,8 +2331,8 @@ QString getFileFilter(const QString &name, bool isSourceCode)
       return "";
    }
 
-   const QStringList filterSrcList = Config::getList("filter-source-patterns");
-   const QStringList filterList    = Config::getList("filter-patterns");
+   static const FilePatternSet filterSrcList = buildFilterPatterns(Config::getList("filter-source-patterns"));
+   static const FilePatternSet filterList    = buildFilterPatterns(Config::getList("filter-patterns"));
 
    QString filterName;
    bool found = false;
@@ -3306,6 +3349,11 @@ bool matchArguments2(QSharedPointer<Definition> srcScope, QSharedPointer<FileDef
                   QSharedPointer<Definition> dstScope, QSharedPointer<FileDef> dstFileScope,
                   const ArgumentList &dstArgList, bool checkCV)
 {
+   if (BenchRecorder::isEnabled()) {
+      BenchRecorder::record("matchArguments2", {BenchRecorder::scopeName(srcScope), BenchRecorder::fileName(srcFileScope),
+                  argListToString(srcArgList), BenchRecorder::scopeName(dstScope), BenchRecorder::fileName(dstFileScope),
+                  argListToString(dstArgList), QString::number(checkCV)});
+   }
 
 /*
    * only valid for C, elected to disable since this should not be done without the consent of the user
@@ -4061,6 +4109,11 @@ bool resolveRef(const QString &scName, const QString &tName, bool inSeeBlock, QS
                 QSharedPointer<MemberDef> *resMember, bool useBaseTemplateOnly, QSharedPointer<FileDef> currentFile,
                 bool checkScope)
 {
+   if (BenchRecorder::isEnabled()) {
+      BenchRecorder::record("resolveRef", {scName, tName, QString::number(inSeeBlock), QString::number(useBaseTemplateOnly),
+                  BenchRecorder::fileName(currentFile), QString::number(checkScope)});
+   }
+
    QString fullName = substitute(tName, "#", "::");
 
    if (fullName.indexOf("anonymous_namespace{") == -1) {
@@ -4555,6 +4608,10 @@ QString showFileDefMatches(const FileNameDict &fnDict, const QString &xName)
 /// substitute all occurrences of \a old in \a str by \a dest
 QString substitute(const QString &origString, const QString &oldWord, const QString &newWord)
 {
+   if (BenchRecorder::isEnabled()) {
+      BenchRecorder::record("substitute", {origString, oldWord, newWord});
+   }
+
    QString retval = origString;
    retval.replace(oldWord, newWord);
 
@@ -4799,6 +4856,10 @@ QString escapeCharsInString(const QString &name, bool allowDots, bool allowUnder
  */
 QString convertNameToFile_X(const QString &name, bool allowDots, bool allowUnderscore)
 {
+   if (BenchRecorder::isEnabled()) {
+      BenchRecorder::record("convertNameToFile", {name, QString::number(allowDots), QString::number(allowUnderscore)});
+   }
+
    static const bool shortNames    = Config::getBool("short-names");
    static const bool createSubdirs = Config::getBool("create-subdirs");
 
@@ -4821,8 +4882,17 @@ QString convertNameToFile_X(const QString &name, bool allowDots, bool allowUnder
          usedNames.insert(name, count);
          num = count++;
 
+         if (CacheStats::isEnabled()) {
+            CacheStats::record("short-names", CacheStats::Miss, name.size() * sizeof(QChar) + sizeof(int));
+            CacheStats::setUsage("short-names", usedNames.count(), -1);
+         }
+
       } else {
          num = *value;
+
+         if (CacheStats::isEnabled()) {
+            CacheStats::record("short-names", CacheStats::Hit);
+         }
       }
 
       result = QString("a%1").arg(num, 5, 10, QChar('0'));
@@ -5608,6 +5678,10 @@ QString substituteTemplateArgumentsInString(const QString &name, const ArgumentL
  */
 QString stripTemplateSpecifiersFromScope(const QString &fullName, bool parentOnly, QString *pLastScopeStripped)
 {
+   if (BenchRecorder::isEnabled()) {
+      BenchRecorder::record("stripTemplateSpecifiersFromScope", {fullName, QString::number(parentOnly)});
+   }
+
    QString result;
 
    int p = 0;
@@ -7150,26 +7224,12 @@ bool readInputFile(const QString &fileName, QString &fileContents, bool filter,
       }
 
    } else {
-      QString cmd = filterName + " \"" + fileName + "\"";
-      Debug::print(Debug::ExtCmd, 0, "Executing popen(`%s`)\n", csPrintable(cmd));
-
-      FILE *f = popen(qPrintable(cmd), "r");
-
-      if (! f) {
-         err("Unable to execute filer %s, error: %d\n", csPrintable(filterName));
+      // filter output is shared between the parser and the source browser
+      if (! FilterCache::instance().getFilteredContents(fileName, filterName, buffer)) {
          return false;
       }
 
-      const int bufSize = 1024;
-      char buf[bufSize];
-      int numRead;
-
-      while ((numRead = fread(buf, 1, bufSize, f)) > 0) {
-         buffer.append(buf, numRead);
-         size += numRead;
-      }
-
-      pclose(f);
+      size = buffer.size();
 
       Debug::print(Debug::FilterOutput, 0, "Filter output\n");
       Debug::print(Debug::FilterOutput, 0, "-------------\n%s\n-------------\n", buffer.constData() );
@@ -7225,43 +7285,8 @@ QString filterTitle(const QString &title)
 
 bool patternMatch(const QFileInfo &fi, const QStringList &patList)
 {
-   bool found = false;
-
-   QString fn  = fi.fileName();
-   QString fp  = fi.filePath();
-   QString afp = fi.absoluteFilePath();
-
-   for (auto pattern : patList) {
-
-      if (! pattern.isEmpty()) {
-         int i = pattern.indexOf('=');
-
-         if (i != -1) {
-            pattern = pattern.left(i);   // strip off the extension
-         }
-
-#if defined(_WIN32) || defined(__MACOSX__)
-         // Windows or MacOSX
-         QRegExp re(pattern, Qt::CaseInsensitive, QRegExp::Wildcard);
-#else
-         // unix
-         QRegExp re(pattern, Qt::CaseSensitive, QRegExp::Wildcard);
-#endif
-
-         // input-patterns
-         // possilbe issue if the pattern has something other than a wildcard for the name
-         // found = re.indexIn(fn) != -1 || re.indexIn(fp) != -1 || re.indexIn(afp) != -1;
-
-         found = re.exactMatch(fn) || re.exactMatch(fp) || re.exactMatch(afp);
-
-         if (found) {
-            break;
-         }
-      }
-
-   }
-
-   return found;
+   // callers which test many files should build a FilePatternSet once and reuse it
+   return FilePatternSet(patList).match(fi);
 }
 
 QString externalLinkTarget()
@@ -0,0 +1,194 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#include <QMutexLocker>
+
+#include <workerpool.h>
+
+#include <config.h>
+
+void WorkerPoolThread::run()
+{
+   m_pool->workerLoop();
+}
+
+WorkerPool::WorkerPool(int numThreads)
+   : m_numThreads(qMin(32, numThreads)), m_pending(0), m_started(false), m_serial(numThreads <= 0),
+     m_stopping(false)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+   stop();
+}
+
+int WorkerPool::threadCount(const QString &option)
+{
+   int retval = qMin(32, Config::getInt(option));
+
+   if (retval <= 0) {
+      retval = qMax(2, QThread::idealThreadCount());
+   }
+
+   return retval;
+}
+
+bool WorkerPool::isSerial() const
+{
+   QMutexLocker locker(&m_mutex);
+   return m_serial || m_stopping;
+}
+
+void WorkerPool::setGroupLimit(const QString &group, int limit)
+{
+   QMutexLocker locker(&m_mutex);
+   m_groupLimits.insert(group, limit);
+}
+
+// called with m_mutex locked, the new threads wait for the lock before they look at the queue
+void WorkerPool::startThreads()
+{
+   m_started = true;
+
+   for (int i = 0; i < m_numThreads; i++) {
+      WorkerPoolThread *thread = new WorkerPoolThread(this);
+      thread->start();
+
+      if (thread->isRunning()) {
+         m_workers.append(thread);
+
+      } else {
+         // no more threads available
+         delete thread;
+         break;
+      }
+   }
+
+   if (m_workers.isEmpty()) {
+      m_serial = true;
+   }
+}
+
+void WorkerPool::start(Task task, const QString &group)
+{
+   {
+      QMutexLocker locker(&m_mutex);
+
+      if (! m_started && ! m_serial && ! m_stopping) {
+         startThreads();
+      }
+
+      // once stop() was called the threads may already have ended
+      if (! m_serial && ! m_stopping) {
+         m_queue.append(QueuedTask{std::move(task), group});
+         m_pending++;
+
+         m_taskAvailable.wakeOne();
+         return;
+      }
+   }
+
+   task();
+}
+
+bool WorkerPool::takeTask(QueuedTask &item)
+{
+   QMutexLocker locker(&m_mutex);
+
+   while (true) {
+
+      for (int i = 0; i < m_queue.count(); i++) {
+         const QString &group = m_queue.at(i).group;
+         const int limit      = m_groupLimits.value(group, 0);
+
+         if (limit <= 0 || m_groupRunning.value(group) < limit) {
+            item = m_queue.takeAt(i);
+
+            if (! item.group.isEmpty()) {
+               m_groupRunning[item.group]++;
+            }
+
+            return true;
+         }
+      }
+
+      if (m_stopping && m_queue.isEmpty()) {
+         return false;
+      }
+
+      // wait until a task is queued or a task of a limited group is finished
+      m_taskAvailable.wait(&m_mutex);
+   }
+}
+
+void WorkerPool::workerLoop()
+{
+   QueuedTask item;
+
+   while (takeTask(item)) {
+      item.task();
+
+      // release what the task holds before waiting for the next one
+      item.task = Task();
+
+      QMutexLocker locker(&m_mutex);
+
+      if (! item.group.isEmpty()) {
+         m_groupRunning[item.group]--;
+
+         if (m_groupLimits.contains(item.group)) {
+            m_taskAvailable.wakeAll();
+         }
+      }
+
+      m_pending--;
+
+      if (m_pending == 0) {
+         m_allDone.wakeAll();
+      }
+   }
+}
+
+void WorkerPool::waitForDone()
+{
+   QMutexLocker locker(&m_mutex);
+
+   while (m_pending > 0) {
+      m_allDone.wait(&m_mutex);
+   }
+}
+
+void WorkerPool::stop()
+{
+   {
+      QMutexLocker locker(&m_mutex);
+
+      m_stopping = true;
+      m_taskAvailable.wakeAll();
+   }
+
+   // the threads finish the queued tasks before they end
+   for (auto thread : m_workers) {
+      thread->wait();
+      delete thread;
+   }
+
+   m_workers.clear();
+
+   QMutexLocker locker(&m_mutex);
+   m_serial = true;
+}
@@ -0,0 +1,111 @@
+/*************************************************************************
+ *
+ * Copyright (C) 2014-2017 Barbara Geller & Ansel Sermersheim
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License version 2
+ * is hereby granted. No representations are made about the suitability of
+ * this software for any purpose. It is provided "as is" without express or
+ * implied warranty. See the GNU General Public License for more details.
+ *
+ * Documents produced by DoxyPress are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+*************************************************************************/
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <functional>
+
+class WorkerPool;
+
+/** Thread of a WorkerPool */
+class WorkerPoolThread : public QThread
+{
+ public:
+   explicit WorkerPoolThread(WorkerPool *pool)
+      : m_pool(pool)
+   {}
+
+   void run() override;
+
+ private:
+   WorkerPool *m_pool;
+};
+
+/** @brief Runs tasks on a fixed number of threads
+ *
+ *  Tasks are started in the order they are queued. A task may belong to a group, setGroupLimit()
+ *  restricts how many tasks of one group run at the same time and the next task of another group
+ *  is started instead. The threads are created by the first call to start(). A pool without
+ *  threads, or one which was stopped, runs each task in start() on the calling thread.
+ */
+class WorkerPool
+{
+ public:
+   using Task = std::function<void()>;
+
+   /** Creates a pool with \a numThreads threads, with zero threads the tasks run in start() */
+   explicit WorkerPool(int numThreads);
+   ~WorkerPool();
+
+   /** Returns the thread count for \a option, zero or less is one thread per core but at least two */
+   static int threadCount(const QString &option);
+
+   /** Returns true when start() runs the tasks on the calling thread */
+   bool isSerial() const;
+
+   /** At most \a limit tasks of \a group run at the same time */
+   void setGroupLimit(const QString &group, int limit);
+
+   /** Queues \a task, a task may queue other tasks */
+   void start(Task task, const QString &group = QString());
+
+   /** Blocks until every queued task is finished, must not be called by a task */
+   void waitForDone();
+
+   /** Waits for the queued tasks and ends the threads, later tasks run in start() */
+   void stop();
+
+ private:
+   struct QueuedTask {
+      Task    task;
+      QString group;
+   };
+
+   void startThreads();
+   bool takeTask(QueuedTask &item);
+   void workerLoop();
+
+   int m_numThreads;
+
+   QList<QueuedTask>        m_queue;
+   QList<WorkerPoolThread *> m_workers;
+
+   QHash<QString, int> m_groupLimits;
+   QHash<QString, int> m_groupRunning;
+
+   // number of tasks queued or running
+   int  m_pending;
+
+   bool m_started;
+   bool m_serial;
+   bool m_stopping;
+
+   mutable QMutex m_mutex;
+   QWaitCondition m_taskAvailable;
+   QWaitCondition m_allDone;
+
+   friend class WorkerPoolThread;
+};
+
+#endif
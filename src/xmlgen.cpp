@@ -36,6 +36,7 @@
 #include <message.h>
 #include <membergroup.h>
 #include <outputgen.h>
+#include <outputwriter.h>
 #include <parse_base.h>
 #include <resourcemgr.h>
 #include <util.h>
@@ -98,6 +99,9 @@ class XmlSectionMapper : public QHash<long, QString>
 };
 static XmlSectionMapper g_xmlSectionMapper;
 
+// writes the compound files, see OutputFileWriter
+static OutputFileWriter *s_xmlWriter = nullptr;
+
 inline void writeXMLString(QTextStream &t, const QString &text)
 {
    t << convertToXML(text);
@@ -196,14 +200,8 @@ static void writeCombineScript()
    QString outputDirectory = Config::getString("xml-output");
    QString fileName = outputDirectory + "/combine.xslt";
 
-   QFile f(fileName);
-
-   if (! f.open(QIODevice::WriteOnly)) {
-      err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
-      return;
-   }
-
-   QTextStream t(&f);
+   QueuedOutputFile outFile(*s_xmlWriter, fileName);
+   QTextStream &t = outFile.stream();
 
   
    t <<
@@ -1428,14 +1426,8 @@ static void generateXMLForClass(QSharedPointer<ClassDef> cd, QTextStream &ti)
    static const QString xmlOutDir = Config::getString("xml-output");
    QString fileName  = xmlOutDir + "/" + classOutputFileBase(cd) + ".xml";
 
-   QFile fi(fileName);
-
-   if (! fi.open(QIODevice::WriteOnly)) {
-      err("Unable to open file for writing %s, error: %d\n", csPrintable(fileName), fi.error());
-      return;
-   }
-
-   QTextStream t(&fi);
+   QueuedOutputFile outFile(*s_xmlWriter, fileName);
+   QTextStream &t = outFile.stream();
  
    writeXMLHeader(t);
    t << "  <compounddef id=\""
@@ -1667,14 +1659,8 @@ static void generateXMLForNamespace(QSharedPointer<NamespaceDef> nd, QTextStream
    QString outputDirectory = Config::getString("xml-output");
    QString fileName = outputDirectory + "/" + nd->getOutputFileBase() + ".xml";
 
-   QFile f(fileName);
-
-   if (! f.open(QIODevice::WriteOnly)) {
-      err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
-      return;
-   }
-
-   QTextStream t(&f);
+   QueuedOutputFile outFile(*s_xmlWriter, fileName);
+   QTextStream &t = outFile.stream();
   
    writeXMLHeader(t);
    t << "  <compounddef id=\"" << nd->getOutputFileBase()
@@ -1743,14 +1729,8 @@ static void generateXMLForFile(QSharedPointer<FileDef> fd, QTextStream &ti)
    QString outputDirectory = Config::getString("xml-output");
    QString fileName = outputDirectory + "/" + fd->getOutputFileBase() + ".xml";
 
-   QFile f(fileName);
-
-   if (!f.open(QIODevice::WriteOnly)) {
-      err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
-      return;
-   }
-
-   QTextStream t(&f);
+   QueuedOutputFile outFile(*s_xmlWriter, fileName);
+   QTextStream &t = outFile.stream();
    //t.setEncoding(QTextStream::UnicodeUTF8);
 
    writeXMLHeader(t);
@@ -1870,14 +1850,8 @@ static void generateXMLForGroup(QSharedPointer<GroupDef> gd, QTextStream &ti)
    QString outputDirectory = Config::getString("xml-output");
    QString fileName = outputDirectory + "/" + gd->getOutputFileBase() + ".xml";
 
-   QFile f(fileName);
-
-   if (! f.open(QIODevice::WriteOnly)) {
-       err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
-      return;
-   }
-
-   QTextStream t(&f);
+   QueuedOutputFile outFile(*s_xmlWriter, fileName);
+   QTextStream &t = outFile.stream();
    //t.setEncoding(QTextStream::UnicodeUTF8);
 
    writeXMLHeader(t);
@@ -1929,14 +1903,8 @@ static void generateXMLForDir(QSharedPointer<DirDef> dd, QTextStream &ti)
    QString outputDirectory = Config::getString("xml-output");
    QString fileName = outputDirectory + "/" + dd->getOutputFileBase() + ".xml";
 
-   QFile f(fileName);
-
-   if (!f.open(QIODevice::WriteOnly)) {
-      err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
-      return;
-   }
-
-   QTextStream t(&f);
+   QueuedOutputFile outFile(*s_xmlWriter, fileName);
+   QTextStream &t = outFile.stream();
    //t.setEncoding(QTextStream::UnicodeUTF8);
    writeXMLHeader(t);
    t << "  <compounddef id=\""
@@ -1987,14 +1955,8 @@ static void generateXMLForPage(QSharedPointer<PageDef> pd, QTextStream &ti, bool
    QString outputDirectory = Config::getString("xml-output");
    QString fileName = outputDirectory + "/" + pageName + ".xml";
 
-   QFile f(fileName);
-
-   if (! f.open(QIODevice::WriteOnly)) {
-      err("Unable to open file for writing %s, error: %d\n", qPrintable(fileName), f.error());
-      return;
-   }
-
-   QTextStream t(&f);
+   QueuedOutputFile outFile(*s_xmlWriter, fileName);
+   QTextStream &t = outFile.stream();
    //t.setEncoding(QTextStream::UnicodeUTF8);
 
    writeXMLHeader(t);
@@ -2109,7 +2071,10 @@ void generateXML()
       return;
    }
 
-   QTextStream t(&f);  
+   QTextStream t(&f);
+
+   OutputFileWriter writer;
+   s_xmlWriter = &writer;
 
    // write index header
    t << "<?xml version='1.0' encoding='UTF-8' standalone='no'?>" << endl;;
@@ -2162,4 +2127,7 @@ void generateXML()
    t << "</doxypressindex>" << endl;
 
    writeCombineScript();
+
+   writer.finish();
+   s_xmlWriter = nullptr;
 }